@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : replacer_size_(num_frames), entries_(num_frames) {}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  bool evicted;
+  if (!t1_.empty() && t1_.size() > t1_target_) {
+    evicted = EvictFrom(&t1_, frame_id) || EvictFrom(&t2_, frame_id);
+  } else {
+    evicted = EvictFrom(&t2_, frame_id) || EvictFrom(&t1_, frame_id);
+  }
+  TrimGhosts();
+  return evicted;
+}
+
+auto ARCReplacer::EvictFrom(std::list<frame_id_t> *list, frame_id_t *frame_id) -> bool {
+  for (auto rit = list->rbegin(); rit != list->rend(); ++rit) {
+    auto &entry = entries_[*rit];
+    if (!entry.is_evictable_) {
+      continue;
+    }
+    *frame_id = *rit;
+    (entry.list_ == ListType::T1 ? b1_ : b2_).PushFront(entry.page_id_);
+    list->erase(std::next(rit).base());
+    entry = FrameEntry{};
+    curr_size_--;
+    return true;
+  }
+  return false;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (entry.list_ != ListType::NONE) {
+    t2_.splice(t2_.begin(), entry.list_ == ListType::T1 ? t1_ : t2_, entry.position_);
+    entry.list_ = ListType::T2;
+    return;
+  }
+
+  // Sizes are taken before the hit is erased from its ghost list, as in the paper.
+  const size_t b1_size = b1_.Size();
+  const size_t b2_size = b2_.Size();
+  entry.page_id_ = page_id;
+  if (b1_.Erase(page_id)) {
+    t1_target_ = std::min(replacer_size_, t1_target_ + std::max<size_t>(b2_size / b1_size, 1));
+    t2_.push_front(frame_id);
+    entry.list_ = ListType::T2;
+    entry.position_ = t2_.begin();
+  } else if (b2_.Erase(page_id)) {
+    const size_t delta = std::max<size_t>(b1_size / b2_size, 1);
+    t1_target_ = t1_target_ > delta ? t1_target_ - delta : 0;
+    t2_.push_front(frame_id);
+    entry.list_ = ListType::T2;
+    entry.position_ = t2_.begin();
+  } else {
+    t1_.push_front(frame_id);
+    entry.list_ = ListType::T1;
+    entry.position_ = t1_.begin();
+    TrimGhosts();
+  }
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (!b1_.Empty() && t1_.size() + b1_.Size() > replacer_size_) {
+    b1_.PopBack();
+  }
+  while (b1_.Size() + b2_.Size() > replacer_size_) {
+    (b2_.Empty() ? b1_ : b2_).PopBack();
+  }
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (entry.list_ == ListType::NONE || entry.is_evictable_ == set_evictable) {
+    return;
+  }
+  entry.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (entry.list_ == ListType::NONE || !entry.is_evictable_) {
+    return;
+  }
+  (entry.list_ == ListType::T1 ? t1_ : t2_).erase(entry.position_);
+  entry = FrameEntry{};
+  curr_size_--;
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+void ARCReplacer::SetCapacity(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < replacer_size_; i++) {
+    BUSTUB_ASSERT(entries_[i].list_ == ListType::NONE, "cannot drop a tracked frame");
+  }
+  replacer_size_ = num_frames;
+  t1_target_ = std::min(t1_target_, num_frames);
+  entries_.resize(num_frames);
+  TrimGhosts();
+}
+
+}  // namespace bustub
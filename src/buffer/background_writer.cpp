@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// background_writer.cpp
+//
+// Identification: src/buffer/background_writer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/background_writer.h"
+
+namespace bustub {
+
+BackgroundWriter::BackgroundWriter(BufferPoolManager *buffer_pool_manager, size_t num_clean_frames,
+                                   std::chrono::milliseconds interval)
+    : buffer_pool_manager_(buffer_pool_manager),
+      num_clean_frames_(num_clean_frames),
+      interval_(interval),
+      worker_([this] { Run(); }) {}
+
+BackgroundWriter::~BackgroundWriter() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+void BackgroundWriter::Wake() {
+  {
+    std::scoped_lock lock(latch_);
+    woken_ = true;
+  }
+  cv_.notify_all();
+}
+
+void BackgroundWriter::SaveWarmupSnapshots(const std::string &file_name, std::chrono::milliseconds interval) {
+  std::scoped_lock lock(latch_);
+  snapshot_file_name_ = file_name;
+  snapshot_interval_ = interval;
+  last_snapshot_ = std::chrono::steady_clock::now();
+}
+
+void BackgroundWriter::Run() {
+  while (true) {
+    {
+      std::unique_lock lock(latch_);
+      cv_.wait_for(lock, interval_, [this] { return stop_ || woken_; });
+      if (stop_) {
+        return;
+      }
+      woken_ = false;
+    }
+    num_written_ += buffer_pool_manager_->WriteBackDirtyPages(num_clean_frames_);
+    num_rounds_++;
+    SaveWarmupSnapshotIfDue();
+  }
+}
+
+void BackgroundWriter::SaveWarmupSnapshotIfDue() {
+  std::string file_name;
+  {
+    std::scoped_lock lock(latch_);
+    const auto now = std::chrono::steady_clock::now();
+    if (snapshot_file_name_.empty() || now - last_snapshot_ < snapshot_interval_) {
+      return;
+    }
+    file_name = snapshot_file_name_;
+    last_snapshot_ = now;
+  }
+  if (buffer_pool_manager_->SaveWarmupSnapshot(file_name)) {
+    num_snapshots_++;
+  }
+}
+
+}  // namespace bustub
@@ -12,28 +12,91 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_pro_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/two_q_replacer.h"
 #include "common/exception.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size, replacer_k);
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     size_t page_size, size_t max_pool_size)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_policy, page_size,
+                                max_pool_size) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     size_t page_size, size_t max_pool_size)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      constructed_frames_(pool_size),
+      page_size_(page_size),
+      disk_pages_per_page_(page_size / BUSTUB_PAGE_SIZE),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(static_cast<page_id_t>(instance_index)),
+      arena_(pool_size, page_size, max_pool_size_),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(max_pool_size_) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(page_size % BUSTUB_PAGE_SIZE == 0 && page_size > 0 && page_size <= BUSTUB_MAX_PAGE_SIZE,
+                "The page size must be a multiple of BUSTUB_PAGE_SIZE, up to BUSTUB_MAX_PAGE_SIZE");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
+
+  // we allocate a consecutive memory space for the buffer pool, and the frame data in one aligned arena
+  pages_ = static_cast<Page *>(::operator new(max_pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    new (&pages_[i]) Page(arena_.GetFrameData(static_cast<frame_id_t>(i)), page_size_);
+  }
+  switch (replacer_policy) {
+    case ReplacerPolicy::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size, replacer_k);
+      break;
+    case ReplacerPolicy::TWO_Q:
+      replacer_ = new TwoQReplacer(pool_size);
+      break;
+    case ReplacerPolicy::ARC:
+      replacer_ = new ARCReplacer(pool_size);
+      break;
+    case ReplacerPolicy::CLOCK_PRO:
+      replacer_ = new ClockProReplacer(pool_size);
+      break;
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
   }
+
+  evictable_ = std::make_unique<std::atomic<bool>[]>(max_pool_size_);
+  in_ring_ = std::make_unique<std::atomic<bool>[]>(max_pool_size_);
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    evictable_[i].store(true, std::memory_order_relaxed);
+    in_ring_[i].store(false, std::memory_order_relaxed);
+  }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
-  delete page_table_;
+  for (size_t i = 0; i < constructed_frames_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete(pages_);
   delete replacer_;
 }
 
@@ -48,63 +111,140 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
   pages_[frame_id].ResetMemory();
   pages_[frame_id].page_id_ = new_page_id;
   pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 1;
 
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-  page_table_->Insert(new_page_id, frame_id);
+  replacer_->RecordAccess(frame_id, new_page_id);
+  SetFrameEvictable(frame_id, false);
+  in_ring_[frame_id].store(false, std::memory_order_relaxed);
+  page_table_.Insert(new_page_id, frame_id);
+  pages_[frame_id].pin_count_.store(1, std::memory_order_release);
 
   *page_id = new_page_id;
   return &pages_[frame_id];
 }
 
 auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+  return FetchPgImp(page_id, AccessHint::NORMAL);
+}
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, AccessHint hint) -> Page * {
+  ValidatePageId(page_id);
+  if (Page *page = FetchPgFast(page_id, hint); page != nullptr) {
+    return page;
+  }
+
   std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_id;
-  if (page_table_->Find(page_id, frame_id)) {
-    // trying this for data-race (like reserving the frame)
-    if (pages_[frame_id].pin_count_ == 0) {
-      replacer_->SetEvictable(frame_id, false);
+  if (page_table_.Find(page_id, &frame_id)) {
+    fast_path_stats_[ThreadStripe()].hits_.fetch_add(1, std::memory_order_relaxed);
+    // Frames are only claimed under the latch, so the pin count cannot be negative here.
+    if (pages_[frame_id].pin_count_.fetch_add(1) == 0) {
+      SetFrameEvictable(frame_id, false);
+    }
+    if (hint == AccessHint::NORMAL) {
+      in_ring_[frame_id].store(false, std::memory_order_relaxed);
+      replacer_->RecordAccess(frame_id, page_id);
     }
-    pages_[frame_id].pin_count_++;
-    replacer_->RecordAccess(frame_id);
     return &pages_[frame_id];
   }
-  if (GetFrame(&frame_id)) {
-    if (pages_[frame_id].pin_count_ == 0) {
-      replacer_->SetEvictable(frame_id, false);
-    }
+  if (GetRingFrame(hint, &frame_id) || GetFrame(&frame_id)) {
+    num_misses_.fetch_add(1, std::memory_order_relaxed);
     pages_[frame_id].ResetMemory();
-    disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
+    FrameIO(false, page_id, pages_[frame_id].data_);
     pages_[frame_id].page_id_ = page_id;
-    pages_[frame_id].pin_count_++;
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-    page_table_->Insert(page_id, frame_id);
+    replacer_->RecordAccess(frame_id, page_id);
+    SetFrameEvictable(frame_id, false);
+    AddToRing(hint, frame_id, page_id);
+    page_table_.Insert(page_id, frame_id);
+    pages_[frame_id].pin_count_.store(1, std::memory_order_release);
     return &pages_[frame_id];
   }
   return nullptr;
 }
 
+auto BufferPoolManagerInstance::FetchPgFast(page_id_t page_id, AccessHint hint) -> Page * {
+  FastPathStats &stats = fast_path_stats_[ThreadStripe()];
+  frame_id_t frame_id;
+  size_t num_probes;
+  const bool found = page_table_.Find(page_id, &frame_id, &num_probes);
+  stats.probe_length_.Record(num_probes);
+  if (!found) {
+    return nullptr;
+  }
+
+  if (!PinFrame(frame_id)) {
+    stats.pin_waits_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;  // the frame is being evicted or loaded
+  }
+
+  // The frame cannot be given to another page while we hold a pin, so its page id is stable from here on.
+  Page &page = pages_[frame_id];
+  if (page.page_id_.load(std::memory_order_relaxed) != page_id) {
+    UnpinFrame(frame_id);
+    return nullptr;
+  }
+  if (hint == AccessHint::NORMAL) {
+    if (in_ring_[frame_id].load(std::memory_order_relaxed)) {
+      in_ring_[frame_id].store(false, std::memory_order_relaxed);
+    }
+    RecordAccessFast(frame_id, page_id);
+  }
+  stats.hits_.fetch_add(1, std::memory_order_relaxed);
+  return &page;
+}
+
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  if (UnpinPgFast(page_id, is_dirty)) {
+    return true;
+  }
+
   std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_id;
-  if (!page_table_->Find(page_id, frame_id) || pages_[frame_id].pin_count_ == 0) {
+  if (!page_table_.Find(page_id, &frame_id)) {
     return false;
   }
 
-  if (--pages_[frame_id].pin_count_ == 0) {
-    replacer_->SetEvictable(frame_id, true);
+  // The fast path may pin the frame concurrently, so the count has to be decremented atomically.
+  Page &page = pages_[frame_id];
+  int pin_count = page.pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+
+  if (pin_count == 1) {
+    SetFrameEvictable(frame_id, true);
+  }
+  if (is_dirty) {
+    page.is_dirty_ = true;
   }
-  pages_[frame_id].is_dirty_ |= is_dirty;
   return true;
 }
 
+auto BufferPoolManagerInstance::UnpinPgFast(page_id_t page_id, bool is_dirty) -> bool {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return false;
+  }
+
+  // The caller's pin keeps the frame from being given to another page, so a matching page id cannot go stale.
+  Page &page = pages_[frame_id];
+  if (page.pin_count_.load(std::memory_order_acquire) <= 0 ||
+      page.page_id_.load(std::memory_order_relaxed) != page_id) {
+    return false;
+  }
+  // Mark the page dirty before dropping the pin, so that whoever evicts it next writes it back.
+  if (is_dirty) {
+    page.is_dirty_ = true;
+  }
+  return UnpinFrame(frame_id);
+}
+
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_id;
-  if (page_table_->Find(page_id, frame_id)) {
-    disk_manager_->WritePage(page_id, pages_[frame_id].data_);
+  if (page_table_.Find(page_id, &frame_id)) {
+    FrameIO(true, page_id, pages_[frame_id].data_);
     pages_[frame_id].is_dirty_ = false;
     return true;
   }
@@ -112,36 +252,165 @@ auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  for (size_t i = 0; i < pool_size_; i++) {
-    FlushPgImp(pages_[i].page_id_);
+  std::vector<std::pair<page_id_t, frame_id_t>> pages;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    // Frames a shrink is draining may still hold pages.
+    for (size_t i = 0; i < constructed_frames_; i++) {
+      const page_id_t page_id = pages_[i].page_id_;
+      // A pinned page may have been updated without being marked dirty yet.
+      if (page_id != INVALID_PAGE_ID && (pages_[i].is_dirty_ || pages_[i].pin_count_ > 0)) {
+        pages.emplace_back(page_id, static_cast<frame_id_t>(i));
+      }
+    }
+  }
+  std::sort(pages.begin(), pages.end());
+  WritePages(pages, false);
+}
+
+auto BufferPoolManagerInstance::WriteBackDirtyPages(size_t num_clean_frames) -> size_t {
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty_pages;
+  size_t num_clean = 0;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    num_clean = free_list_.size();
+    for (size_t i = 0; i < constructed_frames_; i++) {
+      const page_id_t page_id = pages_[i].page_id_;
+      if (page_id == INVALID_PAGE_ID || pages_[i].pin_count_ != 0) {
+        continue;
+      }
+      if (pages_[i].is_dirty_) {
+        dirty_pages.emplace_back(page_id, static_cast<frame_id_t>(i));
+      } else {
+        num_clean++;
+      }
+    }
+  }
+  if (num_clean >= num_clean_frames) {
+    return 0;
+  }
+
+  // Writing the lowest page ids keeps the writes of one round close together on disk.
+  const size_t num_to_write = std::min(num_clean_frames - num_clean, dirty_pages.size());
+  std::partial_sort(dirty_pages.begin(), dirty_pages.begin() + num_to_write, dirty_pages.end());
+  dirty_pages.resize(num_to_write);
+  return WritePages(dirty_pages, true);
+}
+
+auto BufferPoolManagerInstance::WritePages(const std::vector<std::pair<page_id_t, frame_id_t>> &pages, bool background)
+    -> size_t {
+  std::vector<DiskRequest> requests;
+  std::vector<std::future<bool>> written;
+  size_t num_written = 0;
+  // Pages that are written from their frame stay pinned until their write completes.
+  std::vector<frame_id_t> pinned_frames;
+  // The background writer writes copies, so that it holds no page latch while the writes are in flight. They are
+  // aligned like the frames, so that they can go straight to a disk manager opened with O_DIRECT.
+  std::unique_ptr<char, decltype(&std::free)> copies{nullptr, &std::free};
+  if (background && !pages.empty()) {
+    copies.reset(static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, pages.size() * page_size_)));
+  }
+
+  for (const auto &[page_id, frame_id] : pages) {
+    if (!PinFrame(frame_id)) {
+      continue;  // being evicted, and written back by the evicting thread if it is dirty
+    }
+    Page &page = pages_[frame_id];
+    if (page.page_id_ != page_id || (background && !page.is_dirty_)) {
+      UnpinFrame(frame_id);
+      continue;
+    }
+    // Clear the flag before copying the data: an update that misses this write marks the page dirty again when it
+    // unpins the page.
+    page.is_dirty_ = false;
+    char *data = page.data_;
+    if (background) {
+      data = copies.get() + num_written * page_size_;
+      page.RLatch();
+      std::memcpy(data, page.data_, page_size_);
+      page.RUnlatch();
+      UnpinFrame(frame_id);
+    } else {
+      pinned_frames.push_back(frame_id);
+    }
+    AddPageRequests(&requests, true, page_id, data);
+    num_written++;
+  }
+
+  for (auto &request : requests) {
+    written.push_back(request.callback_.get_future());
+  }
+  disk_manager_->SubmitBatch(&requests);
+  for (auto &future : written) {
+    future.wait();
+  }
+  for (frame_id_t frame_id : pinned_frames) {
+    UnpinFrame(frame_id);
+  }
+  return num_written;
+}
+
+void BufferPoolManagerInstance::AddPageRequests(std::vector<DiskRequest> *requests, bool is_write, page_id_t page_id,
+                                                char *data) const {
+  const auto first_disk_page = static_cast<page_id_t>(page_id * disk_pages_per_page_);
+  for (size_t i = 0; i < disk_pages_per_page_; i++) {
+    requests->push_back(
+        DiskRequest{is_write, data + i * BUSTUB_PAGE_SIZE, first_disk_page + static_cast<page_id_t>(i), {}});
+  }
+}
+
+void BufferPoolManagerInstance::FrameIO(bool is_write, page_id_t page_id, char *data) {
+  if (disk_pages_per_page_ == 1) {
+    if (is_write) {
+      disk_manager_->WritePage(page_id, data);
+    } else {
+      disk_manager_->ReadPage(page_id, data);
+    }
+    return;
+  }
+  std::vector<DiskRequest> requests;
+  AddPageRequests(&requests, is_write, page_id, data);
+  std::vector<std::future<bool>> done;
+  for (auto &request : requests) {
+    done.push_back(request.callback_.get_future());
+  }
+  disk_manager_->SubmitBatch(&requests);
+  for (auto &future : done) {
+    future.wait();
   }
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t frame_id;
-  if (!page_table_->Find(page_id, frame_id)) {
+  if (!page_table_.Find(page_id, &frame_id)) {
     // Page not in buffer pool, so do nothing and return true
     return true;
   }
 
-  // Check if page is pinned
-  if (pages_[frame_id].pin_count_ > 0) {
+  // Check if page is pinned, and keep the fast path from pinning it while we delete it
+  if (!ClaimFrame(frame_id)) {
     return false;  // cannot delete a pinned page
   }
 
-  // Remove page from page table and replacer
-  page_table_->Remove(page_id);
+  // Remove page from page table and replacer. An unpinned frame may still be non-evictable if its last pin was dropped
+  // without the latch and UnpinFrame() has not restored it yet.
+  page_table_.Remove(page_id);
+  SetFrameEvictable(frame_id, true);
   replacer_->Remove(frame_id);
 
   // Reset page memory and metadata
   pages_[frame_id].ResetMemory();
   pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-  pages_[frame_id].pin_count_ = 0;
   pages_[frame_id].is_dirty_ = false;
 
-  // Add frame back to free list
-  free_list_.push_back(frame_id);
+  // Add frame back to free list, unless a shrink is dropping it
+  if (static_cast<size_t>(frame_id) >= pool_size_) {
+    RetireFrame(frame_id);
+  } else {
+    pages_[frame_id].pin_count_.store(0, std::memory_order_release);
+    free_list_.push_back(frame_id);
+  }
 
   // Deallocate page to imitate freeing it on disk
   DeallocatePage(page_id);
@@ -150,26 +419,394 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
+  const page_id_t next_page_id = next_page_id_.fetch_add(static_cast<page_id_t>(num_instances_));
+  ValidatePageId(next_page_id);
+  return next_page_id;
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
 
 auto BufferPoolManagerInstance::GetFrame(frame_id_t *frame_id) -> bool {
   frame_id_t res_frame_id;
   if (!free_list_.empty()) {
     res_frame_id = free_list_.front();
     free_list_.pop_front();
+    // A stale hint can make the fast path pin a free frame for a moment, it lets go as soon as it sees the page id.
+    if (!ClaimFrame(res_frame_id)) {
+      num_pin_waits_.fetch_add(1, std::memory_order_relaxed);
+      while (!ClaimFrame(res_frame_id)) {
+        std::this_thread::yield();
+      }
+    }
     *frame_id = res_frame_id;
     return true;
   }
 
-  if (replacer_->Evict(&res_frame_id)) {
-    if (pages_[res_frame_id].is_dirty_) {
-      disk_manager_->WritePage(pages_[res_frame_id].page_id_, pages_[res_frame_id].data_);
-      pages_[res_frame_id].is_dirty_ = false;
+  DrainAccessBuffers();
+  while (EvictFrame(&res_frame_id)) {
+    if (!ClaimFrame(res_frame_id)) {
+      // Pinned by the fast path after it was last unpinned. Keep tracking it, but not as a candidate, until the
+      // matching UnpinPgImp() makes it evictable again.
+      replacer_->RecordAccess(res_frame_id, pages_[res_frame_id].page_id_);
+      SetFrameEvictable(res_frame_id, false);
+      // UnpinFrame() drops the count before it reads evictable_, and we publish evictable_ before reading the count,
+      // so at least one of us sees that the frame went unpinned and makes it evictable again.
+      if (pages_[res_frame_id].pin_count_ == 0) {
+        SetFrameEvictable(res_frame_id, true);
+      }
+      continue;
+    }
+    DetachPage(res_frame_id);
+    if (static_cast<size_t>(res_frame_id) >= pool_size_) {
+      RetireFrame(res_frame_id);  // a shrink is dropping the frame
+      continue;
     }
-    page_table_->Remove(pages_[res_frame_id].page_id_);
     *frame_id = res_frame_id;
     return true;
   }
   return false;
 }
+
+auto BufferPoolManagerInstance::EvictFrame(frame_id_t *frame_id) -> bool {
+  const auto start = std::chrono::steady_clock::now();
+  const bool evicted = replacer_->Evict(frame_id);
+  evict_latency_.RecordSince(start);
+  return evicted;
+}
+
+void BufferPoolManagerInstance::DetachPage(frame_id_t frame_id) {
+  const page_id_t old_page_id = pages_[frame_id].page_id_;
+  num_evictions_.fetch_add(1, std::memory_order_relaxed);
+  if (pages_[frame_id].is_dirty_) {
+    num_dirty_evictions_.fetch_add(1, std::memory_order_relaxed);
+    FrameIO(true, old_page_id, pages_[frame_id].data_);
+    pages_[frame_id].is_dirty_ = false;
+  }
+  page_table_.Remove(old_page_id);
+}
+
+void BufferPoolManagerInstance::RetireFrame(frame_id_t frame_id) {
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  pages_[frame_id].is_dirty_ = false;
+  in_ring_[frame_id].store(false, std::memory_order_relaxed);
+}
+
+auto BufferPoolManagerInstance::Resize(size_t pool_size) -> bool {
+  std::scoped_lock<std::mutex> resize_lock(resize_latch_);
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  if (pool_size > pool_size_) {
+    GrowPool(pool_size);
+    return true;
+  }
+  return pool_size == pool_size_ || ShrinkPool(pool_size);
+}
+
+void BufferPoolManagerInstance::GrowPool(size_t pool_size) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = pool_size_; i < pool_size; i++) {
+    if (i < constructed_frames_) {
+      pages_[i].pin_count_.store(0, std::memory_order_release);  // retired by an earlier shrink
+    } else {
+      new (&pages_[i]) Page(arena_.GetFrameData(static_cast<frame_id_t>(i)), page_size_);
+    }
+    free_list_.emplace_back(static_cast<frame_id_t>(i));
+  }
+  constructed_frames_ = std::max(constructed_frames_, pool_size);
+  replacer_->SetCapacity(pool_size);
+  pool_size_ = pool_size;
+}
+
+auto BufferPoolManagerInstance::ShrinkPool(size_t pool_size) -> bool {
+  const size_t old_pool_size = pool_size_;
+  const auto deadline = std::chrono::steady_clock::now() + buffer_pool_resize_timeout;
+  {
+    // From here on no page is loaded into the dropped frames, and their pages are evicted as they are unpinned.
+    std::scoped_lock<std::mutex> lock(latch_);
+    pool_size_ = pool_size;
+    free_list_.remove_if([pool_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  }
+
+  while (true) {
+    size_t num_pinned = 0;
+    {
+      std::scoped_lock<std::mutex> lock(latch_);
+      for (size_t i = pool_size; i < old_pool_size; i++) {
+        const auto frame_id = static_cast<frame_id_t>(i);
+        if (pages_[i].pin_count_ < 0) {
+          continue;  // retired already, claims by others do not outlive their hold of the latch
+        }
+        if (!ClaimFrame(frame_id)) {
+          num_pinned++;
+          continue;
+        }
+        if (pages_[i].page_id_ != INVALID_PAGE_ID) {
+          SetFrameEvictable(frame_id, true);
+          replacer_->Remove(frame_id);
+          DetachPage(frame_id);
+        }
+        RetireFrame(frame_id);
+      }
+
+      if (num_pinned == 0) {
+        replacer_->SetCapacity(pool_size);
+        break;
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        // Give the frames retired so far back, the pool keeps its size.
+        for (size_t i = pool_size; i < old_pool_size; i++) {
+          if (pages_[i].pin_count_ < 0) {
+            pages_[i].pin_count_.store(0, std::memory_order_release);
+            free_list_.emplace_back(static_cast<frame_id_t>(i));
+          }
+        }
+        pool_size_ = old_pool_size;
+        return false;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  arena_.Release(static_cast<frame_id_t>(pool_size), old_pool_size - pool_size);
+  return true;
+}
+
+auto BufferPoolManagerInstance::GetWarmupEntries() -> std::vector<WarmupEntry> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  DrainAccessBuffers();
+  std::vector<WarmupEntry> entries;
+  for (size_t i = 0; i < constructed_frames_; i++) {
+    const auto frame_id = static_cast<frame_id_t>(i);
+    const page_id_t page_id = pages_[i].page_id_;
+    if (page_id != INVALID_PAGE_ID && pages_[i].pin_count_ >= 0 && !in_ring_[i]) {
+      entries.push_back(WarmupEntry{page_id, replacer_->GetAccessHistory(frame_id)});
+    }
+  }
+  return entries;
+}
+
+auto BufferPoolManagerInstance::WarmUp(const std::vector<WarmupEntry> &entries) -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<const WarmupEntry *> chosen;
+  for (const auto &entry : entries) {
+    frame_id_t frame_id;
+    if (entry.page_id_ >= 0 && static_cast<uint32_t>(entry.page_id_) % num_instances_ == instance_index_ &&
+        !page_table_.Find(entry.page_id_, &frame_id)) {
+      chosen.push_back(&entry);
+    }
+  }
+  auto by_page_id = [](const WarmupEntry *lhs, const WarmupEntry *rhs) { return lhs->page_id_ < rhs->page_id_; };
+  auto same_page = [](const WarmupEntry *lhs, const WarmupEntry *rhs) { return lhs->page_id_ == rhs->page_id_; };
+  std::sort(chosen.begin(), chosen.end(), by_page_id);
+  chosen.erase(std::unique(chosen.begin(), chosen.end(), same_page), chosen.end());
+  if (chosen.size() > free_list_.size()) {
+    auto last_access = [](const WarmupEntry *entry) -> size_t {
+      return entry->history_.empty() ? 0 : entry->history_.back();
+    };
+    auto more_recent = [&](const WarmupEntry *lhs, const WarmupEntry *rhs) {
+      return last_access(lhs) > last_access(rhs);
+    };
+    std::nth_element(chosen.begin(), chosen.begin() + free_list_.size(), chosen.end(), more_recent);
+    chosen.resize(free_list_.size());
+    std::sort(chosen.begin(), chosen.end(), by_page_id);
+  }
+
+  // Only free frames are used, so no page is evicted and no frame is written back.
+  std::vector<frame_id_t> frames(chosen.size());
+  for (auto &frame_id : frames) {
+    GetFrame(&frame_id);
+    pages_[frame_id].ResetMemory();
+  }
+
+  // Runs of consecutive disk pages, which large pages always are, go to the disk manager as one request.
+  std::vector<char *> run;
+  page_id_t run_start = INVALID_PAGE_ID;
+  for (size_t i = 0; i < chosen.size(); i++) {
+    const auto first_disk_page = static_cast<page_id_t>(chosen[i]->page_id_ * disk_pages_per_page_);
+    if (!run.empty() && first_disk_page != run_start + static_cast<page_id_t>(run.size())) {
+      disk_manager_->ReadPages(run_start, run);
+      run.clear();
+    }
+    if (run.empty()) {
+      run_start = first_disk_page;
+    }
+    for (size_t j = 0; j < disk_pages_per_page_; j++) {
+      run.push_back(pages_[frames[i]].data_ + j * BUSTUB_PAGE_SIZE);
+    }
+  }
+  if (!run.empty()) {
+    disk_manager_->ReadPages(run_start, run);
+  }
+
+  // Replaying the recorded accesses in timestamp order gives the pages the eviction order they had. Pages without a
+  // history get one access, in page id order, before all others.
+  std::vector<std::pair<size_t, frame_id_t>> accesses;
+  for (size_t i = 0; i < chosen.size(); i++) {
+    pages_[frames[i]].page_id_ = chosen[i]->page_id_;
+    if (chosen[i]->history_.empty()) {
+      accesses.emplace_back(0, frames[i]);
+    }
+    for (size_t timestamp : chosen[i]->history_) {
+      accesses.emplace_back(timestamp, frames[i]);
+    }
+  }
+  std::stable_sort(accesses.begin(), accesses.end(),
+                   [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+  for (const auto &[timestamp, frame_id] : accesses) {
+    replacer_->RecordAccess(frame_id, pages_[frame_id].page_id_);
+  }
+  for (frame_id_t frame_id : frames) {
+    pages_[frame_id].is_dirty_ = false;
+    in_ring_[frame_id].store(false, std::memory_order_relaxed);
+    SetFrameEvictable(frame_id, true);
+    page_table_.Insert(pages_[frame_id].page_id_, frame_id);
+    pages_[frame_id].pin_count_.store(0, std::memory_order_release);
+  }
+  return chosen.size();
+}
+
+auto BufferPoolManagerInstance::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.misses_ = num_misses_.load(std::memory_order_relaxed);
+  stats.evictions_ = num_evictions_.load(std::memory_order_relaxed);
+  stats.dirty_evictions_ = num_dirty_evictions_.load(std::memory_order_relaxed);
+  stats.pin_waits_ = num_pin_waits_.load(std::memory_order_relaxed);
+  stats.evict_latency_ = evict_latency_;
+  for (const auto &stripe : fast_path_stats_) {
+    stats.hits_ += stripe.hits_.load(std::memory_order_relaxed);
+    stats.pin_waits_ += stripe.pin_waits_.load(std::memory_order_relaxed);
+    stats.probe_length_.Merge(stripe.probe_length_);
+  }
+  return stats;
+}
+
+auto BufferPoolManagerInstance::RingCapacity(AccessHint hint) const -> size_t {
+  const size_t ring_size = hint == AccessHint::BULK_WRITE ? BULK_WRITE_RING_SIZE : SCAN_RING_SIZE;
+  // A ring never takes more than a quarter of the pool.
+  return std::max<size_t>(std::min(ring_size, pool_size_ / 4), 1);
+}
+
+auto BufferPoolManagerInstance::GetRingFrame(AccessHint hint, frame_id_t *frame_id) -> bool {
+  auto &ring = rings_[static_cast<size_t>(hint)];
+  if (hint == AccessHint::NORMAL || ring.size() < RingCapacity(hint)) {
+    return false;
+  }
+
+  const auto [ring_frame_id, ring_page_id] = ring.front();
+  ring.pop_front();
+  if (pages_[ring_frame_id].page_id_ != ring_page_id || static_cast<size_t>(ring_frame_id) >= pool_size_) {
+    return false;  // the frame has been evicted or deleted since, or a shrink is dropping it
+  }
+  if (!in_ring_[ring_frame_id] || !ClaimFrame(ring_frame_id)) {
+    // Someone else wants the page. It stays resident under the replacer, and the ring grows back by one victim.
+    in_ring_[ring_frame_id] = false;
+    return false;
+  }
+  // The last pin may have been dropped without the latch, and the replacer only removes evictable frames.
+  SetFrameEvictable(ring_frame_id, true);
+  replacer_->Remove(ring_frame_id);
+  DetachPage(ring_frame_id);
+  *frame_id = ring_frame_id;
+  return true;
+}
+
+void BufferPoolManagerInstance::AddToRing(AccessHint hint, frame_id_t frame_id, page_id_t page_id) {
+  if (hint == AccessHint::NORMAL) {
+    in_ring_[frame_id].store(false, std::memory_order_relaxed);
+    return;
+  }
+  rings_[static_cast<size_t>(hint)].emplace_back(frame_id, page_id);
+  in_ring_[frame_id].store(true, std::memory_order_relaxed);
+}
+
+auto BufferPoolManagerInstance::PinFrame(frame_id_t frame_id) -> bool {
+  Page &page = pages_[frame_id];
+  int pin_count = page.pin_count_.load(std::memory_order_relaxed);
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count + 1, std::memory_order_acquire,
+                                                   std::memory_order_relaxed));
+  return true;
+}
+
+auto BufferPoolManagerInstance::ClaimFrame(frame_id_t frame_id) -> bool {
+  int expected = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(expected, -1, std::memory_order_acquire);
+}
+
+void BufferPoolManagerInstance::SetFrameEvictable(frame_id_t frame_id, bool set_evictable) {
+  replacer_->SetEvictable(frame_id, set_evictable);
+  evictable_[frame_id] = set_evictable;
+}
+
+auto BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id) -> bool {
+  Page &page = pages_[frame_id];
+  int pin_count = page.pin_count_.load(std::memory_order_relaxed);
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  // The common case: the frame was pinned through the fast path and the replacer still has it as evictable.
+  if (pin_count > 1 || evictable_[frame_id]) {
+    return true;
+  }
+
+  // Only the latch holder may touch the replacer. The frame may have been claimed, reloaded or pinned again by the time
+  // we get the latch, and only a resident page with no pins left is made evictable.
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (page.pin_count_ == 0 && page.page_id_ != INVALID_PAGE_ID) {
+    SetFrameEvictable(frame_id, true);
+  }
+  return true;
+}
+
+auto BufferPoolManagerInstance::ThreadStripe() -> size_t {
+  thread_local const size_t thread_hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  return thread_hash % ACCESS_BUFFER_STRIPES;
+}
+
+void BufferPoolManagerInstance::RecordAccessFast(frame_id_t frame_id, page_id_t page_id) {
+  AccessBuffer &buffer = access_buffers_[ThreadStripe()];
+  if (buffer.lock_.test_and_set(std::memory_order_acquire)) {
+    return;  // another thread is using this stripe, losing one access only costs the replacer some precision
+  }
+
+  buffer.entries_[buffer.size_++] = {frame_id, page_id};
+  if (buffer.size_ == ACCESS_BUFFER_CAPACITY) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    ApplyAccesses(&buffer);
+  } else if (buffer.size_ >= ACCESS_BATCH_SIZE && latch_.try_lock()) {
+    ApplyAccesses(&buffer);
+    latch_.unlock();
+  }
+  buffer.lock_.clear(std::memory_order_release);
+}
+
+void BufferPoolManagerInstance::DrainAccessBuffers() {
+  for (auto &buffer : access_buffers_) {
+    // Only try the spin lock: its holder may be waiting for the latch that we hold.
+    if (buffer.lock_.test_and_set(std::memory_order_acquire)) {
+      continue;
+    }
+    ApplyAccesses(&buffer);
+    buffer.lock_.clear(std::memory_order_release);
+  }
+}
+
+void BufferPoolManagerInstance::ApplyAccesses(AccessBuffer *buffer) {
+  for (size_t i = 0; i < buffer->size_; ++i) {
+    const auto &[frame_id, page_id] = buffer->entries_[i];
+    if (pages_[frame_id].page_id_ == page_id) {
+      replacer_->RecordAccess(frame_id, page_id);
+    }
+  }
+  buffer->size_ = 0;
+}
 }  // namespace bustub
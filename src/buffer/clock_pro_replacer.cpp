@@ -0,0 +1,238 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.cpp
+//
+// Identification: src/buffer/clock_pro_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_pro_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ClockProReplacer::ClockProReplacer(size_t num_frames)
+    : replacer_size_(num_frames),
+      cold_target_(std::max<size_t>(num_frames / 100, 1)),
+      entries_(num_frames),
+      hand_hot_(clock_.end()),
+      hand_cold_(clock_.end()),
+      hand_test_(clock_.end()) {}
+
+auto ClockProReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+
+  // There is an evictable page, but it may be hot. Every lap of hand_cold_ without a victim demotes one hot page, so
+  // the loop ends once it has been demoted and its reference bit cleared.
+  size_t steps = 0;
+  while (true) {
+    if (++steps > clock_.size()) {
+      steps = 0;
+      RunHandHot();
+    }
+    ClockIterator node = hand_cold_;
+    if (node->is_hot_ || node->frame_id_ == INVALID_FRAME_ID) {
+      Advance(&hand_cold_);
+      continue;
+    }
+
+    if (node->is_referenced_) {
+      node->is_referenced_ = false;
+      Advance(&hand_cold_);
+      if (node->in_test_) {
+        // Re-referenced during its test period: its reuse distance is shorter than that of the coldest hot page.
+        node->in_test_ = false;
+        node->is_hot_ = true;
+        num_hot_++;
+        cold_target_ = std::min(cold_target_ + 1, replacer_size_);
+        BalanceHot();
+      } else {
+        node->in_test_ = true;
+        clock_.splice(hand_hot_, clock_, node);
+      }
+      continue;
+    }
+
+    if (!entries_[node->frame_id_].is_evictable_) {
+      Advance(&hand_cold_);
+      continue;
+    }
+
+    *frame_id = node->frame_id_;
+    entries_[*frame_id] = FrameEntry{};
+    curr_size_--;
+    if (node->in_test_) {
+      // Stay on the clock as a non-resident page, so that a quick return is recognized.
+      node->frame_id_ = INVALID_FRAME_ID;
+      non_resident_[node->page_id_] = node;
+      Advance(&hand_cold_);
+      while (non_resident_.size() > replacer_size_) {
+        RunHandTest();
+      }
+    } else {
+      Unlink(node);
+    }
+    return true;
+  }
+}
+
+void ClockProReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (entry.is_tracked_) {
+    entry.node_->is_referenced_ = true;
+    return;
+  }
+
+  entry.is_tracked_ = true;
+  auto ghost = non_resident_.find(page_id);
+  if (ghost == non_resident_.end()) {
+    entry.node_ = Insert(ClockNode{page_id, frame_id, false, false, true});
+    return;
+  }
+  Unlink(ghost->second);
+  non_resident_.erase(ghost);
+  cold_target_ = std::min(cold_target_ + 1, replacer_size_);
+  entry.node_ = Insert(ClockNode{page_id, frame_id, true, false, false});
+  num_hot_++;
+  BalanceHot();
+}
+
+void ClockProReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (!entry.is_tracked_ || entry.is_evictable_ == set_evictable) {
+    return;
+  }
+  entry.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ClockProReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (!entry.is_tracked_ || !entry.is_evictable_) {
+    return;
+  }
+  if (entry.node_->is_hot_) {
+    num_hot_--;
+  }
+  Unlink(entry.node_);
+  entry = FrameEntry{};
+  curr_size_--;
+}
+
+auto ClockProReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+void ClockProReplacer::Advance(ClockIterator *hand) {
+  if (++*hand == clock_.end()) {
+    *hand = clock_.begin();
+  }
+}
+
+auto ClockProReplacer::Insert(ClockNode node) -> ClockIterator {
+  if (clock_.empty()) {
+    clock_.push_back(node);
+    hand_hot_ = hand_cold_ = hand_test_ = clock_.begin();
+    return clock_.begin();
+  }
+  return clock_.insert(hand_hot_, node);
+}
+
+void ClockProReplacer::Unlink(ClockIterator node) {
+  for (ClockIterator *hand : {&hand_hot_, &hand_cold_, &hand_test_}) {
+    if (*hand == node) {
+      Advance(hand);
+    }
+  }
+  clock_.erase(node);
+  if (clock_.empty()) {
+    hand_hot_ = hand_cold_ = hand_test_ = clock_.end();
+  }
+}
+
+void ClockProReplacer::EndTest(ClockIterator node) {
+  node->in_test_ = false;
+  cold_target_ = std::max<size_t>(cold_target_ - 1, 1);
+}
+
+void ClockProReplacer::RunHandHot() {
+  if (num_hot_ == 0) {
+    return;
+  }
+  while (true) {
+    ClockIterator node = hand_hot_;
+    if (node->is_hot_) {
+      if (!node->is_referenced_) {
+        node->is_hot_ = false;
+        num_hot_--;
+        Advance(&hand_hot_);
+        return;
+      }
+      node->is_referenced_ = false;
+    } else if (node->in_test_) {
+      EndTest(node);
+      if (node->frame_id_ == INVALID_FRAME_ID) {
+        non_resident_.erase(node->page_id_);
+        Unlink(node);
+        continue;
+      }
+    }
+    Advance(&hand_hot_);
+  }
+}
+
+void ClockProReplacer::RunHandTest() {
+  while (true) {
+    ClockIterator node = hand_test_;
+    if (!node->is_hot_ && node->in_test_) {
+      EndTest(node);
+      if (node->frame_id_ == INVALID_FRAME_ID) {
+        non_resident_.erase(node->page_id_);
+        Unlink(node);
+        return;
+      }
+    }
+    Advance(&hand_test_);
+  }
+}
+
+void ClockProReplacer::BalanceHot() {
+  while (num_hot_ > replacer_size_ - cold_target_) {
+    RunHandHot();
+  }
+}
+
+void ClockProReplacer::SetCapacity(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < replacer_size_; i++) {
+    BUSTUB_ASSERT(!entries_[i].is_tracked_, "cannot drop a tracked frame");
+  }
+  replacer_size_ = num_frames;
+  cold_target_ = std::clamp<size_t>(cold_target_, 1, num_frames);
+  entries_.resize(num_frames);
+  while (non_resident_.size() > replacer_size_) {
+    RunHandTest();
+  }
+  BalanceHot();
+}
+
+}  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, size_t frame_size, size_t max_frames)
+    : frame_size_(frame_size), size_(std::max<size_t>({num_frames, max_frames, 1}) * frame_size) {
+  const bool reserved = max_frames > num_frames;
+  if (size_ >= HUGE_PAGE_SIZE && !reserved) {
+    const size_t huge_size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *data = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      data_ = static_cast<char *>(data);
+      size_ = huge_size;
+      huge_pages_ = true;
+      return;
+    }
+  }
+
+  void *data = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | (reserved ? MAP_NORESERVE : 0), -1, 0);
+  if (data == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frames");
+  }
+  data_ = static_cast<char *>(data);
+#ifdef MADV_HUGEPAGE
+  if (size_ >= HUGE_PAGE_SIZE) {
+    madvise(data_, size_, MADV_HUGEPAGE);  // best effort, transparent huge pages may be disabled
+  }
+#endif
+}
+
+FrameArena::~FrameArena() { munmap(data_, size_); }
+
+void FrameArena::Release(frame_id_t first_frame_id, size_t num_frames) {
+  if (huge_pages_ || num_frames == 0) {
+    return;  // explicit huge pages are only given back as a whole
+  }
+  madvise(GetFrameData(first_frame_id), num_frames * frame_size_, MADV_DONTNEED);
+}
+
+}  // namespace bustub
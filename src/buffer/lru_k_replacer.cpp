@@ -11,112 +11,171 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_k_replacer.h"
-#include "iostream"
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : replacer_size_(num_frames), k_(k), entries_(num_frames), history_(num_frames * k) {
+  BUSTUB_ASSERT(k > 0, "k must be positive");
+  heap_.reserve(num_frames);
+}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
-  // we look from the back -> front for the frame with largest backward k-distance
-  bool found_one = false;
-  // first try to evict from history list (+inf) frames
-  if (!history_list_.empty()) {
-    for (auto rit = history_list_.rbegin(); rit != history_list_.rend(); ++rit) {
-      if (set_entries_[*rit].is_evictable_) {
-        *frame_id = *rit;
-        history_list_.erase(std::next(rit).base());
-        found_one = true;
-        break;
-      }
-    }
+  if (heap_.empty()) {
+    return false;
   }
-
-  if (!found_one && !cache_list_.empty()) {
-    for (auto rit = cache_list_.rbegin(); rit != cache_list_.rend(); ++rit) {
-      if (set_entries_[*rit].is_evictable_) {
-        *frame_id = *rit;
-        cache_list_.erase(std::next(rit).base());
-        found_one = true;
-        break;
-      }
-    }
-  }
-
-  if (found_one) {
-    set_entries_.erase(*frame_id);
-    curr_size_--;
-    return true;
-  }
-  return false;
+  *frame_id = heap_.front();
+  HeapErase(*frame_id);
+  entries_[*frame_id] = FrameEntry{};
+  curr_size_--;
+  return true;
 }
 
 void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    BUSTUB_ASSERT(false, "INVALID FRAME ID");
-  }
-  size_t access_count = ++set_entries_[frame_id].access_count;
-  // new frame
-  if (access_count == 1) {
-    history_list_.emplace_front(frame_id);
-    set_entries_[frame_id].position_ = history_list_.begin();
-    curr_size_++;
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  size_t *ring = &history_[frame_id * k_];
+  entry.is_tracked_ = true;
+  if (entry.access_count_ < k_) {
+    ring[entry.access_count_++] = current_timestamp_++;
   } else {
-    // move from history_list_ to cache queue list
-    if (access_count == k_) {
-      history_list_.erase(set_entries_[frame_id].position_);
-      cache_list_.emplace_front(frame_id);
-      set_entries_[frame_id].position_ = cache_list_.begin();
-    } else /* move to front of the cache queue (LRU) */ {
-      if (access_count > k_) {
-        cache_list_.erase(set_entries_[frame_id].position_);
-        cache_list_.emplace_front(frame_id);
-        set_entries_[frame_id].position_ = cache_list_.begin();
-      }
-    }
+    // the ring is full, the oldest access is overwritten and its successor becomes the kth previous access
+    ring[entry.ring_head_] = current_timestamp_++;
+    entry.ring_head_ = (entry.ring_head_ + 1) % k_;
+  }
+  // A new access only ever moves a frame towards the back of the eviction order.
+  if (entry.heap_index_ != NOT_IN_HEAP) {
+    HeapSiftDown(entry.heap_index_);
   }
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    BUSTUB_ASSERT(false, "INVALID FRAME ID");
-  }
-  if (set_entries_.find(frame_id) == set_entries_.end()) {
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (!entry.is_tracked_ || entry.is_evictable_ == set_evictable) {
     return;
   }
-  bool old_status = set_entries_[frame_id].is_evictable_;
-  if (old_status && !set_evictable) {
-    curr_size_--;
-  } else if (!old_status && set_evictable) {
+  entry.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    HeapPush(frame_id);
     curr_size_++;
+  } else {
+    HeapErase(frame_id);
+    curr_size_--;
   }
-  set_entries_[frame_id].is_evictable_ = set_evictable;
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    BUSTUB_ASSERT(false, "INVALID FRAME ID");
-  }
-  if (set_entries_.find(frame_id) == set_entries_.end()) {
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (!entry.is_tracked_ || !entry.is_evictable_) {
     return;
   }
-  auto &frame_entry = set_entries_[frame_id];
-  if (!frame_entry.is_evictable_) {
+  HeapErase(frame_id);
+  entry = FrameEntry{};
+  curr_size_--;
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+auto LRUKReplacer::OldestAccess(frame_id_t frame_id) const -> size_t {
+  return history_[frame_id * k_ + entries_[frame_id].ring_head_];
+}
+
+auto LRUKReplacer::EvictsBefore(frame_id_t lhs, frame_id_t rhs) const -> bool {
+  const bool lhs_inf = entries_[lhs].access_count_ < k_;
+  const bool rhs_inf = entries_[rhs].access_count_ < k_;
+  if (lhs_inf != rhs_inf) {
+    return lhs_inf;
+  }
+  // +inf frames fall back to LRU on their first access, the others compare their kth previous access.
+  return OldestAccess(lhs) < OldestAccess(rhs);
+}
+
+void LRUKReplacer::HeapPush(frame_id_t frame_id) {
+  heap_.push_back(frame_id);
+  entries_[frame_id].heap_index_ = heap_.size() - 1;
+  HeapSiftUp(heap_.size() - 1);
+}
+
+void LRUKReplacer::HeapErase(frame_id_t frame_id) {
+  const size_t index = entries_[frame_id].heap_index_;
+  const frame_id_t last = heap_.back();
+  heap_.pop_back();
+  entries_[frame_id].heap_index_ = NOT_IN_HEAP;
+  if (index == heap_.size()) {
     return;
   }
-  if (frame_entry.access_count < k_) {
-    history_list_.erase(frame_entry.position_);
-  } else {
-    cache_list_.erase(frame_entry.position_);
+  HeapPlace(index, last);
+  HeapSiftUp(index);
+  HeapSiftDown(entries_[last].heap_index_);
+}
+
+void LRUKReplacer::HeapSiftUp(size_t index) {
+  const frame_id_t frame_id = heap_[index];
+  while (index > 0) {
+    const size_t parent = (index - 1) / 2;
+    if (!EvictsBefore(frame_id, heap_[parent])) {
+      break;
+    }
+    HeapPlace(index, heap_[parent]);
+    index = parent;
   }
-  curr_size_--;
-  set_entries_.erase(frame_id);
+  HeapPlace(index, frame_id);
 }
 
-auto LRUKReplacer::Size() -> size_t { return curr_size_; }
+void LRUKReplacer::HeapSiftDown(size_t index) {
+  const frame_id_t frame_id = heap_[index];
+  while (true) {
+    size_t child = 2 * index + 1;
+    if (child >= heap_.size()) {
+      break;
+    }
+    if (child + 1 < heap_.size() && EvictsBefore(heap_[child + 1], heap_[child])) {
+      child++;
+    }
+    if (!EvictsBefore(heap_[child], frame_id)) {
+      break;
+    }
+    HeapPlace(index, heap_[child]);
+    index = child;
+  }
+  HeapPlace(index, frame_id);
+}
+
+void LRUKReplacer::HeapPlace(size_t index, frame_id_t frame_id) {
+  heap_[index] = frame_id;
+  entries_[frame_id].heap_index_ = index;
+}
+
+void LRUKReplacer::SetCapacity(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < replacer_size_; i++) {
+    BUSTUB_ASSERT(!entries_[i].is_tracked_, "cannot drop a tracked frame");
+  }
+  replacer_size_ = num_frames;
+  entries_.resize(num_frames);
+  history_.resize(num_frames * k_);
+  heap_.reserve(num_frames);
+}
+
+auto LRUKReplacer::GetAccessHistory(frame_id_t frame_id) -> std::vector<size_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  const auto &entry = entries_[frame_id];
+  const size_t *ring = &history_[frame_id * k_];
+  std::vector<size_t> history;
+  for (size_t i = 0; i < entry.access_count_; i++) {
+    history.push_back(ring[(entry.ring_head_ + i) % k_]);
+  }
+  return history;
+}
 
 }  // namespace bustub
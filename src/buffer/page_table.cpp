@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames)
+    : num_buckets_(std::max<size_t>((2 * num_frames + SLOTS_PER_BUCKET - 1) / SLOTS_PER_BUCKET, 1)),
+      buckets_(new Bucket[num_buckets_]) {
+  for (size_t slot = 0; slot < GetCapacity(); slot++) {
+    SlotAt(slot).store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::HomeSlot(page_id_t page_id) const -> size_t {
+  // Fibonacci hashing spreads the strided ids of a parallel instance, then the high bits pick the bucket.
+  const uint64_t hash = static_cast<uint32_t>(static_cast<uint32_t>(page_id) * 0x9E3779B1U);
+  return static_cast<size_t>((hash * num_buckets_) >> 32) * SLOTS_PER_BUCKET;
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id, size_t *num_probes) const -> bool {
+  const size_t home = HomeSlot(page_id);
+  const size_t home_bucket = home / SLOTS_PER_BUCKET;
+  while (true) {
+    // Versions only grow, so the sum of the versions read is unchanged only if every one of them is.
+    uint64_t versions = 0;
+    bool rewriting = false;
+    uint64_t found = EMPTY;
+    size_t bucket = num_buckets_;
+    size_t slot = home;
+    size_t probes = 0;
+    for (; probes < GetCapacity(); probes++, slot = Next(slot)) {
+      if (slot / SLOTS_PER_BUCKET != bucket) {
+        bucket = slot / SLOTS_PER_BUCKET;
+        const uint64_t version = buckets_[bucket].version_.load(std::memory_order_acquire);
+        if ((version & 1) != 0) {
+          rewriting = true;
+          break;
+        }
+        versions += version;
+      }
+      const uint64_t entry = SlotAt(slot).load(std::memory_order_acquire);
+      if (entry == EMPTY) {
+        break;
+      }
+      if (PageOf(entry) == page_id) {
+        found = entry;
+        break;
+      }
+    }
+    if (rewriting) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t versions_now = 0;
+    for (size_t b = home_bucket;; b = b + 1 == num_buckets_ ? 0 : b + 1) {
+      versions_now += buckets_[b].version_.load(std::memory_order_relaxed);
+      if (b == bucket) {
+        break;
+      }
+    }
+    if (versions_now != versions) {
+      continue;  // an entry may have been shifted past us
+    }
+    if (num_probes != nullptr) {
+      *num_probes = std::min(probes + 1, GetCapacity());
+    }
+    if (found == EMPTY) {
+      return false;
+    }
+    *frame_id = FrameOf(found);
+    return true;
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  size_t slot = HomeSlot(page_id);
+  for (size_t probes = 0; probes < GetCapacity(); probes++, slot = Next(slot)) {
+    if (SlotAt(slot).load(std::memory_order_relaxed) == EMPTY) {
+      SlotAt(slot).store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+  BUSTUB_ASSERT(false, "the page table holds more pages than the buffer pool has frames");
+}
+
+auto PageTable::Remove(page_id_t page_id) -> bool {
+  size_t hole = HomeSlot(page_id);
+  size_t probes = 0;
+  for (; probes < GetCapacity(); probes++, hole = Next(hole)) {
+    const uint64_t entry = SlotAt(hole).load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      return false;
+    }
+    if (PageOf(entry) == page_id) {
+      break;
+    }
+  }
+  if (probes == GetCapacity()) {
+    return false;
+  }
+
+  // Every bucket from the first to the last one rewritten is made odd before the stores, and even again after them.
+  const size_t first_bucket = hole / SLOTS_PER_BUCKET;
+  size_t last_bucket = first_bucket;
+  auto begin_rewrite = [this](size_t bucket) {
+    auto &version = buckets_[bucket].version_;
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  };
+  auto extend_rewrite = [this, &last_bucket, &begin_rewrite](size_t slot) {
+    while (last_bucket != slot / SLOTS_PER_BUCKET) {
+      last_bucket = last_bucket + 1 == num_buckets_ ? 0 : last_bucket + 1;
+      begin_rewrite(last_bucket);
+    }
+  };
+  begin_rewrite(first_bucket);
+
+  // Backward shift: move each later entry of the run whose probe sequence passes the hole into it.
+  for (size_t slot = Next(hole); slot != hole; slot = Next(slot)) {
+    const uint64_t entry = SlotAt(slot).load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      break;
+    }
+    const size_t home = HomeSlot(PageOf(entry));
+    if (Distance(home, slot) < Distance(hole, slot)) {
+      continue;  // the entry's probe sequence starts after the hole
+    }
+    extend_rewrite(hole);
+    SlotAt(hole).store(entry, std::memory_order_relaxed);
+    hole = slot;
+  }
+  extend_rewrite(hole);
+  SlotAt(hole).store(EMPTY, std::memory_order_relaxed);
+
+  for (size_t bucket = first_bucket;; bucket = bucket + 1 == num_buckets_ ? 0 : bucket + 1) {
+    auto &version = buckets_[bucket].version_;
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    if (bucket == last_bucket) {
+      break;
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <iterator>
+#include <thread>  // NOLINT
+
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     size_t max_pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "a parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, replacer_k,
+        log_manager, replacer_policy, BUSTUB_PAGE_SIZE, max_pool_size));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::Resize(size_t pool_size) -> bool {
+  const size_t num_instances = instances_.size();
+  if (pool_size < num_instances) {
+    return false;
+  }
+  std::vector<size_t> old_sizes;
+  for (size_t i = 0; i < num_instances; i++) {
+    old_sizes.push_back(instances_[i]->GetPoolSize());
+    if (!instances_[i]->Resize(pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0))) {
+      for (size_t j = 0; j < i; j++) {
+        if (!instances_[j]->Resize(old_sizes[j])) {
+          LOG_WARN("can't give buffer pool instance %zu its old size %zu back, it keeps %zu frames", j, old_sizes[j],
+                   instances_[j]->GetPoolSize());
+        }
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+auto ParallelBufferPoolManager::WriteBackDirtyPages(size_t num_clean_frames) -> size_t {
+  const size_t share = (num_clean_frames + instances_.size() - 1) / instances_.size();
+  size_t num_written = 0;
+  for (auto &instance : instances_) {
+    num_written += instance->WriteBackDirtyPages(share);
+  }
+  return num_written;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats.Merge(instance->GetStats());
+  }
+  return stats;
+}
+
+auto ParallelBufferPoolManager::GetWarmupEntries() -> std::vector<WarmupEntry> {
+  std::vector<WarmupEntry> entries;
+  for (auto &instance : instances_) {
+    auto instance_entries = instance->GetWarmupEntries();
+    std::move(instance_entries.begin(), instance_entries.end(), std::back_inserter(entries));
+  }
+  return entries;
+}
+
+auto ParallelBufferPoolManager::WarmUp(const std::vector<WarmupEntry> &entries) -> size_t {
+  std::vector<std::vector<WarmupEntry>> shares(instances_.size());
+  for (const auto &entry : entries) {
+    if (entry.page_id_ >= 0) {
+      shares[static_cast<size_t>(entry.page_id_) % instances_.size()].push_back(entry);
+    }
+  }
+  std::atomic<size_t> num_loaded{0};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    threads.emplace_back([&, i] { num_loaded += instances_[i]->WarmUp(shares[i]); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return num_loaded;
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager * {
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
+  if (page_id < 0) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, AccessHint hint) -> Page * {
+  if (page_id < 0) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, hint);
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  if (page_id < 0) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  if (page_id < 0) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  const size_t num_instances = instances_.size();
+  const size_t start = start_index_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    Page *page = instances_[(start + i) % num_instances]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  if (page_id < 0) {
+    return true;
+  }
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() {
+  for (auto &instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+}  // namespace bustub
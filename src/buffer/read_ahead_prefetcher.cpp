@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_prefetcher.cpp
+//
+// Identification: src/buffer/read_ahead_prefetcher.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead_prefetcher.h"
+
+namespace bustub {
+
+ReadAheadPrefetcher::ReadAheadPrefetcher(BufferPoolManager *buffer_pool_manager, size_t depth)
+    : buffer_pool_manager_(buffer_pool_manager), depth_(depth), worker_([this] { Run(); }) {}
+
+ReadAheadPrefetcher::~ReadAheadPrefetcher() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+    queue_.clear();
+  }
+  cv_.notify_all();
+  idle_cv_.notify_all();
+  worker_.join();
+}
+
+void ReadAheadPrefetcher::ScanAt(page_id_t page_id, page_id_t next_page_id, NextPageFn next_page_fn,
+                                 AccessHint hint) {
+  std::scoped_lock lock(latch_);
+  auto it = loaded_.find(page_id);
+  if (it != loaded_.end()) {
+    hits_++;
+    loaded_.erase(it);
+  } else {
+    misses_++;
+  }
+
+  if (next_page_id < 0 || depth_ == 0 || stop_) {
+    return;
+  }
+  if (queue_.size() >= MAX_QUEUED_REQUESTS) {
+    dropped_++;
+    return;
+  }
+  queue_.push_back(Request{next_page_id, next_page_fn, hint});
+  cv_.notify_one();
+}
+
+void ReadAheadPrefetcher::WaitIdle() {
+  std::unique_lock lock(latch_);
+  idle_cv_.wait(lock, [this] { return stop_ || (queue_.empty() && !busy_); });
+}
+
+auto ReadAheadPrefetcher::GetStats() const -> Stats {
+  return Stats{issued_.load(), hits_.load(), misses_.load(), dropped_.load()};
+}
+
+void ReadAheadPrefetcher::Run() {
+  Request request{INVALID_PAGE_ID, nullptr, AccessHint::NORMAL};
+  while (true) {
+    {
+      std::unique_lock lock(latch_);
+      busy_ = false;
+      if (queue_.empty()) {
+        idle_cv_.notify_all();
+      }
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (stop_) {
+        return;
+      }
+      request = queue_.front();
+      queue_.pop_front();
+      busy_ = true;
+    }
+    Serve(request);
+  }
+}
+
+void ReadAheadPrefetcher::Serve(const Request &request) {
+  page_id_t page_id = request.page_id_;
+  // Links remembered from earlier requests count towards the depth, so a scan moving one page forward costs one read.
+  for (size_t i = 0; i < depth_ && page_id >= 0; i++) {
+    {
+      std::scoped_lock lock(latch_);
+      if (stop_) {
+        return;
+      }
+      auto it = loaded_.find(page_id);
+      if (it != loaded_.end()) {
+        page_id = it->second;
+        continue;
+      }
+    }
+
+    Page *page = buffer_pool_manager_->FetchPage(page_id, request.hint_);
+    if (page == nullptr) {
+      return;
+    }
+    page->RLatch();
+    page_id_t next_page_id = request.next_page_fn_(page);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    issued_++;
+
+    {
+      std::scoped_lock lock(latch_);
+      if (loaded_.size() >= MAX_LOADED_PAGES) {
+        loaded_.clear();
+      }
+      loaded_[page_id] = next_page_id;
+    }
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.cpp
+//
+// Identification: src/buffer/two_q_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+TwoQReplacer::TwoQReplacer(size_t num_frames)
+    : replacer_size_(num_frames),
+      a1in_target_(std::max<size_t>(num_frames / 4, 1)),
+      a1out_capacity_(std::max<size_t>(num_frames / 2, 1)),
+      entries_(num_frames) {}
+
+auto TwoQReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  if (a1in_.size() > a1in_target_) {
+    return EvictFrom(&a1in_, frame_id) || EvictFrom(&am_, frame_id);
+  }
+  return EvictFrom(&am_, frame_id) || EvictFrom(&a1in_, frame_id);
+}
+
+auto TwoQReplacer::EvictFrom(std::list<frame_id_t> *queue, frame_id_t *frame_id) -> bool {
+  for (auto rit = queue->rbegin(); rit != queue->rend(); ++rit) {
+    auto &entry = entries_[*rit];
+    if (!entry.is_evictable_) {
+      continue;
+    }
+    *frame_id = *rit;
+    if (entry.queue_ == QueueType::A1IN) {
+      a1out_.PushFront(entry.page_id_);
+      if (a1out_.Size() > a1out_capacity_) {
+        a1out_.PopBack();
+      }
+    }
+    queue->erase(std::next(rit).base());
+    entry = FrameEntry{};
+    curr_size_--;
+    return true;
+  }
+  return false;
+}
+
+void TwoQReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  switch (entry.queue_) {
+    case QueueType::AM:
+      am_.splice(am_.begin(), am_, entry.position_);
+      return;
+    case QueueType::A1IN:
+      return;
+    case QueueType::NONE:
+      break;
+  }
+
+  entry.page_id_ = page_id;
+  if (a1out_.Erase(page_id)) {
+    am_.push_front(frame_id);
+    entry.queue_ = QueueType::AM;
+    entry.position_ = am_.begin();
+  } else {
+    a1in_.push_front(frame_id);
+    entry.queue_ = QueueType::A1IN;
+    entry.position_ = a1in_.begin();
+  }
+}
+
+void TwoQReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (entry.queue_ == QueueType::NONE || entry.is_evictable_ == set_evictable) {
+    return;
+  }
+  entry.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void TwoQReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "INVALID FRAME ID");
+  auto &entry = entries_[frame_id];
+  if (entry.queue_ == QueueType::NONE || !entry.is_evictable_) {
+    return;
+  }
+  (entry.queue_ == QueueType::A1IN ? a1in_ : am_).erase(entry.position_);
+  entry = FrameEntry{};
+  curr_size_--;
+}
+
+auto TwoQReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+void TwoQReplacer::SetCapacity(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < replacer_size_; i++) {
+    BUSTUB_ASSERT(entries_[i].queue_ == QueueType::NONE, "cannot drop a tracked frame");
+  }
+  replacer_size_ = num_frames;
+  a1in_target_ = std::max<size_t>(num_frames / 4, 1);
+  a1out_capacity_ = std::max<size_t>(num_frames / 2, 1);
+  entries_.resize(num_frames);
+  while (a1out_.Size() > a1out_capacity_) {
+    a1out_.PopBack();
+  }
+}
+
+}  // namespace bustub
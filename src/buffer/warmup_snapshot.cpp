@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// warmup_snapshot.cpp
+//
+// Identification: src/buffer/warmup_snapshot.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/warmup_snapshot.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace bustub {
+
+namespace {
+
+template <typename T>
+void Put(std::ofstream *out, T value) {
+  out->write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+auto Get(std::ifstream *in, T *value) -> bool {
+  return static_cast<bool>(in->read(reinterpret_cast<char *>(value), sizeof(T)));
+}
+
+}  // namespace
+
+auto WarmupSnapshot::Save(const std::string &file_name, const std::vector<WarmupEntry> &entries) -> bool {
+  const std::string tmp_file_name = file_name + ".tmp";
+  {
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return false;
+    }
+    Put(&out, MAGIC);
+    Put(&out, static_cast<uint64_t>(entries.size()));
+    for (const auto &entry : entries) {
+      Put(&out, static_cast<int32_t>(entry.page_id_));
+      Put(&out, static_cast<uint32_t>(entry.history_.size()));
+      for (size_t timestamp : entry.history_) {
+        Put(&out, static_cast<uint64_t>(timestamp));
+      }
+    }
+    if (!out.flush()) {
+      std::remove(tmp_file_name.c_str());
+      return false;
+    }
+  }
+  return std::rename(tmp_file_name.c_str(), file_name.c_str()) == 0;
+}
+
+auto WarmupSnapshot::Load(const std::string &file_name, std::vector<WarmupEntry> *entries) -> bool {
+  entries->clear();
+  std::ifstream in(file_name, std::ios::binary);
+  uint64_t magic;
+  uint64_t num_entries;
+  if (!in || !Get(&in, &magic) || magic != MAGIC || !Get(&in, &num_entries)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < num_entries; i++) {
+    int32_t page_id;
+    uint32_t history_size;
+    if (!Get(&in, &page_id) || !Get(&in, &history_size) || history_size > MAX_HISTORY_SIZE) {
+      entries->clear();
+      return false;
+    }
+    WarmupEntry entry{page_id, std::vector<size_t>(history_size)};
+    for (auto &timestamp : entry.history_) {
+      uint64_t value;
+      if (!Get(&in, &value)) {
+        entries->clear();
+        return false;
+      }
+      timestamp = static_cast<size_t>(value);
+    }
+    entries->push_back(std::move(entry));
+  }
+  return true;
+}
+
+}  // namespace bustub
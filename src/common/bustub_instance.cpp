@@ -1,7 +1,11 @@
+#include <algorithm>
+#include <functional>
 #include <optional>
 #include <shared_mutex>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
@@ -11,7 +15,10 @@
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
+#include "buffer/background_writer.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "buffer/read_ahead_prefetcher.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -31,8 +38,10 @@
 #include "planner/planner.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
+#include "storage/disk/async_disk_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/page_scrubber.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -44,20 +53,32 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
 BustubInstance::BustubInstance(const std::string &db_file_name) {
   enable_logging = false;
 
-  // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  // Storage related. With enable_page_checksums, pages on disk are checksummed, and verified when read or scrubbed.
+  const auto checksum_mode = enable_page_checksums ? PageChecksumMode::CHECKSUM : PageChecksumMode::NONE;
+  disk_manager_ = new AsyncDiskManager(db_file_name, ASYNC_IO_QUEUE_DEPTH, true, false, checksum_mode);
+  if (enable_page_checksums) {
+    page_scrubber_ = new PageScrubber(disk_manager_);
+  }
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // buffer pool size specified in `config.h`, split over independently latched instances. `SET buffer_pool_size`
+  // resizes it up to BUFFER_POOL_MAX_SIZE.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = new ParallelBufferPoolManager(
+        BUFFER_POOL_INSTANCES, 128 / BUFFER_POOL_INSTANCES, disk_manager_, LRUK_REPLACER_K, log_manager_,
+        ReplacerPolicy::LRU_K, BUFFER_POOL_MAX_SIZE / BUFFER_POOL_INSTANCES);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
   }
+  if (buffer_pool_manager_ != nullptr) {
+    prefetcher_ = new ReadAheadPrefetcher(buffer_pool_manager_);
+    buffer_pool_manager_->SetPrefetcher(prefetcher_);
+    background_writer_ = new BackgroundWriter(buffer_pool_manager_, buffer_pool_manager_->GetPoolSize() / 4);
+  }
 
   // Transaction (txn) related.
   lock_manager_ = new LockManager();
@@ -68,6 +89,7 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
 
   // Catalog.
   catalog_ = new Catalog(buffer_pool_manager_, lock_manager_, log_manager_);
+  AddSizedBufferPools(db_file_name);
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
@@ -83,13 +105,21 @@ BustubInstance::BustubInstance() {
   log_manager_ = new LogManager(disk_manager_);
 
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // buffer pool size specified in `config.h`, split over independently latched instances. `SET buffer_pool_size`
+  // resizes it up to BUFFER_POOL_MAX_SIZE.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = new ParallelBufferPoolManager(
+        BUFFER_POOL_INSTANCES, 128 / BUFFER_POOL_INSTANCES, disk_manager_, LRUK_REPLACER_K, log_manager_,
+        ReplacerPolicy::LRU_K, BUFFER_POOL_MAX_SIZE / BUFFER_POOL_INSTANCES);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
   }
+  if (buffer_pool_manager_ != nullptr) {
+    prefetcher_ = new ReadAheadPrefetcher(buffer_pool_manager_);
+    buffer_pool_manager_->SetPrefetcher(prefetcher_);
+    background_writer_ = new BackgroundWriter(buffer_pool_manager_, buffer_pool_manager_->GetPoolSize() / 4);
+  }
 
   // Transaction (txn) related.
   lock_manager_ = new LockManager();
@@ -100,11 +130,78 @@ BustubInstance::BustubInstance() {
 
   // Catalog.
   catalog_ = new Catalog(buffer_pool_manager_, lock_manager_, log_manager_);
+  AddSizedBufferPools("");
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
+void BustubInstance::AddSizedBufferPools(const std::string &db_file_name) {
+  if (buffer_pool_manager_ == nullptr) {
+    return;
+  }
+  for (size_t page_size : {static_cast<size_t>(16 * 1024), static_cast<size_t>(BUSTUB_MAX_PAGE_SIZE)}) {
+    DiskManager *disk_manager;
+    if (db_file_name.empty()) {
+      disk_manager = new DiskManagerUnlimitedMemory();
+    } else {
+      // test.db keeps its 16 KiB pages in test.16k.db
+      auto n = db_file_name.rfind('.');
+      const auto checksum_mode = enable_page_checksums ? PageChecksumMode::CHECKSUM : PageChecksumMode::NONE;
+      disk_manager = new AsyncDiskManager(
+          fmt::format("{}.{}k{}", db_file_name.substr(0, n), page_size / 1024, db_file_name.substr(n)),
+          ASYNC_IO_QUEUE_DEPTH, true, false, checksum_mode);
+    }
+    // The same memory as the frames of the main buffer pool.
+    auto *bpm = new BufferPoolManagerInstance(std::max<size_t>(128 * BUSTUB_PAGE_SIZE / page_size, 16), disk_manager,
+                                              LRUK_REPLACER_K, nullptr, ReplacerPolicy::LRU_K, page_size);
+    // Page 0 of every buffer pool is the header page of its indexes.
+    page_id_t header_page_id;
+    bpm->NewPage(&header_page_id);
+    BUSTUB_ASSERT(header_page_id == HEADER_PAGE_ID, "the header page is the first page of a buffer pool");
+    bpm->UnpinPage(header_page_id, true);
+
+    sized_disk_managers_.push_back(disk_manager);
+    sized_buffer_pool_managers_.push_back(bpm);
+    catalog_->AddBufferPool(bpm);
+  }
+}
+
+auto BustubInstance::GetPageSizeVariable() -> size_t {
+  auto variable = GetSessionVariable("page_size");
+  if (variable.empty()) {
+    return BUSTUB_PAGE_SIZE;
+  }
+  size_t page_size = 0;
+  try {
+    page_size = std::stoul(variable);
+  } catch (std::exception &e) {
+    throw bustub::Exception(fmt::format("invalid page_size {}", variable));
+  }
+  if (catalog_->GetBufferPool(page_size) == nullptr) {
+    throw bustub::Exception(fmt::format("no buffer pool of {} byte pages", page_size));
+  }
+  return page_size;
+}
+
+void BustubInstance::ResizeBufferPool(const std::string &value) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw bustub::Exception("there is no buffer pool to resize");
+  }
+  size_t pool_size = 0;
+  try {
+    pool_size = std::stoul(value);
+  } catch (std::exception &e) {
+    throw bustub::Exception(fmt::format("invalid buffer_pool_size {}", value));
+  }
+  if (!buffer_pool_manager_->Resize(pool_size)) {
+    throw bustub::Exception(fmt::format(
+        "cannot resize the buffer pool to {} frames, it takes {} to {} and pinned pages must be released in time",
+        pool_size, BUFFER_POOL_INSTANCES, BUFFER_POOL_MAX_SIZE));
+  }
+  background_writer_->SetNumCleanFrames(buffer_pool_manager_->GetPoolSize() / 4);
+}
+
 void BustubInstance::CmdDisplayTables(ResultWriter &writer) {
   auto table_names = catalog_->GetTableNames();
   writer.BeginTable(false);
@@ -146,6 +243,52 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayStats(ResultWriter &writer) {
+  // One column for each buffer pool, by page size, the main one first.
+  std::vector<std::pair<BufferPoolManager *, DiskManager *>> pools;
+  if (buffer_pool_manager_ != nullptr) {
+    pools.emplace_back(buffer_pool_manager_, disk_manager_);
+  }
+  for (size_t i = 0; i < sized_buffer_pool_managers_.size(); i++) {
+    pools.emplace_back(sized_buffer_pool_managers_[i], sized_disk_managers_[i]);
+  }
+  std::vector<BufferPoolStats> stats;
+  for (const auto &[bpm, disk_manager] : pools) {
+    stats.push_back(bpm->GetStats());
+  }
+
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("metric");
+  for (const auto &[bpm, disk_manager] : pools) {
+    writer.WriteHeaderCell(fmt::format("page_size={}", bpm->GetPageSize()));
+  }
+  writer.EndHeader();
+  auto write_row = [&](const std::string &metric, const std::function<std::string(size_t)> &value) {
+    writer.BeginRow();
+    writer.WriteCell(metric);
+    for (size_t i = 0; i < pools.size(); i++) {
+      writer.WriteCell(value(i));
+    }
+    writer.EndRow();
+  };
+  write_row("pool_size", [&](size_t i) { return fmt::format("{}", pools[i].first->GetPoolSize()); });
+  write_row("hits", [&](size_t i) { return fmt::format("{}", stats[i].hits_); });
+  write_row("misses", [&](size_t i) { return fmt::format("{}", stats[i].misses_); });
+  write_row("hit_rate", [&](size_t i) { return fmt::format("{:.4f}", stats[i].GetHitRate()); });
+  write_row("evictions", [&](size_t i) { return fmt::format("{}", stats[i].evictions_); });
+  write_row("dirty_evictions", [&](size_t i) { return fmt::format("{}", stats[i].dirty_evictions_); });
+  write_row("pin_waits", [&](size_t i) { return fmt::format("{}", stats[i].pin_waits_); });
+  write_row("evict_ns", [&](size_t i) { return stats[i].evict_latency_.ToString(); });
+  write_row("page_table_probes", [&](size_t i) { return stats[i].probe_length_.ToString(); });
+  write_row("disk_read_ns", [&](size_t i) { return pools[i].second->GetReadLatency().ToString(); });
+  write_row("disk_write_ns", [&](size_t i) { return pools[i].second->GetWriteLatency().ToString(); });
+  write_row("disk_writes", [&](size_t i) { return fmt::format("{}", pools[i].second->GetNumWrites()); });
+  write_row("corrupt_pages", [&](size_t i) { return fmt::format("{}", pools[i].second->GetNumCorruptPages()); });
+  write_row("torn_pages", [&](size_t i) { return fmt::format("{}", pools[i].second->GetNumTornPages()); });
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -159,6 +302,7 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\stats: show buffer pool and disk I/O counters
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -191,6 +335,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\stats") {
+      CmdDisplayStats(writer);
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
@@ -211,8 +359,9 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       case StatementType::CREATE_STATEMENT: {
         const auto &create_stmt = dynamic_cast<const CreateStatement &>(*statement);
 
+        const auto page_size = GetPageSizeVariable();
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_));
+        auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_), true, page_size);
         l.unlock();
 
         if (info == nullptr) {
@@ -237,10 +386,11 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
 
+        const auto page_size = GetPageSizeVariable();
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
         auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
             txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+            INTEGER_SIZE, IntegerHashFunctionType{}, page_size);
         l.unlock();
 
         if (info == nullptr) {
@@ -251,12 +401,17 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       }
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
-        auto content = GetSessionVariable(show_stmt.variable_);
+        auto content = show_stmt.variable_ == "buffer_pool_size" && buffer_pool_manager_ != nullptr
+                           ? std::to_string(buffer_pool_manager_->GetPoolSize())
+                           : GetSessionVariable(show_stmt.variable_);
         WriteOneCell(fmt::format("{}={}", show_stmt.variable_, content), writer);
         continue;
       }
       case StatementType::VARIABLE_SET_STATEMENT: {
         const auto &set_stmt = dynamic_cast<const VariableSetStatement &>(*statement);
+        if (set_stmt.variable_ == "buffer_pool_size") {
+          ResizeBufferPool(set_stmt.value_);
+        }
         session_variables_[set_stmt.variable_] = set_stmt.value_;
         continue;
       }
@@ -395,10 +550,19 @@ BustubInstance::~BustubInstance() {
   delete catalog_;
   delete checkpoint_manager_;
   delete log_manager_;
+  delete background_writer_;
+  delete prefetcher_;
   delete buffer_pool_manager_;
+  for (auto *bpm : sized_buffer_pool_managers_) {
+    delete bpm;
+  }
   delete lock_manager_;
   delete txn_manager_;
+  delete page_scrubber_;
   delete disk_manager_;
+  for (auto *disk_manager : sized_disk_managers_) {
+    delete disk_manager;
+  }
 }
 
 }  // namespace bustub
@@ -16,8 +16,16 @@ namespace bustub {
 
 std::atomic<bool> enable_logging(false);
 
+std::atomic<bool> enable_page_checksums(false);
+
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds background_writer_interval = std::chrono::milliseconds(100);
+
+std::chrono::milliseconds warmup_snapshot_interval = std::chrono::milliseconds(60000);
+
+std::chrono::milliseconds buffer_pool_resize_timeout = std::chrono::milliseconds(1000);
+
 }  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/crc32c.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The CRC-32C polynomial, bit-reversed. */
+constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+
+constexpr auto MakeTable() -> std::array<uint32_t, 256> {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? POLYNOMIAL : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> TABLE = MakeTable();
+
+// The Update functions take and return the CRC register, which Compute() inverts on the way in and out.
+
+auto SoftwareUpdate(uint32_t crc, const char *data, size_t size) -> uint32_t {
+  for (size_t i = 0; i < size; i++) {
+    crc = TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+auto Load64(const char *data) -> uint64_t {
+  uint64_t word;
+  std::memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+#if defined(__x86_64__)
+#define BUSTUB_CRC32C_TARGET __attribute__((target("sse4.2")))
+BUSTUB_CRC32C_TARGET auto Crc8(uint32_t crc, uint8_t byte) -> uint32_t { return _mm_crc32_u8(crc, byte); }
+BUSTUB_CRC32C_TARGET auto Crc64(uint32_t crc, uint64_t word) -> uint32_t {
+  return static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+}
+auto DetectHardware() -> bool {
+  __builtin_cpu_init();  // needed before main()
+  return __builtin_cpu_supports("sse4.2") != 0;
+}
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define BUSTUB_CRC32C_TARGET
+auto Crc8(uint32_t crc, uint8_t byte) -> uint32_t { return __crc32cb(crc, byte); }
+auto Crc64(uint32_t crc, uint64_t word) -> uint32_t { return __crc32cd(crc, word); }
+auto DetectHardware() -> bool { return true; }
+#else
+#define BUSTUB_CRC32C_TARGET
+auto Crc8(uint32_t crc, uint8_t byte) -> uint32_t { return SoftwareUpdate(crc, reinterpret_cast<char *>(&byte), 1); }
+auto Crc64(uint32_t crc, uint64_t word) -> uint32_t {
+  return SoftwareUpdate(crc, reinterpret_cast<char *>(&word), sizeof(word));
+}
+auto DetectHardware() -> bool { return false; }
+#endif
+
+BUSTUB_CRC32C_TARGET auto HardwareUpdate(uint32_t crc, const char *data, size_t size) -> uint32_t {
+  for (; size >= 8; size -= 8, data += 8) {
+    crc = Crc64(crc, Load64(data));
+  }
+  for (; size > 0; size--, data++) {
+    crc = Crc8(crc, static_cast<uint8_t>(*data));
+  }
+  return crc;
+}
+
+/** Four blocks at a time: the crc32 instruction has a latency of three cycles and a throughput of one per cycle. */
+BUSTUB_CRC32C_TARGET void HardwareBlocks(const char *data, size_t block_size, size_t num_blocks, uint32_t *crcs) {
+  const size_t words_size = block_size / 8 * 8;
+  size_t block = 0;
+  for (; block + 4 <= num_blocks; block += 4) {
+    const char *data0 = data + block * block_size;
+    const char *data1 = data0 + block_size;
+    const char *data2 = data1 + block_size;
+    const char *data3 = data2 + block_size;
+    uint32_t crc0 = ~0U;
+    uint32_t crc1 = ~0U;
+    uint32_t crc2 = ~0U;
+    uint32_t crc3 = ~0U;
+    for (size_t offset = 0; offset < words_size; offset += 8) {
+      crc0 = Crc64(crc0, Load64(data0 + offset));
+      crc1 = Crc64(crc1, Load64(data1 + offset));
+      crc2 = Crc64(crc2, Load64(data2 + offset));
+      crc3 = Crc64(crc3, Load64(data3 + offset));
+    }
+    const size_t tail = block_size - words_size;
+    crcs[block] = ~HardwareUpdate(crc0, data0 + words_size, tail);
+    crcs[block + 1] = ~HardwareUpdate(crc1, data1 + words_size, tail);
+    crcs[block + 2] = ~HardwareUpdate(crc2, data2 + words_size, tail);
+    crcs[block + 3] = ~HardwareUpdate(crc3, data3 + words_size, tail);
+  }
+  for (; block < num_blocks; block++) {
+    crcs[block] = ~HardwareUpdate(~0U, data + block * block_size, block_size);
+  }
+}
+
+const bool USES_HARDWARE = DetectHardware();
+
+}  // namespace
+
+auto Crc32c::Compute(const char *data, size_t size, uint32_t crc) -> uint32_t {
+  return ~(USES_HARDWARE ? HardwareUpdate(~crc, data, size) : SoftwareUpdate(~crc, data, size));
+}
+
+void Crc32c::ComputeBlocks(const char *data, size_t block_size, size_t num_blocks, uint32_t *crcs) {
+  if (USES_HARDWARE) {
+    HardwareBlocks(data, block_size, num_blocks, crcs);
+    return;
+  }
+  for (size_t block = 0; block < num_blocks; block++) {
+    crcs[block] = ~SoftwareUpdate(~0U, data + block * block_size, block_size);
+  }
+}
+
+auto Crc32c::UsesHardware() -> bool { return USES_HARDWARE; }
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// histogram.cpp
+//
+// Identification: src/common/histogram.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+void Histogram::Merge(const Histogram &other) {
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    buckets_[i].fetch_add(other.buckets_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void Histogram::Reset() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  sum_.store(0, std::memory_order_relaxed);
+}
+
+auto Histogram::GetCount() const -> uint64_t {
+  uint64_t count = 0;
+  for (const auto &bucket : buckets_) {
+    count += bucket.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+auto Histogram::GetMean() const -> double {
+  const uint64_t count = GetCount();
+  return count == 0 ? 0 : static_cast<double>(GetSum()) / static_cast<double>(count);
+}
+
+auto Histogram::GetPercentile(double percentile) const -> uint64_t {
+  std::array<uint64_t, NUM_BUCKETS> counts;
+  uint64_t count = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    count += counts[i];
+  }
+  if (count == 0) {
+    return 0;
+  }
+  // The rank of the value, counting from 1, so that the 0th percentile is the smallest value.
+  const auto rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(percentile / 100 * count)), 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return BucketUpperBound(i);
+    }
+  }
+  return BucketUpperBound(NUM_BUCKETS - 1);
+}
+
+auto Histogram::ToString() const -> std::string {
+  size_t max_bucket = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    if (buckets_[i].load(std::memory_order_relaxed) != 0) {
+      max_bucket = i;
+    }
+  }
+  return fmt::format("count={} mean={:.1f} p50<={} p99<={} max<={}", GetCount(), GetMean(), GetPercentile(50),
+                     GetPercentile(99), BucketUpperBound(max_bucket));
+}
+
+}  // namespace bustub
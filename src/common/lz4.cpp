@@ -0,0 +1,224 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4.cpp
+//
+// Identification: src/common/lz4.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/lz4.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/** A match is at least 4 bytes, so the match length is stored minus 4. */
+constexpr size_t MIN_MATCH = 4;
+/** The format requires the last 5 bytes of a block to be literals... */
+constexpr size_t LAST_LITERALS = 5;
+/** ...and the last match to start at least 12 bytes before the end. */
+constexpr size_t MF_LIMIT = 12;
+constexpr size_t MAX_OFFSET = 65535;
+/** A length of 15 in a token means more length bytes follow. */
+constexpr size_t TOKEN_MASK = 15;
+constexpr size_t HASH_BITS = 12;
+
+auto Load32(const char *p) -> uint32_t {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+auto Load64(const char *p) -> uint64_t {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+auto Hash(uint32_t sequence) -> size_t { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Write the part of a length over 15 as 255s and a last byte under 255. */
+auto PutLength(size_t length, char **out, const char *end) -> bool {
+  for (; length >= 255; length -= 255) {
+    if (*out == end) {
+      return false;
+    }
+    *(*out)++ = static_cast<char>(255);
+  }
+  if (*out == end) {
+    return false;
+  }
+  *(*out)++ = static_cast<char>(length);
+  return true;
+}
+
+/** Write a sequence, the last one of a block if match_length is 0. */
+auto PutSequence(const char *literals, size_t num_literals, size_t offset, size_t match_length, char **out,
+                 const char *end) -> bool {
+  if (*out == end) {
+    return false;
+  }
+  char *token = (*out)++;
+  if (num_literals >= TOKEN_MASK && !PutLength(num_literals - TOKEN_MASK, out, end)) {
+    return false;
+  }
+  if (static_cast<size_t>(end - *out) < num_literals) {
+    return false;
+  }
+  if (num_literals != 0) {
+    memcpy(*out, literals, num_literals);
+    *out += num_literals;
+  }
+  size_t match_code = 0;
+  if (match_length != 0) {
+    if (end - *out < 2) {
+      return false;
+    }
+    *(*out)++ = static_cast<char>(offset & 0xFF);
+    *(*out)++ = static_cast<char>(offset >> 8);
+    match_code = match_length - MIN_MATCH;
+    if (match_code >= TOKEN_MASK && !PutLength(match_code - TOKEN_MASK, out, end)) {
+      return false;
+    }
+  }
+  *token = static_cast<char>((std::min(num_literals, TOKEN_MASK) << 4) | std::min(match_code, TOKEN_MASK));
+  return true;
+}
+
+/** Read the bytes of a length over 15, adding them to length. */
+auto GetLength(const unsigned char **in, const unsigned char *end, size_t *length) -> bool {
+  unsigned char byte;
+  do {
+    if (*in == end) {
+      return false;
+    }
+    byte = *(*in)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}  // namespace
+
+auto Lz4::Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t {
+  char *out = dst;
+  const char *end = dst + capacity;
+  size_t anchor = 0;
+  if (size > MF_LIMIT && size <= MAX_INPUT_SIZE) {
+    // Positions of the last 4-byte sequence seen with each hash, -1 for none.
+    std::array<int32_t, 1 << HASH_BITS> table;
+    table.fill(-1);
+    const size_t match_limit = size - MF_LIMIT;
+    const size_t match_end_limit = size - LAST_LITERALS;
+    size_t pos = 0;
+    while (pos < match_limit) {
+      const uint32_t sequence = Load32(src + pos);
+      const size_t hash = Hash(sequence);
+      const int32_t candidate = table[hash];
+      table[hash] = static_cast<int32_t>(pos);
+      if (candidate < 0 || pos - candidate > MAX_OFFSET || Load32(src + candidate) != sequence) {
+        // Step faster the longer nothing matched, so incompressible data is skipped quickly.
+        pos += 1 + ((pos - anchor) >> 6);
+        continue;
+      }
+      size_t match = candidate;
+      size_t length = MIN_MATCH;
+      // Extend the match 8 bytes at a time, the first differing byte is the lowest set byte of the XOR.
+      while (pos + length + sizeof(uint64_t) <= match_end_limit) {
+        const uint64_t diff = Load64(src + match + length) ^ Load64(src + pos + length);
+        if (diff != 0) {
+          length += __builtin_ctzll(diff) / 8;
+          break;
+        }
+        length += sizeof(uint64_t);
+      }
+      if (pos + length + sizeof(uint64_t) > match_end_limit) {
+        while (pos + length < match_end_limit && src[match + length] == src[pos + length]) {
+          length++;
+        }
+      }
+      // Extend it backward over the literals too.
+      while (pos > anchor && match > 0 && src[pos - 1] == src[match - 1]) {
+        pos--;
+        match--;
+        length++;
+      }
+      if (!PutSequence(src + anchor, pos - anchor, pos - match, length, &out, end)) {
+        return 0;
+      }
+      pos += length;
+      anchor = pos;
+      if (pos - 2 < match_limit) {
+        table[Hash(Load32(src + pos - 2))] = static_cast<int32_t>(pos - 2);
+      }
+    }
+  }
+  if (size > MAX_INPUT_SIZE || !PutSequence(src + anchor, size - anchor, 0, 0, &out, end)) {
+    return 0;
+  }
+  return out - dst;
+}
+
+auto Lz4::Decompress(const char *src, size_t size, char *dst, size_t dst_size) -> bool {
+  const auto *in = reinterpret_cast<const unsigned char *>(src);
+  const unsigned char *in_end = in + size;
+  char *out = dst;
+  const char *out_end = dst + dst_size;
+  while (true) {
+    if (in == in_end) {
+      return false;
+    }
+    const unsigned char token = *in++;
+    size_t num_literals = token >> 4;
+    if (num_literals == TOKEN_MASK && !GetLength(&in, in_end, &num_literals)) {
+      return false;
+    }
+    if (static_cast<size_t>(in_end - in) < num_literals || static_cast<size_t>(out_end - out) < num_literals) {
+      return false;
+    }
+    memcpy(out, in, num_literals);
+    in += num_literals;
+    out += num_literals;
+    if (in == in_end) {
+      // The last sequence has no match.
+      return out == out_end;
+    }
+    if (in_end - in < 2) {
+      return false;
+    }
+    const size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+    in += 2;
+    if (offset == 0 || offset > static_cast<size_t>(out - dst)) {
+      return false;
+    }
+    size_t length = token & TOKEN_MASK;
+    if (length == TOKEN_MASK && !GetLength(&in, in_end, &length)) {
+      return false;
+    }
+    length += MIN_MATCH;
+    if (static_cast<size_t>(out_end - out) < length) {
+      return false;
+    }
+    const char *match = out - offset;
+    if (offset >= length) {
+      memcpy(out, match, length);
+    } else {
+      // The match overlaps the bytes it produces, a run of a repeated pattern.
+      for (size_t i = 0; i < length; i++) {
+        out[i] = match[i];
+      }
+    }
+    out += length;
+  }
+}
+
+}  // namespace bustub
@@ -322,11 +322,7 @@ auto LockManager::UnlockTable(Transaction *txn, const table_oid_t &oid) -> bool
   return true;
 }
 
-auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const RID &rid) -> bool {
-  std::cout << "Transaction ID: " << txn->GetTransactionId() << std::endl;
-  std::cout << "Transaction State: " << int(txn->GetState()) << std::endl;
-  std::cout << "Isolation Level: " << int(txn->GetIsolationLevel()) << std::endl;
-  std::cout << "Locking row: " << rid << std::endl;
+auto LockManager::CheckRowLock(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool {
   if (txn->GetState() == TransactionState::ABORTED || txn->GetState() == TransactionState::COMMITTED) {
     return false;
   }
@@ -377,12 +373,23 @@ auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_
     throw TransactionAbortException(txn->GetTransactionId(), AbortReason::TABLE_LOCK_NOT_PRESENT);
   }
   lock_queue_table->latch_.unlock();
+  return true;
+}
+
+auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const RID &rid) -> bool {
+  std::cout << "Transaction ID: " << txn->GetTransactionId() << std::endl;
+  std::cout << "Transaction State: " << int(txn->GetState()) << std::endl;
+  std::cout << "Isolation Level: " << int(txn->GetIsolationLevel()) << std::endl;
+  std::cout << "Locking row: " << rid << std::endl;
+  if (!CheckRowLock(txn, lock_mode, oid)) {
+    return false;
+  }
 
   row_lock_map_latch_.lock();
-  if (row_lock_map_.find(rid) == row_lock_map_.end()) {
-    row_lock_map_[rid] = std::make_shared<LockRequestQueue>(); 
+  if (row_lock_map_.find({oid, rid}) == row_lock_map_.end()) {
+    row_lock_map_[{oid, rid}] = std::make_shared<LockRequestQueue>(); 
   }
-  auto lock_queue_row = row_lock_map_[rid];
+  auto lock_queue_row = row_lock_map_[{oid, rid}];
   row_lock_map_latch_.unlock();
 
   std::unique_lock<std::mutex> lock_queue_latch(lock_queue_row->latch_);
@@ -434,18 +441,55 @@ auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_
   return true;
 }
 
+auto LockManager::LockRows(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const std::vector<RID> &rids)
+    -> bool {
+  if (!CheckRowLock(txn, lock_mode, oid)) {
+    return false;
+  }
+
+  // Find the queues of all the rows under one acquisition of the map latch.
+  std::vector<std::shared_ptr<LockRequestQueue>> lock_queues;
+  lock_queues.reserve(rids.size());
+  row_lock_map_latch_.lock();
+  for (const auto &rid : rids) {
+    auto &lock_queue_row = row_lock_map_[{oid, rid}];
+    if (lock_queue_row == nullptr) {
+      lock_queue_row = std::make_shared<LockRequestQueue>();
+    }
+    lock_queues.push_back(lock_queue_row);
+  }
+  row_lock_map_latch_.unlock();
+
+  for (size_t i = 0; i < rids.size(); i++) {
+    std::unique_lock<std::mutex> lock_queue_latch(lock_queues[i]->latch_);
+    if (lock_queues[i]->request_queue_.empty()) {
+      // Nobody else knows the row, as for one just inserted: grant it without waiting.
+      auto *lock_request = new LockRequest(txn->GetTransactionId(), lock_mode, oid, rids[i]);
+      lock_request->granted_ = true;
+      lock_queues[i]->request_queue_.push_back(lock_request);
+      AddRowLockToTxn(txn, lock_mode, oid, rids[i]);
+      continue;
+    }
+    lock_queue_latch.unlock();
+    if (!LockRow(txn, lock_mode, oid, rids[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 auto LockManager::UnlockRow(Transaction *txn, const table_oid_t &oid, const RID &rid) -> bool { 
   std::cout << "Transaction ID: " << txn->GetTransactionId() << std::endl;
   std::cout << "Transaction State: " << int(txn->GetState()) << std::endl;
   std::cout << "Isolation Level: " << int(txn->GetIsolationLevel()) << std::endl;
   std::cout << "Unlocking row: " << rid << std::endl;
   row_lock_map_latch_.lock();
-  if (row_lock_map_.find(rid) == row_lock_map_.end()) {
+  if (row_lock_map_.find({oid, rid}) == row_lock_map_.end()) {
     row_lock_map_latch_.unlock();
     txn->SetState(TransactionState::ABORTED);
     throw TransactionAbortException(txn->GetTransactionId(), AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
   }
-  auto row_lock_queue = row_lock_map_[rid];
+  auto row_lock_queue = row_lock_map_[{oid, rid}];
   row_lock_map_latch_.unlock();
   std::unique_lock<std::mutex> row_lock_queue_latch(row_lock_queue->latch_);
 
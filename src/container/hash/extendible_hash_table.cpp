@@ -10,172 +10,312 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <thread>  // NOLINT
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "container/hash/extendible_hash_table.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
-template <typename K, typename V>
-ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size)
-    : global_depth_(0), bucket_size_(bucket_size), num_buckets_(1) {
-  // Create the first bucket and store it in a shared_ptr
-  dir_.push_back(std::make_shared<Bucket>(bucket_size_, global_depth_));
+namespace {
+
+/** Fingerprints are compared in groups of this many. */
+constexpr size_t FINGERPRINT_GROUP = 16;
+
+/** @return a mask with bit i set if group[i] == fingerprint */
+auto MatchFingerprints(const uint8_t *group, uint8_t fingerprint) -> uint32_t {
+#ifdef __SSE2__
+  const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  const __m128i matches = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(fingerprint)));
+  return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < FINGERPRINT_GROUP; i++) {
+    mask |= static_cast<uint32_t>(group[i] == fingerprint) << i;
+  }
+  return mask;
+#endif
 }
 
+}  // namespace
+
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {
-  int mask = (1 << global_depth_) - 1;
-  return std::hash<K>()(key) & mask;
+ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size) : bucket_size_(bucket_size) {
+  // Create the first bucket and a directory of one entry pointing at it
+  buckets_.push_back(std::make_unique<Bucket>(bucket_size_, 0));
+  directories_.push_back(std::make_unique<Directory>(0));
+  directories_[0]->slots_[0].store(buckets_[0].get(), std::memory_order_relaxed);
+  dir_.store(directories_[0].get(), std::memory_order_release);
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetLocalHighBit(int dir_index) -> int {
-  return 1U << (GetLocalDepth(dir_index) - 1);
+auto ExtendibleHashTable<K, V>::FingerprintOf(size_t hash) -> uint8_t {
+  // The low bits pick the bucket, so the fingerprint comes from the high bits of a multiplicative mix of the hash,
+  // which std::hash leaves as the identity for integers.
+  const auto fingerprint = static_cast<uint8_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 56);
+  return fingerprint == 0 ? 1 : fingerprint;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
-  return GetGlobalDepthInternal();
+auto ExtendibleHashTable<K, V>::BucketOf(size_t hash) const -> Bucket * {
+  const Directory *dir = dir_.load(std::memory_order_acquire);
+  return dir->slots_[hash & (dir->Size() - 1)].load(std::memory_order_acquire);
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetGlobalDepthInternal() const -> int {
-  return global_depth_;
+auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {
+  return std::hash<K>()(key) & (dir_.load(std::memory_order_acquire)->Size() - 1);
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetLocalDepth(int dir_index) const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
-  return GetLocalDepthInternal(dir_index);
+auto ExtendibleHashTable<K, V>::GetLocalHighBit(int dir_index) -> int {
+  return 1U << (GetLocalDepth(dir_index) - 1);
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetLocalDepthInternal(int dir_index) const -> int {
-  return dir_[dir_index]->GetDepth();
+auto ExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {
+  return dir_.load(std::memory_order_acquire)->global_depth_;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetNumBuckets() const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
-  return GetNumBucketsInternal();
+auto ExtendibleHashTable<K, V>::GetLocalDepth(int dir_index) const -> int {
+  return dir_.load(std::memory_order_acquire)->slots_[dir_index].load(std::memory_order_acquire)->GetDepth();
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetNumBucketsInternal() const -> int {
-  return num_buckets_;
+auto ExtendibleHashTable<K, V>::GetNumBuckets() const -> int {
+  return num_buckets_.load(std::memory_order_relaxed);
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  size_t index = IndexOf(key);
-  return dir_[index]->Find(key, value);
+  const size_t hash = std::hash<K>()(key);
+  while (true) {
+    Bucket *bucket = BucketOf(hash);
+    if constexpr (OPTIMISTIC_READS) {
+      const uint64_t version = bucket->version_.load(std::memory_order_acquire);
+      if ((version & 1) != 0) {
+        std::this_thread::yield();
+        continue;
+      }
+      V found{};
+      const bool covers = bucket->Covers(hash);
+      const bool is_found = covers && bucket->Find(key, found);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (!covers || bucket->version_.load(std::memory_order_relaxed) != version) {
+        continue;  // split since we read the directory, or written while we read it
+      }
+      if (is_found) {
+        value = found;
+      }
+      return is_found;
+    } else {
+      bucket->latch_.RLock();
+      if (!bucket->Covers(hash)) {
+        bucket->latch_.RUnlock();
+        continue;
+      }
+      const bool is_found = bucket->Find(key, value);
+      bucket->latch_.RUnlock();
+      return is_found;
+    }
+  }
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Remove(const K &key) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  size_t index = IndexOf(key);
-  return dir_[index]->Remove(key);
+  const size_t hash = std::hash<K>()(key);
+  while (true) {
+    Bucket *bucket = BucketOf(hash);
+    bucket->latch_.WLock();
+    if (!bucket->Covers(hash)) {
+      bucket->latch_.WUnlock();
+      continue;
+    }
+    const bool removed = bucket->Remove(key);
+    bucket->latch_.WUnlock();
+    return removed;
+  }
 }
 
 template <typename K, typename V>
 void ExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {
-  std::scoped_lock<std::mutex> lock(latch_);
-  size_t index = IndexOf(key);
+  const size_t hash = std::hash<K>()(key);
+  while (true) {
+    Bucket *bucket = BucketOf(hash);
+    bucket->latch_.WLock();
+    if (!bucket->Covers(hash)) {
+      bucket->latch_.WUnlock();
+      continue;
+    }
+    const bool inserted = bucket->Insert(key, value);
+    bucket->latch_.WUnlock();
+    if (inserted) {
+      return;
+    }
+    SplitBucket(hash);
+  }
+}
 
-  if (dir_[index]->Insert(key, value)) {
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::SplitBucket(size_t hash) {
+  std::scoped_lock<std::mutex> split_lock(split_latch_);
+  // Only splits change the directory, so the bucket found now covers hash.
+  Bucket *bucket = BucketOf(hash);
+  bucket->latch_.WLock();
+  if (!bucket->IsFull()) {
+    bucket->latch_.WUnlock();
     return;
   }
 
-  int local_depth = dir_[index]->GetDepth();
+  const int local_depth = bucket->GetDepth();
+  Directory *dir = dir_.load(std::memory_order_relaxed);
 
-  // double entries of the directory (and inc global depth)
-  if (local_depth == global_depth_) {
-    size_t dir_size = dir_.size();
-    dir_.reserve(2 * dir_size);
-    std::copy_n(dir_.begin(), dir_size, std::back_inserter(dir_));
-    ++global_depth_;
+  // double entries of the directory (and inc global depth) into a new directory, leaving the old one to its readers
+  if (local_depth == dir->global_depth_) {
+    auto doubled = std::make_unique<Directory>(dir->global_depth_ + 1);
+    for (size_t i = 0; i < doubled->Size(); i++) {
+      doubled->slots_[i].store(dir->slots_[i & (dir->Size() - 1)].load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+    }
+    dir = doubled.get();
+    directories_.push_back(std::move(doubled));
+    dir_.store(dir, std::memory_order_release);
   }
 
-  auto bucket_0 = std::make_shared<Bucket>(bucket_size_, local_depth + 1);
-  auto bucket_1 = std::make_shared<Bucket>(bucket_size_, local_depth + 1);
-  ++num_buckets_;
-  int local_depth_mask = 1 << local_depth;
-
-  // re-distribute the pairs back in the right buckets
-  for (const auto &[k, v] : dir_[index]->GetItems()) {
-    size_t item_hash = std::hash<K>()(k);
-    if (static_cast<bool>(item_hash & local_depth_mask)) {
-      bucket_1->Insert(k, v);
-    } else {
-      bucket_0->Insert(k, v);
+  // The split image takes the pairs whose hash has the new bit set, and is complete before anyone can reach it.
+  const size_t local_depth_mask = static_cast<size_t>(1) << local_depth;
+  auto image = std::make_unique<Bucket>(bucket_size_, local_depth + 1, bucket->prefix_ | local_depth_mask);
+  for (size_t i = 0; i < bucket->size_; i++) {
+    if (bucket->fingerprints_[i] != 0 && (std::hash<K>()(bucket->keys_[i]) & local_depth_mask) != 0) {
+      image->Insert(bucket->keys_[i], bucket->values_[i]);
     }
   }
 
+  // Readers of the bucket wait from before the image is reachable, and a writer may update it, until the bucket has
+  // dropped the moved pairs and stopped covering their hashes.
+  bucket->BeginWrite();
+
   // Adjust the directory pointers
-  for (size_t i = (std::hash<K>()(key) & (local_depth_mask - 1)); i < dir_.size(); i += local_depth_mask) {
-    if (static_cast<bool>(i & local_depth_mask)) {
-      dir_[i] = bucket_1;
-    } else {
-      dir_[i] = bucket_0;
+  for (size_t i = image->prefix_; i < dir->Size(); i += local_depth_mask << 1) {
+    dir->slots_[i].store(image.get(), std::memory_order_release);
+  }
+
+  for (size_t i = 0; i < bucket->size_; i++) {
+    if (bucket->fingerprints_[i] != 0 && (std::hash<K>()(bucket->keys_[i]) & local_depth_mask) != 0) {
+      bucket->fingerprints_[i] = 0;
+      bucket->num_items_--;
     }
   }
-  latch_.unlock();
-  Insert(key, value);
-  latch_.lock();
+  bucket->IncrementDepth();
+  bucket->EndWrite();
+  bucket->latch_.WUnlock();
+
+  buckets_.push_back(std::move(image));
+  num_buckets_.fetch_add(1, std::memory_order_relaxed);
 }
 
 //===--------------------------------------------------------------------===//
 // Bucket
 //===--------------------------------------------------------------------===//
 template <typename K, typename V>
-ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth) : size_(array_size), depth_(depth) {}
+ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth, size_t prefix)
+    : size_(array_size),
+      depth_(depth),
+      prefix_(prefix),
+      fingerprints_((array_size + FINGERPRINT_GROUP - 1) / FINGERPRINT_GROUP * FINGERPRINT_GROUP, 0),
+      keys_(array_size),
+      values_(array_size) {}
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) -> bool {
-  for (const auto &[k, v] : list_) {
-    if (key == k) {
-      value = v;
-      return true;
+auto ExtendibleHashTable<K, V>::Bucket::FirstSlotWith(uint8_t fingerprint) const -> size_t {
+  for (size_t group = 0; group < fingerprints_.size(); group += FINGERPRINT_GROUP) {
+    const uint32_t matches = MatchFingerprints(&fingerprints_[group], fingerprint);
+    if (matches != 0) {
+      return std::min(size_, group + __builtin_ctz(matches));
     }
   }
-  return false;
+  return size_;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
-  // Need the iterator for erase (list)
-  for (auto it = list_.begin(); it != list_.end(); ++it) {
-    if (key == it->first) {
-      list_.erase(it);
-      return true;
+auto ExtendibleHashTable<K, V>::Bucket::SlotOf(const K &key) const -> size_t {
+  const uint8_t fingerprint = FingerprintOf(std::hash<K>()(key));
+  for (size_t group = 0; group < fingerprints_.size(); group += FINGERPRINT_GROUP) {
+    // Padding is 0 and fingerprints never are, so every match is a real slot.
+    for (uint32_t matches = MatchFingerprints(&fingerprints_[group], fingerprint); matches != 0;
+         matches &= matches - 1) {
+      const size_t slot = group + __builtin_ctz(matches);
+      if (keys_[slot] == key) {
+        return slot;
+      }
     }
   }
-  return false;
+  return size_;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value) -> bool {
-  if (IsFull()) {
+void ExtendibleHashTable<K, V>::Bucket::BeginWrite() {
+  version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::Bucket::EndWrite() {
+  version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) const -> bool {
+  const size_t slot = SlotOf(key);
+  if (slot == size_) {
+    return false;
+  }
+  value = values_[slot];
+  return true;
+}
+
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
+  const size_t slot = SlotOf(key);
+  if (slot == size_) {
     return false;
   }
+  BeginWrite();
+  fingerprints_[slot] = 0;
+  num_items_--;
+  EndWrite();
+  return true;
+}
 
-  for (auto &[k, v] : list_) {
-    if (key == k) {
-      v = value;
-      return true;
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value) -> bool {
+  size_t slot = SlotOf(key);
+  if (slot == size_) {
+    if (IsFull()) {
+      return false;
     }
+    slot = FirstSlotWith(0);
   }
 
-  list_.emplace_back(key, value);
+  BeginWrite();
+  if (fingerprints_[slot] == 0) {
+    keys_[slot] = key;
+    fingerprints_[slot] = FingerprintOf(std::hash<K>()(key));
+    num_items_++;
+  }
+  values_[slot] = value;
+  EndWrite();
   return true;
 }
 
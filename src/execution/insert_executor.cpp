@@ -26,7 +26,8 @@ void InsertExecutor::Init() {
   table_ = table_info_->table_.get();
   table_name_ = table_info_->name_;
 
-  if (!exec_ctx_->GetLockManager()->LockTable(exec_ctx_->GetTransaction(), LockManager::LockMode::INTENTION_EXCLUSIVE, plan_->table_oid_)) {
+  if (!exec_ctx_->GetLockManager()->LockTable(exec_ctx_->GetTransaction(), LockManager::LockMode::INTENTION_EXCLUSIVE,
+                                              plan_->table_oid_)) {
     throw ExecutionException("LOCK TABLE EXCLUSIVE FAILED");
   }
   // Initialize the child executor
@@ -40,23 +41,36 @@ auto InsertExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   }
   RID rid_;
   Tuple tup;
+  std::vector<Tuple> batch;
+  std::vector<RID> rids;
+  auto indexes = this->GetExecutorContext()->GetCatalog()->GetTableIndexes(table_name_);
 
   int num_inserted = 0;
 
-  while (child_executor_->Next(&tup, &rid_)) {
-    if (!table_->InsertTuple(tup, &rid_, this->GetExecutorContext()->GetTransaction())) {
+  bool has_next = true;
+  while (has_next) {
+    batch.clear();
+    while (batch.size() < BATCH_SIZE && (has_next = child_executor_->Next(&tup, &rid_))) {
+      batch.push_back(tup);
+    }
+    if (batch.empty()) {
+      break;
+    }
+    if (!table_->InsertTuples(batch, &rids, this->GetExecutorContext()->GetTransaction())) {
       return false;
     }
-    if (!exec_ctx_->GetLockManager()->LockRow(exec_ctx_->GetTransaction(), LockManager::LockMode::EXCLUSIVE, plan_->table_oid_, rid_)) {
+    if (!exec_ctx_->GetLockManager()->LockRows(exec_ctx_->GetTransaction(), LockManager::LockMode::EXCLUSIVE,
+                                               plan_->table_oid_, rids)) {
       throw ExecutionException("LOCK ROW EXCLUSIVE FAILED");
     }
-    auto indexes = this->GetExecutorContext()->GetCatalog()->GetTableIndexes(table_name_);
     for (auto i : indexes) {
-      auto key = tup.KeyFromTuple(table_info_->schema_, i->key_schema_, i->index_->GetKeyAttrs());
-      i->index_->InsertEntry(key, rid_, this->GetExecutorContext()->GetTransaction());
+      for (size_t j = 0; j < batch.size(); j++) {
+        auto key = batch[j].KeyFromTuple(table_info_->schema_, i->key_schema_, i->index_->GetKeyAttrs());
+        i->index_->InsertEntry(key, rids[j], this->GetExecutorContext()->GetTransaction());
+      }
     }
 
-    num_inserted++;
+    num_inserted += static_cast<int>(batch.size());
   }
 
   // prepare schema of one column of type integer
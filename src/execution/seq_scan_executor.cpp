@@ -20,7 +20,7 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNod
 void SeqScanExecutor::Init() {
   // .get() returns a raw pointer to the managed object (the table_)
   table_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())->table_.get();
-  iter_ = std::make_unique<TableIterator>(table_->Begin(exec_ctx_->GetTransaction()));
+  iter_ = std::make_unique<TableIterator>(table_->Begin(exec_ctx_->GetTransaction(), AccessHint::SEQUENTIAL_SCAN));
   if (exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED 
   && !exec_ctx_->GetLockManager()->LockTable(exec_ctx_->GetTransaction(), LockManager::LockMode::INTENTION_SHARED, plan_->GetTableOid())) {
     throw ExecutionException("LOCK TABLE SHARED FAILED");
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/frame_replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST 2003).
+ *
+ * Resident frames are split between T1, the LRU of pages referenced once since they were loaded, and T2, the LRU of
+ * pages referenced again. The ghost lists B1 and B2 remember pages recently evicted from T1 and T2. A hit in B1 grows
+ * the target size p of T1 and a hit in B2 shrinks it, so the split between recency and frequency follows the
+ * workload. A scan only churns T1 once p has shrunk, and leaves T2 alone.
+ */
+class ARCReplacer : public FrameReplacer {
+ public:
+  /**
+   * @brief Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  /**
+   * @brief Evict the least recently used evictable frame of T1 if T1 is larger than p, else of T2. Falls back to the
+   * other list if the preferred one has no evictable frame. The page of the victim is remembered in B1 or B2.
+   */
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  /**
+   * @brief A hit moves the frame to the front of T2. A new frame enters T2 if its page is in a ghost list, adapting
+   * p on the way, and T1 otherwise.
+   */
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void SetCapacity(size_t num_frames) override;
+
+ private:
+  enum class ListType { NONE, T1, T2 };
+
+  struct FrameEntry {
+    ListType list_{ListType::NONE};
+    bool is_evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    std::list<frame_id_t>::iterator position_;
+  };
+
+  /** @brief Evict the evictable frame closest to the back of list. Caller should acquire the latch. */
+  auto EvictFrom(std::list<frame_id_t> *list, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Keep |T1| + |B1| <= c and |B1| + |B2| <= c, which bounds the directory to 2c pages. Caller should acquire
+   * the latch.
+   */
+  void TrimGhosts();
+
+  size_t curr_size_{0};
+  /** c, the number of frames. */
+  size_t replacer_size_;
+  /** p, the target size of T1. */
+  size_t t1_target_{0};
+  std::mutex latch_;
+
+  /** Indexed by frame id. */
+  std::vector<FrameEntry> entries_;
+  /** LRU lists of resident frames, most recently used at the front. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** Pages recently evicted from T1 and T2. */
+  GhostList b1_;
+  GhostList b2_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// background_writer.h
+//
+// Identification: src/include/buffer/background_writer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <string>
+#include <thread>              // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BackgroundWriter writes back dirty pages of a buffer pool on a background thread, so that the frames the replacer
+ * picks next are clean and a FetchPage() that misses rarely waits for a write. Every interval it asks the buffer pool
+ * to keep num_clean_frames frames free or clean, see BufferPoolManager::WriteBackDirtyPages().
+ */
+class BackgroundWriter {
+ public:
+  /**
+   * Create a new BackgroundWriter and start its background thread.
+   * @param buffer_pool_manager the buffer pool to clean
+   * @param num_clean_frames how many free or clean unpinned frames to keep
+   * @param interval how long the background thread sleeps between rounds
+   */
+  BackgroundWriter(BufferPoolManager *buffer_pool_manager, size_t num_clean_frames,
+                   std::chrono::milliseconds interval = background_writer_interval);
+
+  /** Stop and join the background thread. */
+  ~BackgroundWriter();
+
+  /** Run a round now instead of at the end of the current interval. */
+  void Wake();
+
+  /** @return how many pages the background thread has written */
+  auto GetNumWritten() const -> size_t { return num_written_; }
+
+  /** @return how many rounds the background thread has run */
+  auto GetNumRounds() const -> size_t { return num_rounds_; }
+
+  /** Change how many free or clean unpinned frames to keep, e.g. after the buffer pool was resized. */
+  void SetNumCleanFrames(size_t num_clean_frames) { num_clean_frames_ = num_clean_frames; }
+
+  /**
+   * Also write a warm-up snapshot of the buffer pool every interval, see BufferPoolManager::SaveWarmupSnapshot(), so
+   * that a restart after a crash can warm up too.
+   * @param file_name the snapshot file, empty to stop writing snapshots
+   * @param interval how often to write it, rounded up to the interval of the rounds
+   */
+  void SaveWarmupSnapshots(const std::string &file_name, std::chrono::milliseconds interval = warmup_snapshot_interval);
+
+  /** @return how many warm-up snapshots the background thread has written */
+  auto GetNumSnapshots() const -> size_t { return num_snapshots_; }
+
+ private:
+  /** Run a round every interval_ until the writer is destroyed. */
+  void Run();
+
+  /** Write a warm-up snapshot if one is due. */
+  void SaveWarmupSnapshotIfDue();
+
+  BufferPoolManager *buffer_pool_manager_;
+  std::atomic<size_t> num_clean_frames_;
+  const std::chrono::milliseconds interval_;
+
+  /** Protects woken_, stop_ and the snapshot settings. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool woken_{false};
+  bool stop_{false};
+  std::string snapshot_file_name_;
+  std::chrono::milliseconds snapshot_interval_{0};
+  std::chrono::steady_clock::time_point last_snapshot_;
+
+  std::atomic<size_t> num_written_{0};
+  std::atomic<size_t> num_rounds_{0};
+  std::atomic<size_t> num_snapshots_{0};
+
+  std::thread worker_;
+};
+
+}  // namespace bustub
@@ -14,15 +14,65 @@
 
 #include <list>
 #include <mutex>  // NOLINT
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/lru_replacer.h"
+#include "buffer/warmup_snapshot.h"
+#include "common/histogram.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+class ReadAheadPrefetcher;
+
+/**
+ * What a page is fetched for. Every hint but NORMAL belongs to a pass over many pages that are unlikely to be reused
+ * soon. The buffer pool keeps the pages such a pass loads in a small ring of frames that it recycles, as the buffer
+ * access strategies of PostgreSQL do, so that the pass cannot push the rest of the working set out of the pool.
+ */
+enum class AccessHint { NORMAL = 0, SEQUENTIAL_SCAN, BULK_WRITE, VACUUM };
+
+/**
+ * What a buffer pool has counted since it was created, see BufferPoolManager::GetStats(). The I/O the pool does is
+ * timed by its DiskManager.
+ */
+struct BufferPoolStats {
+  /** Fetches of a page that was resident. */
+  uint64_t hits_{0};
+  /** Fetches that read the page from disk. */
+  uint64_t misses_{0};
+  /** Pages dropped from their frame to make room for another page. */
+  uint64_t evictions_{0};
+  /** Evictions that had to write the page back first. */
+  uint64_t dirty_evictions_{0};
+  /** Times a fetch found the frame it wanted claimed by an eviction or a load, and had to wait for it. */
+  uint64_t pin_waits_{0};
+  /** Nanoseconds the replacer took to pick each victim. */
+  Histogram evict_latency_;
+  /** Slots the page table read on each lookup of a fetch. */
+  Histogram probe_length_;
+
+  /** Add the counts of other, as a parallel buffer pool does for its instances. */
+  void Merge(const BufferPoolStats &other) {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    evictions_ += other.evictions_;
+    dirty_evictions_ += other.dirty_evictions_;
+    pin_waits_ += other.pin_waits_;
+    evict_latency_.Merge(other.evict_latency_);
+    probe_length_.Merge(other.probe_length_);
+  }
+
+  /** @return the fraction of fetches that were hits, 0 if there were none */
+  auto GetHitRate() const -> double {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -45,6 +95,20 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch the requested page on behalf of the access pattern described by hint.
+   * @param page_id id of page to be fetched
+   * @param hint what the page is fetched for
+   * @param callback grading callback
+   * @return the requested page, nullptr if it could not be fetched
+   */
+  auto FetchPage(page_id_t page_id, AccessHint hint, bufferpool_callback_fn callback = nullptr) -> Page * {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPgImp(page_id, hint);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -87,6 +151,66 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /**
+   * Change the number of frames of the buffer pool while it is in use.
+   * @param pool_size the new number of frames
+   * @return false if the buffer pool could not be resized, it keeps its size then
+   */
+  virtual auto Resize(__attribute__((unused)) size_t pool_size) -> bool { return false; }
+
+  /** @return the size of the pages of the buffer pool in bytes, a multiple of BUSTUB_PAGE_SIZE */
+  virtual auto GetPageSize() const -> size_t { return BUSTUB_PAGE_SIZE; }
+
+  /**
+   * Write back unpinned dirty pages, in page id order, until at least num_clean_frames frames can be reused without
+   * a write. This is what the background writer calls, so that evictions rarely have to write.
+   * @param num_clean_frames how many free or clean unpinned frames to aim for
+   * @return the number of pages written
+   */
+  virtual auto WriteBackDirtyPages(size_t num_clean_frames) -> size_t = 0;
+
+  /** @return the counters of the buffer pool, read while it keeps running, so they need not add up exactly */
+  virtual auto GetStats() -> BufferPoolStats { return {}; }
+
+  /** @return the pages resident in the buffer pool, with the access history the replacer keeps of each of them */
+  virtual auto GetWarmupEntries() -> std::vector<WarmupEntry> { return {}; }
+
+  /**
+   * Load the pages of a warm-up snapshot into free frames, in page id order so that runs of consecutive pages are
+   * read with one request, and give the replacer their access history back. Meant for a buffer pool over an existing
+   * database before it is used. Pages already resident are skipped, and if the free frames cannot hold every page, the
+   * most recently accessed ones are loaded.
+   * @param entries the pages of the snapshot
+   * @return the number of pages loaded
+   */
+  virtual auto WarmUp(__attribute__((unused)) const std::vector<WarmupEntry> &entries) -> size_t { return 0; }
+
+  /**
+   * Write the pages resident in the buffer pool to a warm-up snapshot, see WarmupSnapshot.
+   * @return false if the snapshot could not be written
+   */
+  auto SaveWarmupSnapshot(const std::string &file_name) -> bool {
+    return WarmupSnapshot::Save(file_name, GetWarmupEntries());
+  }
+
+  /**
+   * WarmUp() from a snapshot file written by SaveWarmupSnapshot().
+   * @return the number of pages loaded, 0 if there is no valid snapshot
+   */
+  auto LoadWarmupSnapshot(const std::string &file_name) -> size_t {
+    std::vector<WarmupEntry> entries;
+    return WarmupSnapshot::Load(file_name, &entries) ? WarmUp(entries) : 0;
+  }
+
+  /** @return the prefetcher scans over this buffer pool read ahead through, nullptr if there is none */
+  auto GetPrefetcher() const -> ReadAheadPrefetcher * { return prefetcher_; }
+
+  /**
+   * Let scans over this buffer pool read ahead through prefetcher. The buffer pool does not own it.
+   * @param prefetcher the prefetcher, nullptr to stop reading ahead
+   */
+  void SetPrefetcher(ReadAheadPrefetcher *prefetcher) { prefetcher_ = prefetcher; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -108,6 +232,15 @@ class BufferPoolManager {
    */
   virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool on behalf of an access pattern. Buffer pools without access
+   * strategies treat every hint as NORMAL.
+   * @param page_id id of page to be fetched
+   * @param hint what the page is fetched for
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, AccessHint hint) -> Page * { return FetchPgImp(page_id); }
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -141,5 +274,8 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+ private:
+  ReadAheadPrefetcher *prefetcher_{nullptr};
 };
 }  // namespace bustub
@@ -12,15 +12,21 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/frame_replacer.h"
+#include "buffer/page_table.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -29,6 +35,10 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * The pages of an instance are page_size bytes, a multiple of BUSTUB_PAGE_SIZE. The disk manager only deals in
+ * BUSTUB_PAGE_SIZE pages, so with larger pages page id p is stored as the run of disk pages starting at
+ * p * (page_size / BUSTUB_PAGE_SIZE). An instance of larger pages needs a disk manager of its own.
  */
 class BufferPoolManagerInstance : public BufferPoolManager {
  public:
@@ -38,9 +48,30 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_policy the replacement policy to evict frames with
+   * @param page_size the size of the pages in bytes, a multiple of BUSTUB_PAGE_SIZE up to BUSTUB_MAX_PAGE_SIZE
+   * @param max_pool_size the number of frames Resize() may grow the pool to, 0 for pool_size
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K,
+                            size_t page_size = BUSTUB_PAGE_SIZE, size_t max_pool_size = 0);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_policy the replacement policy to evict frames with
+   * @param page_size the size of the pages in bytes, a multiple of BUSTUB_PAGE_SIZE up to BUSTUB_MAX_PAGE_SIZE
+   * @param max_pool_size the number of frames Resize() may grow the pool to, 0 for pool_size
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K,
+                            size_t page_size = BUSTUB_PAGE_SIZE, size_t max_pool_size = 0);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -50,9 +81,51 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
+  /** @brief Return the number of frames the buffer pool can be resized to. */
+  auto GetMaxPoolSize() const -> size_t { return max_pool_size_; }
+
+  /**
+   * @brief Change the number of frames of the buffer pool while it is in use, between 1 and the max pool size.
+   *
+   * Growing adds free frames. Shrinking drops the frames at the end of the pool: their pages are written back if dirty
+   * and evicted as soon as they are unpinned, and no page is loaded into them meanwhile. The replacer is resized to
+   * match. The page table is sized for the max pool size up front, so it does not change.
+   *
+   * @return false if the size is out of range, or if the dropped frames still held pinned pages after
+   * buffer_pool_resize_timeout, in which case the pool keeps its size
+   */
+  auto Resize(size_t pool_size) -> bool override;
+
+  /** @brief Return the size of the pages of the buffer pool in bytes. */
+  auto GetPageSize() const -> size_t override { return page_size_; }
+
+  /**
+   * @brief Return the resident pages with their replacer history. Pages in the ring of a scan are left out, they are
+   * not part of the working set.
+   */
+  auto GetWarmupEntries() -> std::vector<WarmupEntry> override;
+
+  /**
+   * @brief Load the pages of a warm-up snapshot that belong to this instance into free frames, see
+   * BufferPoolManager::WarmUp(). The pages are read under the latch, like a miss, in runs of consecutive disk pages.
+   */
+  auto WarmUp(const std::vector<WarmupEntry> &entries) -> size_t override;
+
+  /**
+   * @brief Return the counters of the instance. Buffer hits bump counters striped like the access buffers, so that
+   * concurrent hits do not contend on one cache line; the other counters are bumped under the latch.
+   */
+  auto GetStats() -> BufferPoolStats override;
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /**
+   * @brief Write back the unpinned dirty pages with the lowest page ids, until num_clean_frames frames are free or
+   * hold an unpinned clean page. The pages are written without the latch, each one pinned and read latched.
+   */
+  auto WriteBackDirtyPages(size_t num_clean_frames) -> size_t override;
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -91,6 +164,19 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * @brief Fetch the requested page on behalf of an access pattern. A NORMAL fetch is FetchPgImp(page_id).
+   *
+   * Any other hint does not count a buffer hit as an access in the replacer, so that a pass reading every tuple of a
+   * page does not make the page look hot. A miss recycles the oldest frame of the hint's ring once the ring is full,
+   * and the loaded page joins the ring.
+   *
+   * @param page_id id of page to be fetched
+   * @param hint what the page is fetched for
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, AccessHint hint) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -138,6 +224,9 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * TODO(P1): Add implementation
    *
    * @brief Flush all the pages in the buffer pool to disk.
+   *
+   * The pages to write are collected under one hold of the latch and written in page id order without it. Unpinned
+   * clean pages are skipped, they are already on disk.
    */
   void FlushAllPgsImp() override;
 
@@ -164,27 +253,224 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto GetFrame(frame_id_t *frame_id) -> bool;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
+  /**
+   * @brief replacer_->Evict(), timed into evict_latency_. Caller should acquire the latch before calling this function.
+   */
+  auto EvictFrame(frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Write back the page of a claimed frame if it is dirty, and drop it from the page table. Caller should
+   * acquire the latch before calling this function.
+   */
+  void DetachPage(frame_id_t frame_id);
+
+  /**
+   * @brief Take a claimed frame past the end of a shrinking pool out of use. It stays claimed, so that the fast path
+   * cannot pin it until a resize brings it back. Caller should acquire the latch before calling this function.
+   */
+  void RetireFrame(frame_id_t frame_id);
+
+  /** @brief Resize() to more frames. Caller should hold resize_latch_. */
+  void GrowPool(size_t pool_size);
+
+  /** @brief Resize() to fewer frames. Caller should hold resize_latch_. */
+  auto ShrinkPool(size_t pool_size) -> bool;
+
+  /** @return the number of frames the ring of hint may hold in this instance */
+  auto RingCapacity(AccessHint hint) const -> size_t;
+
+  /**
+   * @brief Take the oldest frame of the ring of hint, if the ring is full and that frame is unpinned and has not been
+   * accessed by a NORMAL fetch since. Caller should acquire the latch before calling this function.
+   * @param[out] frame_id the recycled frame, already removed from the replacer and the page table
+   * @return false if the caller has to get a frame through GetFrame()
+   */
+  auto GetRingFrame(AccessHint hint, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Add a frame that was just loaded on behalf of hint to the ring of hint. Caller should acquire the latch
+   * before calling this function.
+   */
+  void AddToRing(AccessHint hint, frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * @brief Buffer-hit fast path of FetchPgImp(). Finds the frame through the page table and pins it with a CAS on the
+   * pin count, without taking latch_ or touching the replacer. A NORMAL access is only buffered
+   * and reaches the replacer with the next batch.
+   * @param page_id id of page to be fetched
+   * @param hint what the page is fetched for
+   * @return the pinned page, or nullptr if the caller has to take the latched path
+   */
+  auto FetchPgFast(page_id_t page_id, AccessHint hint) -> Page *;
+
+  /**
+   * @brief Claim an unpinned frame by swapping its pin count from 0 to -1, so that the fast path cannot pin it while
+   * its page is written back, replaced or deleted. Caller should acquire the latch before calling this function, and
+   * publishes the frame again by storing its new pin count.
+   * @return false if the frame is pinned
+   */
+  auto ClaimFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Pin a frame with a CAS on its pin count, without taking the latch. The caller checks that the frame still
+   * holds the page it wants, and drops the pin with UnpinFrame().
+   * @return false if the frame is claimed
+   */
+  auto PinFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Read a page into the data of a frame, or write it from there, as one disk page or as the run of disk pages
+   * it spans. Returns once the I/O has completed.
+   */
+  void FrameIO(bool is_write, page_id_t page_id, char *data);
+
+  /**
+   * @brief Append the requests of one page to a batch, one per disk page it spans.
+   */
+  void AddPageRequests(std::vector<DiskRequest> *requests, bool is_write, page_id_t page_id, char *data) const;
 
-  /** Array of buffer pool pages. */
+  /**
+   * @brief Write back pages as one batch of DiskManager requests, without holding the latch. Each page is pinned until
+   * its write completes, so that it cannot be evicted meanwhile. Pages that left their frame since they were collected
+   * are skipped.
+   * @param pages (page id, frame id) pairs collected under the latch, in the order to submit them
+   * @param background the pages were unpinned when collected: skip the ones cleaned since, and write a copy taken
+   * under the read latch of the others so that no update is written half done
+   * @return the number of pages written
+   */
+  auto WritePages(const std::vector<std::pair<page_id_t, frame_id_t>> &pages, bool background) -> size_t;
+
+  /**
+   * @brief Buffer-hit fast path of UnpinPgImp(). Finds the frame through the page table and drops the pin without
+   * taking latch_, unless it was the last one.
+   * @return false if the caller has to take the latched path
+   */
+  auto UnpinPgFast(page_id_t page_id, bool is_dirty) -> bool;
+
+  /**
+   * @brief Toggle whether the replacer may evict a frame, and mirror it in evictable_. Caller should acquire the latch
+   * before calling this function.
+   */
+  void SetFrameEvictable(frame_id_t frame_id, bool set_evictable);
+
+  /**
+   * @brief Drop a pin without holding the latch. If that was the last pin and the replacer has the frame as
+   * non-evictable, the latch is taken to make it evictable again.
+   * @return false if the frame was not pinned
+   */
+  auto UnpinFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Buffer an access seen by the fast path in this thread's access buffer. A full batch is applied to the
+   * replacer, opportunistically once ACCESS_BATCH_SIZE accesses are buffered and unconditionally once the buffer is
+   * full.
+   */
+  void RecordAccessFast(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * @brief Apply every access buffered by the fast path that has not been applied yet, so that the replacer sees
+   * recent hits before it picks a victim. Caller should acquire the latch before calling this function.
+   */
+  void DrainAccessBuffers();
+
+  /** Number of striped access buffers; threads are spread over them by thread id. */
+  static constexpr size_t ACCESS_BUFFER_STRIPES = 16;
+  /** Accesses a buffer holds before the fast path has to wait for latch_ to apply them. */
+  static constexpr size_t ACCESS_BUFFER_CAPACITY = 64;
+  /** Accesses a buffer holds before the fast path tries to apply them if latch_ happens to be free. */
+  static constexpr size_t ACCESS_BATCH_SIZE = 32;
+
+  /**
+   * Accesses recorded by the fast path, as (frame, page) pairs. A batch is applied to the replacer under latch_ and an
+   * entry whose frame has been given to another page since is dropped. The spin lock is only ever tried by threads
+   * that hold latch_, so a fast path that holds it may block on latch_ without deadlocking.
+   */
+  struct alignas(64) AccessBuffer {
+    std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+    size_t size_{0};
+    std::array<std::pair<frame_id_t, page_id_t>, ACCESS_BUFFER_CAPACITY> entries_;
+  };
+
+  /** Counters of the fast path, one per stripe. */
+  struct alignas(64) FastPathStats {
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> pin_waits_{0};
+    Histogram probe_length_;
+  };
+
+  /** @return the stripe of the access buffers and the fast path counters the calling thread uses */
+  static auto ThreadStripe() -> size_t;
+
+  /**
+   * @brief Apply and empty one access buffer. Caller should acquire the latch and the buffer's spin lock before
+   * calling this function.
+   */
+  void ApplyAccesses(AccessBuffer *buffer);
+
+  /** Number of pages in the buffer pool. Frames at or past it are being drained or out of use. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames the pool can grow to, the arena, the page table and the per-frame arrays are sized for it. */
+  const size_t max_pool_size_;
+  /** Number of pages constructed in pages_, the most frames the pool has had. Changed under latch_. */
+  size_t constructed_frames_;
+  /** Size of the pages in bytes. */
+  const size_t page_size_;
+  /** Number of BUSTUB_PAGE_SIZE disk pages a page spans. */
+  const size_t disk_pages_per_page_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /** The next page id to be allocated, each instance only hands out ids that map back to itself */
+  std::atomic<page_id_t> next_page_id_;
+
+  /** The data of the frames, one page aligned mapping. */
+  FrameArena arena_;
+  /** Array of buffer pool pages, room for max_pool_size_ of them, constructed in place over the frames of arena_. */
   Page *pages_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  /**
+   * Page table for keeping track of buffer pool pages. Updated under latch_, and read without it by the fast path,
+   * which checks the page id of the frame it pinned since the frame may have been given to another page meanwhile.
+   */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  FrameReplacer *replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * Whether the replacer was last told that a frame is evictable (free frames count as evictable). Pins taken by the
+   * fast path leave it untouched, so their last unpin can skip the latch.
+   */
+  std::unique_ptr<std::atomic<bool>[]> evictable_;
+  /**
+   * Rings of frames recycled by fetches other than NORMAL, indexed by hint, as (frame, page) pairs with the oldest at
+   * the front. An entry whose frame holds another page by now is dropped when it reaches the front.
+   */
+  std::array<std::deque<std::pair<frame_id_t, page_id_t>>, 4> rings_;
+  /** Whether a frame was loaded into a ring and has not been accessed by a NORMAL fetch since. */
+  std::unique_ptr<std::atomic<bool>[]> in_ring_;
+  /** Access buffers of the fast path. */
+  std::array<AccessBuffer, ACCESS_BUFFER_STRIPES> access_buffers_;
+  /** Counters of buffer hits, and of pins they waited for, by stripe. */
+  std::array<FastPathStats, ACCESS_BUFFER_STRIPES> fast_path_stats_;
+  /** Counters of misses and evictions, bumped under latch_ and read without it. */
+  std::atomic<uint64_t> num_misses_{0};
+  std::atomic<uint64_t> num_evictions_{0};
+  std::atomic<uint64_t> num_dirty_evictions_{0};
+  std::atomic<uint64_t> num_pin_waits_{0};
+  /** Nanoseconds each replacer_->Evict() took. */
+  Histogram evict_latency_;
+  /**
+   * This latch protects the page table, the replacer, the free list, the rings and the mapping of pages to frames.
+   * Buffer hits only take it to apply a batch of buffered accesses.
+   */
   std::mutex latch_;
+  /** Serializes Resize(), which takes latch_ repeatedly while it waits for pinned pages. */
+  std::mutex resize_latch_;
 
   /**
    * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
@@ -192,6 +478,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto AllocatePage() -> page_id_t;
 
+  /**
+   * @brief Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
+   * validate input data and ensure that a parallel BPM is routing requests to the correct BPI
+   * @param page_id
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
   /**
    * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.h
+//
+// Identification: src/include/buffer/clock_pro_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/frame_replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ClockProReplacer implements the CLOCK-Pro replacement policy (Jiang, Chen and Zhang, USENIX ATC 2005).
+ *
+ * Resident pages are hot or cold, and a new page starts out cold and in its test period. All of them, plus the
+ * non-resident cold pages still in their test period, sit on one clock with three hands:
+ * - hand_cold_ looks for a victim among resident cold pages. A referenced cold page in its test period is promoted
+ *   to hot, any other referenced cold page starts a new test period.
+ * - hand_hot_ demotes unreferenced hot pages to cold whenever there are more hot pages than frames minus the cold
+ *   target, and ends the test period of the cold pages it passes.
+ * - hand_test_ ends the test period of the oldest non-resident page once there are more of them than frames.
+ * A page fetched again during its test period grows the cold target, a test period that runs out shrinks it. A page
+ * touched only once by a scan stays cold and is evicted without disturbing the hot pages.
+ */
+class ClockProReplacer : public FrameReplacer {
+ public:
+  /**
+   * @brief Create a new ClockProReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ClockProReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ClockProReplacer);
+
+  ~ClockProReplacer() override = default;
+
+  /** @brief Run hand_cold_ until it evicts an evictable, unreferenced cold page. */
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  /**
+   * @brief A hit only sets the reference bit. A new frame becomes hot if its page is a non-resident page in its test
+   * period, and cold otherwise.
+   */
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void SetCapacity(size_t num_frames) override;
+
+ private:
+  struct ClockNode {
+    page_id_t page_id_;
+    /** INVALID_FRAME_ID for a non-resident page. */
+    frame_id_t frame_id_;
+    bool is_hot_{false};
+    bool is_referenced_{false};
+    bool in_test_{false};
+  };
+  using ClockIterator = std::list<ClockNode>::iterator;
+
+  struct FrameEntry {
+    bool is_tracked_{false};
+    bool is_evictable_{false};
+    ClockIterator node_;
+  };
+
+  /** @brief Move hand one node clockwise. Caller should acquire the latch. */
+  void Advance(ClockIterator *hand);
+
+  /** @brief Insert node at the head of the clock, right behind hand_hot_. Caller should acquire the latch. */
+  auto Insert(ClockNode node) -> ClockIterator;
+
+  /** @brief Erase node from the clock, moving the hands that point at it. Caller should acquire the latch. */
+  void Unlink(ClockIterator node);
+
+  /** @brief End the test period of a cold page, and shrink the cold target. Caller should acquire the latch. */
+  void EndTest(ClockIterator node);
+
+  /** @brief Run hand_hot_ until it demotes one hot page. Caller should acquire the latch. */
+  void RunHandHot();
+
+  /** @brief Run hand_test_ until it drops one non-resident page. Caller should acquire the latch. */
+  void RunHandTest();
+
+  /** @brief Demote hot pages until there are at most as many as the hot target. Caller should acquire the latch. */
+  void BalanceHot();
+
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  /** Target number of resident cold pages, adapted between 1 and replacer_size_. */
+  size_t cold_target_;
+  size_t num_hot_{0};
+  std::mutex latch_;
+
+  /** Indexed by frame id. */
+  std::vector<FrameEntry> entries_;
+  std::list<ClockNode> clock_;
+  ClockIterator hand_hot_;
+  ClockIterator hand_cold_;
+  ClockIterator hand_test_;
+  /** Non-resident cold pages in their test period. */
+  std::unordered_map<page_id_t, ClockIterator> non_resident_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is the data area of the frames of a buffer pool, allocated as one mapping. Frames are a multiple of
+ * BUSTUB_PAGE_SIZE, and aligned to it, which is what a DiskManager opened with O_DIRECT needs. The whole pool is
+ * allocated up front.
+ *
+ * An arena of at least one huge page is mapped with explicit huge pages if the system has some reserved, and is
+ * otherwise advised to the kernel as a candidate for transparent huge pages.
+ *
+ * An arena can reserve address space for more frames than it starts with, so that a buffer pool can grow without
+ * moving the frames it has. The reservation is not backed by memory until the frames are used, and is never mapped
+ * with explicit huge pages, which the kernel would have to back up front.
+ */
+class FrameArena {
+ public:
+  /** The huge page size the arena is rounded up to. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * Map the data area of num_frames frames.
+   * @param num_frames the number of frames
+   * @param frame_size the size of a frame, a multiple of BUSTUB_PAGE_SIZE
+   * @param max_frames the number of frames to reserve address space for, if more than num_frames
+   */
+  explicit FrameArena(size_t num_frames, size_t frame_size = BUSTUB_PAGE_SIZE, size_t max_frames = 0);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** Unmap the data area. */
+  ~FrameArena();
+
+  /** @return the frame_size bytes of data of a frame */
+  auto GetFrameData(frame_id_t frame_id) -> char * { return data_ + static_cast<size_t>(frame_id) * frame_size_; }
+
+  /** Give the memory of frames no longer in use back to the kernel. They read as zeros once used again. */
+  void Release(frame_id_t first_frame_id, size_t num_frames);
+
+  /** @return the size of the mapping in bytes */
+  auto GetSize() const -> size_t { return size_; }
+
+  /** @return true if the arena is backed by explicit huge pages */
+  auto UsesHugePages() const -> bool { return huge_pages_; }
+
+ private:
+  char *data_;
+  size_t frame_size_;
+  size_t size_;
+  bool huge_pages_{false};
+};
+
+}  // namespace bustub
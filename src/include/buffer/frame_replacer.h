@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_replacer.h
+//
+// Identification: src/include/buffer/frame_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** Replacement policies a BufferPoolManagerInstance can be constructed with. */
+enum class ReplacerPolicy { LRU_K, TWO_Q, ARC, CLOCK_PRO };
+
+/**
+ * FrameReplacer is the interface the buffer pool manager evicts frames through. Frames are tracked from their first
+ * RecordAccess() until they are evicted or removed, and only evictable frames may be chosen as victims.
+ */
+class FrameReplacer {
+ public:
+  FrameReplacer() = default;
+  virtual ~FrameReplacer() = default;
+
+  /**
+   * Find the frame to evict according to the replacement policy, and stop tracking it.
+   * @param[out] frame_id id of frame that is evicted
+   * @return true if a frame is evicted successfully, false if no frames can be evicted
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record that the page page_id held by frame frame_id is accessed. A frame that is not tracked yet starts out
+   * non-evictable. Policies that remember evicted pages use page_id to recognize a page that comes back.
+   * @param frame_id id of frame that received a new access
+   * @param page_id id of the page the frame holds
+   */
+  virtual void RecordAccess(frame_id_t frame_id, page_id_t page_id) = 0;
+
+  /**
+   * Toggle whether a tracked frame is evictable. Untracked frames are ignored.
+   * @param frame_id id of frame whose 'evictable' status will be modified
+   * @param set_evictable whether the given frame is evictable or not
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+  /**
+   * Stop tracking an evictable frame along with its access history, because its page was deleted. Untracked and
+   * non-evictable frames are ignored.
+   * @param frame_id id of frame to be removed
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
+  /** @return the number of evictable frames */
+  virtual auto Size() -> size_t = 0;
+
+  /**
+   * Change the number of frames the replacer is required to store, along with the targets of the policy derived
+   * from it. When shrinking, the frames at or past num_frames must no longer be tracked.
+   * @param num_frames the new number of frames
+   */
+  virtual void SetCapacity(size_t num_frames) = 0;
+
+  /**
+   * The history a warm-up snapshot records of a tracked frame. Replaying the timestamps of every frame through
+   * RecordAccess(), in timestamp order, rebuilds the eviction order the policy had.
+   * @param frame_id id of a tracked frame
+   * @return the logical timestamps of the last accesses of the frame, oldest first, empty if the policy keeps none
+   */
+  virtual auto GetAccessHistory(__attribute__((unused)) frame_id_t frame_id) -> std::vector<size_t> { return {}; }
+};
+
+/**
+ * GhostList remembers the ids of recently evicted pages in FIFO order, so that scan-resistant policies can recognize a
+ * page that is fetched again soon after its eviction. The owner bounds its length through PopBack().
+ */
+class GhostList {
+ public:
+  /** Remember page_id as the most recently evicted page. */
+  void PushFront(page_id_t page_id) {
+    Erase(page_id);
+    pages_.push_front(page_id);
+    index_[page_id] = pages_.begin();
+  }
+
+  /** @return true if page_id was remembered, it is forgotten either way */
+  auto Erase(page_id_t page_id) -> bool {
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    pages_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  /** Forget the least recently evicted page. */
+  void PopBack() {
+    index_.erase(pages_.back());
+    pages_.pop_back();
+  }
+
+  auto Size() const -> size_t { return pages_.size(); }
+  auto Empty() const -> bool { return pages_.empty(); }
+
+ private:
+  std::list<page_id_t> pages_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+};
+
+}  // namespace bustub
@@ -13,11 +13,10 @@
 #pragma once
 
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <vector>
 
+#include "buffer/frame_replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
@@ -33,8 +32,13 @@ namespace bustub {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Every frame keeps a ring of its last k access timestamps in a flat, frame-indexed array, so the oldest entry of the
+ * ring is the timestamp of the kth previous access (or of the first access, for frames with less than k). Evictable
+ * frames sit in an intrusive binary min-heap ordered by that timestamp, with +inf frames ahead of all others. All
+ * operations are O(log n) and nothing is allocated after construction.
  */
-class LRUKReplacer {
+class LRUKReplacer : public FrameReplacer {
  public:
   /**
    *
@@ -52,7 +56,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -70,13 +74,14 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
    *
    * @brief Record the event that the given frame id is accessed at current timestamp.
-   * Create a new entry for access history if frame id has not been seen before.
+   * Create a new entry for access history if frame id has not been seen before. A new entry
+   * is non-evictable until SetEvictable() says otherwise.
    *
    * If frame id is invalid (ie. larger than replacer_size_), throw an exception. You can
    * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
@@ -85,6 +90,9 @@ class LRUKReplacer {
    */
   void RecordAccess(frame_id_t frame_id);
 
+  /** @brief Same as RecordAccess(frame_id), LRU-K forgets evicted frames so the page id is not needed. */
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override { RecordAccess(frame_id); }
+
   /**
    * TODO(P1): Add implementation
    *
@@ -102,7 +110,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -121,7 +129,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -130,38 +138,52 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
+
+  void SetCapacity(size_t num_frames) override;
+
+  /** @brief Return the last k access timestamps of a frame, the same as its ring, oldest first. */
+  auto GetAccessHistory(frame_id_t frame_id) -> std::vector<size_t> override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] size_t current_timestamp_{0};
+  static constexpr size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+
+  /** Bookkeeping of one frame, the access history itself lives in history_. */
+  struct FrameEntry {
+    /** Number of recorded accesses, saturates at k. */
+    size_t access_count_{0};
+    /** Offset of the oldest timestamp in this frame's ring. */
+    size_t ring_head_{0};
+    /** Position in heap_, NOT_IN_HEAP unless the frame is evictable. */
+    size_t heap_index_{NOT_IN_HEAP};
+    bool is_tracked_{false};
+    bool is_evictable_{false};
+  };
+
+  /** @return the timestamp of the kth previous access of frame_id, or of its first access if it has less than k */
+  auto OldestAccess(frame_id_t frame_id) const -> size_t;
+
+  /** @return true if frame lhs has a larger backward k-distance than frame rhs, i.e. should be evicted first */
+  auto EvictsBefore(frame_id_t lhs, frame_id_t rhs) const -> bool;
+
+  void HeapPush(frame_id_t frame_id);
+  void HeapErase(frame_id_t frame_id);
+  void HeapSiftUp(size_t index);
+  void HeapSiftDown(size_t index);
+  void HeapPlace(size_t index, frame_id_t frame_id);
+
+  size_t current_timestamp_{0};
   size_t curr_size_{0};
   size_t replacer_size_;
   size_t k_;
   std::mutex latch_;
 
-  // Need a way to have evictable status, its curr pos in the record table or cache queue
-  // and also its access history
-  struct FrameEntry {
-    bool is_evictable_{true};
-    size_t access_count{0};
-
-    // Adding, removing and moving the elements within the list or across several lists does not invalidate the
-    // iterators or references.
-    //  An iterator is invalidated only when the corresponding element is deleted.
-    std::list<frame_id_t>::iterator position_;
-  };
-
-  /* For both the history queue and the cache listqueue we implement using std::list
-   * because it is easy to perform secondary sorting, and then use hashmap to perform o(1) search for entries
-   */
-  // queue with frames with less than k access (+inf)
-  std::list<frame_id_t> history_list_;
-  // LRU cache queue ordered by access time (frames that already made k_ access) (its head has the most recent accessed
-  // frame (reached k_)) (its tail has the least ....)
-  std::list<frame_id_t> cache_list_;
-  std::unordered_map<frame_id_t, FrameEntry> set_entries_;
+  /** Indexed by frame id. */
+  std::vector<FrameEntry> entries_;
+  /** Ring of the last k access timestamps of frame f, at [f * k_, (f + 1) * k_). */
+  std::vector<size_t> history_;
+  /** Min-heap of the evictable frames, the next victim is at the top. */
+  std::vector<frame_id_t> heap_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the page ids resident in a buffer pool to their frames. It has a fixed capacity of at least twice
+ * the number of frames, so it never grows and never fills up.
+ *
+ * It is an open-addressing table, probed linearly over buckets of one cache line: a version word and seven slots,
+ * each slot a page id and a frame id packed into one 64-bit word. At most half full, a lookup almost always stays in
+ * its home bucket, which is one cache line and no pointer to chase.
+ *
+ * Find() takes no lock and can run concurrently with anything. Insert() and Remove() must be serialized by the caller,
+ * as the buffer pool latch does. An insert is a single atomic store. A remove closes its gap by shifting later entries
+ * of the probe sequence back, so there are no tombstones. The versions of the buckets it rewrites are odd while it
+ * does. Find() retries if a bucket it read was being rewritten or has changed since, like a sequence lock reader.
+ */
+class PageTable {
+ public:
+  /**
+   * @param num_frames the number of frames of the buffer pool, which bounds the number of entries
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  ~PageTable() = default;
+
+  /**
+   * Find the frame of a page. Safe to call without any latch; the result may be stale as soon as it is returned.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame of the page, if found
+   * @param[out] num_probes if not nullptr, the number of slots the lookup read
+   * @return true if the page is in the table
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id, size_t *num_probes = nullptr) const -> bool;
+
+  /**
+   * Add a page that is not in the table. Calls to Insert() and Remove() must be serialized by the caller.
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove a page. Calls to Insert() and Remove() must be serialized by the caller.
+   * @return false if the page was not in the table
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+  /** @return the number of slots */
+  auto GetCapacity() const -> size_t { return num_buckets_ * SLOTS_PER_BUCKET; }
+
+ private:
+  static constexpr size_t SLOTS_PER_BUCKET = 7;
+  /** An empty slot, packing INVALID_PAGE_ID and INVALID_FRAME_ID. */
+  static constexpr uint64_t EMPTY = ~static_cast<uint64_t>(0);
+
+  struct alignas(64) Bucket {
+    /** Odd while Remove() is rewriting the bucket, incremented twice by every rewrite. */
+    std::atomic<uint64_t> version_{0};
+    std::atomic<uint64_t> slots_[SLOTS_PER_BUCKET];
+  };
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32 | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t entry) -> page_id_t { return static_cast<page_id_t>(entry >> 32); }
+  static auto FrameOf(uint64_t entry) -> frame_id_t { return static_cast<frame_id_t>(entry & 0xFFFFFFFF); }
+
+  /** @return the first slot of the bucket page_id hashes to */
+  auto HomeSlot(page_id_t page_id) const -> size_t;
+
+  auto SlotAt(size_t slot) const -> std::atomic<uint64_t> & {
+    return buckets_[slot / SLOTS_PER_BUCKET].slots_[slot % SLOTS_PER_BUCKET];
+  }
+
+  auto Next(size_t slot) const -> size_t { return slot + 1 == GetCapacity() ? 0 : slot + 1; }
+
+  /** @return how far slot is from from, going forward around the table */
+  auto Distance(size_t from, size_t slot) const -> size_t {
+    return slot >= from ? slot - from : slot + GetCapacity() - from;
+  }
+
+  size_t num_buckets_;
+  std::unique_ptr<Bucket[]> buckets_;
+};
+
+}  // namespace bustub
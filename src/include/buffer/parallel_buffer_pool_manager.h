@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager splits the buffer pool into several independently latched BufferPoolManagerInstances.
+ * A page id is owned by exactly one instance (page_id % num_instances), so threads touching different pages rarely
+ * contend on the same latch, free list, page table or replacer.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of every instance
+   * @param log_manager the log manager
+   * @param replacer_policy the replacement policy of every instance
+   * @param max_pool_size the number of frames Resize() may grow each instance to, 0 for pool_size
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K, size_t max_pool_size = 0);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, summed over all instances */
+  auto GetPoolSize() -> size_t override;
+
+  /**
+   * Split pool_size evenly over the instances and resize each of them. If one of them cannot be resized, the ones
+   * resized before it are given their old size back. That rollback can fail too (when pages pinned in the frames it
+   * would drop aren't unpinned in time); that instance then keeps its new size, a warning is logged and the pool is
+   * left partially resized.
+   * @param pool_size the new number of frames summed over all instances, at least one per instance
+   * @return false if the buffer pool could not be resized
+   */
+  auto Resize(size_t pool_size) -> bool override;
+
+  /** @return the counters of every instance, added up */
+  auto GetStats() -> BufferPoolStats override;
+
+  /** @return the resident pages of every instance */
+  auto GetWarmupEntries() -> std::vector<WarmupEntry> override;
+
+  /** Hand each instance the pages it owns, and let the instances warm up concurrently. */
+  auto WarmUp(const std::vector<WarmupEntry> &entries) -> size_t override;
+
+  /** @return the number of instances the pool is split into */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /** @brief Split num_clean_frames evenly over the instances, and let each one clean its share. */
+  auto WriteBackDirtyPages(size_t num_clean_frames) -> size_t override;
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager *;
+
+  /**
+   * Fetch the requested page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be fetched
+   * @return the requested page, nullptr if it could not be fetched
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Fetch the requested page from the responsible BufferPoolManagerInstance on behalf of an access pattern.
+   * @param page_id id of page to be fetched
+   * @param hint what the page is fetched for
+   * @return the requested page, nullptr if it could not be fetched
+   */
+  auto FetchPgImp(page_id_t page_id, AccessHint hint) -> Page * override;
+
+  /**
+   * Unpin the target page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Creates a new page. Instances are probed round robin, starting from a different instance on every call so that
+   * new pages are spread over all shards. Only if every instance is full is nullptr returned.
+   * @param[out] page_id id of create page
+   * @return nullptr if new page could not be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * Deletes a page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Flushes all the pages in every instance to disk.
+   */
+  void FlushAllPgsImp() override;
+
+ private:
+  /** The shards; instance i owns every page id with page_id % num_instances == i. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** Instance that the next NewPgImp() call starts probing from. */
+  std::atomic<size_t> start_index_{0};
+};
+
+}  // namespace bustub
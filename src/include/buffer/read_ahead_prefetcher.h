@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_prefetcher.h
+//
+// Identification: src/include/buffer/read_ahead_prefetcher.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ReadAheadPrefetcher loads the pages of a page chain (the next_page_id links of a table heap or of the B+ tree
+ * leaves) into the buffer pool on a background thread, a few pages ahead of the scan walking the chain, so that the
+ * scan's own fetches hit and its CPU work overlaps the reads.
+ *
+ * The prefetcher only knows the chain through the NextPageFn of each request, and remembers the links of the pages it
+ * loaded, so a page is read once however many requests cover it. Read-ahead is best effort: requests are dropped when
+ * the queue is full, and a page the pool has no free frame for ends the request.
+ */
+class ReadAheadPrefetcher {
+ public:
+  /** Reads the link to the next page of the chain out of a read latched page. */
+  using NextPageFn = page_id_t (*)(Page *page);
+
+  /** Counters of a prefetcher, see GetStats(). */
+  struct Stats {
+    /** Pages the background thread loaded or found resident. */
+    size_t issued_{0};
+    /** Pages a scan reached after the background thread got to them. */
+    size_t hits_{0};
+    /** Pages a scan reached before the background thread did, which the scan had to read itself. */
+    size_t misses_{0};
+    /** Requests dropped because the queue was full. */
+    size_t dropped_{0};
+  };
+
+  /**
+   * Create a new ReadAheadPrefetcher and start its background thread.
+   * @param buffer_pool_manager the buffer pool to load pages into
+   * @param depth how many pages ahead of a scan to load
+   */
+  explicit ReadAheadPrefetcher(BufferPoolManager *buffer_pool_manager, size_t depth = READ_AHEAD_DEPTH);
+
+  /** Stop and join the background thread. Pending requests are dropped. */
+  ~ReadAheadPrefetcher();
+
+  /**
+   * Tell the prefetcher that a scan has reached page_id, and queue a read-ahead of the pages that follow it.
+   * @param page_id the page the scan is on
+   * @param next_page_id the page after it, INVALID_PAGE_ID at the end of the chain
+   * @param next_page_fn reads the next link out of a page of this chain
+   * @param hint what the scan fetches its pages for, the read-ahead fetches them the same way
+   */
+  void ScanAt(page_id_t page_id, page_id_t next_page_id, NextPageFn next_page_fn, AccessHint hint);
+
+  /** Block until every queued request has been served. */
+  void WaitIdle();
+
+  /** @return a snapshot of the counters */
+  auto GetStats() const -> Stats;
+
+  /** @return how many pages ahead of a scan are loaded */
+  auto GetDepth() const -> size_t { return depth_; }
+
+ private:
+  struct Request {
+    page_id_t page_id_;
+    NextPageFn next_page_fn_;
+    AccessHint hint_;
+  };
+
+  /** Serve requests until the prefetcher is destroyed. */
+  void Run();
+
+  /** Load up to depth_ pages of the chain starting at request.page_id_. */
+  void Serve(const Request &request);
+
+  /** Requests that may wait in the queue. */
+  static constexpr size_t MAX_QUEUED_REQUESTS = 64;
+  /** Links remembered before the oldest are forgotten; a scan normally consumes them long before. */
+  static constexpr size_t MAX_LOADED_PAGES = 4096;
+
+  BufferPoolManager *buffer_pool_manager_;
+  const size_t depth_;
+
+  /** Protects everything below but the counters. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::condition_variable idle_cv_;
+  std::deque<Request> queue_;
+  bool busy_{false};
+  bool stop_{false};
+  /** Pages loaded ahead of a scan that no scan has reached yet, with their next link. */
+  std::unordered_map<page_id_t, page_id_t> loaded_;
+
+  std::atomic<size_t> issued_{0};
+  std::atomic<size_t> hits_{0};
+  std::atomic<size_t> misses_{0};
+  std::atomic<size_t> dropped_{0};
+
+  std::thread worker_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.h
+//
+// Identification: src/include/buffer/two_q_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/frame_replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQReplacer implements the full 2Q replacement policy (Johnson and Shasha, VLDB 1994).
+ *
+ * A page seen for the first time enters A1in, a FIFO queue of about a quarter of the frames. Pages evicted from A1in
+ * are remembered in the ghost queue A1out, and only a page that is fetched again while it is in A1out is admitted to
+ * Am, the LRU queue of hot pages. A sequential scan therefore only ever cycles through A1in and cannot push hot pages
+ * out of Am.
+ */
+class TwoQReplacer : public FrameReplacer {
+ public:
+  /**
+   * @brief Create a new TwoQReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQReplacer);
+
+  ~TwoQReplacer() override = default;
+
+  /**
+   * @brief Evict the oldest evictable frame of A1in if A1in is over its target size, else the least recently used
+   * evictable frame of Am. Falls back to the other queue if the preferred one has no evictable frame.
+   */
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  /**
+   * @brief A hit in Am moves the frame to the front of Am, a hit in A1in is ignored as a correlated reference. A new
+   * frame enters Am if its page is in A1out, and A1in otherwise.
+   */
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void SetCapacity(size_t num_frames) override;
+
+ private:
+  enum class QueueType { NONE, A1IN, AM };
+
+  struct FrameEntry {
+    QueueType queue_{QueueType::NONE};
+    bool is_evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    std::list<frame_id_t>::iterator position_;
+  };
+
+  /** @brief Evict the evictable frame closest to the back of queue. Caller should acquire the latch. */
+  auto EvictFrom(std::list<frame_id_t> *queue, frame_id_t *frame_id) -> bool;
+
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  /** Size of A1in above which its frames are evicted first (Kin). */
+  size_t a1in_target_;
+  /** Number of evicted pages A1out remembers (Kout). */
+  size_t a1out_capacity_;
+  std::mutex latch_;
+
+  /** Indexed by frame id. */
+  std::vector<FrameEntry> entries_;
+  /** FIFO of frames referenced once, newest at the front. */
+  std::list<frame_id_t> a1in_;
+  /** LRU of hot frames, most recently used at the front. */
+  std::list<frame_id_t> am_;
+  /** Pages recently evicted from A1in. */
+  GhostList a1out_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// warmup_snapshot.h
+//
+// Identification: src/include/buffer/warmup_snapshot.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** A page resident in a buffer pool, as a warm-up snapshot records it. */
+struct WarmupEntry {
+  page_id_t page_id_;
+  /** Logical timestamps of the last accesses of the page, oldest first, empty if the replacer keeps none. */
+  std::vector<size_t> history_;
+};
+
+/**
+ * WarmupSnapshot reads and writes the list of pages resident in a buffer pool, so that after a restart the buffer
+ * pool can load them before it is used instead of missing on each of them, see BufferPoolManager::WarmUp().
+ *
+ * The file holds a header (a magic number, whose last character is the format version, and the number of entries)
+ * followed by each entry's page id, history length and history. Only page ids are recorded, the pages themselves are
+ * read from the database file again. A snapshot is written to a temporary file that is renamed over the old one, so a
+ * crash never leaves a torn snapshot.
+ */
+class WarmupSnapshot {
+ public:
+  /**
+   * Write a snapshot.
+   * @param file_name the snapshot file, replaced if it exists
+   * @param entries the resident pages
+   * @return false if the file could not be written
+   */
+  static auto Save(const std::string &file_name, const std::vector<WarmupEntry> &entries) -> bool;
+
+  /**
+   * Read a snapshot.
+   * @param file_name the snapshot file
+   * @param[out] entries the resident pages
+   * @return false if there is no snapshot or it is not a valid one, entries is empty then
+   */
+  static auto Load(const std::string &file_name, std::vector<WarmupEntry> *entries) -> bool;
+
+ private:
+  static constexpr uint64_t MAGIC = 0x4255535457524D31;  // "BUSTWRM1", the last character is the version
+  /** Longer histories than any replacer keeps mean the file is corrupt. */
+  static constexpr uint32_t MAX_HISTORY_SIZE = 1024;
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -45,9 +46,15 @@ struct TableInfo {
    * @param name The table name
    * @param table An owning pointer to the table heap
    * @param oid The unique OID for the table
+   * @param page_size The page size of the table heap
    */
-  TableInfo(Schema schema, std::string name, std::unique_ptr<TableHeap> &&table, table_oid_t oid)
-      : schema_{std::move(schema)}, name_{std::move(name)}, table_{std::move(table)}, oid_{oid} {}
+  TableInfo(Schema schema, std::string name, std::unique_ptr<TableHeap> &&table, table_oid_t oid,
+            size_t page_size = BUSTUB_PAGE_SIZE)
+      : schema_{std::move(schema)},
+        name_{std::move(name)},
+        table_{std::move(table)},
+        oid_{oid},
+        page_size_{page_size} {}
   /** The table schema */
   Schema schema_;
   /** The table name */
@@ -56,6 +63,8 @@ struct TableInfo {
   std::unique_ptr<TableHeap> table_;
   /** The table OID */
   const table_oid_t oid_;
+  /** The page size of the table heap */
+  const size_t page_size_;
 };
 
 /**
@@ -70,15 +79,17 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param page_size The page size of the index
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, size_t page_size = BUSTUB_PAGE_SIZE)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        page_size_{page_size} {}
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -91,6 +102,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The page size of the index */
+  const size_t page_size_;
 };
 
 /**
@@ -121,13 +134,18 @@ class Catalog {
    * @param table_name The name of the new table, note that all tables beginning with `__` are reserved for the system.
    * @param schema The schema of the new table
    * @param create_table_heap whether to create a table heap for the new table
+   * @param page_size The page size of the table heap, which needs a buffer pool of that page size
    * @return A (non-owning) pointer to the metadata for the table
    */
-  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true)
-      -> TableInfo * {
+  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true,
+                   size_t page_size = BUSTUB_PAGE_SIZE) -> TableInfo * {
     if (table_names_.count(table_name) != 0) {
       return NULL_TABLE_INFO;
     }
+    auto *bpm = GetBufferPool(page_size);
+    if (create_table_heap && bpm == nullptr) {
+      return NULL_TABLE_INFO;
+    }
 
     // Construct the table heap
     std::unique_ptr<TableHeap> table = nullptr;
@@ -136,14 +154,14 @@ class Catalog {
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
     if (create_table_heap) {
-      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+      table = std::make_unique<TableHeap>(bpm, lock_manager_, log_manager_, txn);
     }
 
     // Fetch the table OID for the new table
     const auto table_oid = next_table_oid_.fetch_add(1);
 
     // Construct the table information
-    auto meta = std::make_unique<TableInfo>(schema, table_name, std::move(table), table_oid);
+    auto meta = std::make_unique<TableInfo>(schema, table_name, std::move(table), table_oid, page_size);
     auto *tmp = meta.get();
 
     // Update the internal tracking mechanisms
@@ -196,16 +214,21 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param page_size The page size of the index, which needs a buffer pool of that page size
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, size_t page_size = BUSTUB_PAGE_SIZE) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
     }
+    auto *bpm = GetBufferPool(page_size);
+    if (bpm == nullptr) {
+      return NULL_INDEX_INFO;
+    }
 
     // If the table exists, an entry for the table should already be present in index_names_
     BUSTUB_ASSERT((index_names_.find(table_name) != index_names_.end()), "Broken Invariant");
@@ -226,12 +249,12 @@ class Catalog {
     // just the key, value, and comparator types
 
     // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm);
 
     // Populate the index with all tuples in table heap
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+    for (auto tuple = heap->Begin(txn, AccessHint::SEQUENTIAL_SCAN); tuple != heap->End(); ++tuple) {
       index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
     }
 
@@ -239,8 +262,8 @@ class Catalog {
     const auto index_oid = next_index_oid_.fetch_add(1);
 
     // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, page_size);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -333,6 +356,23 @@ class Catalog {
     return indexes;
   }
 
+  /**
+   * Let tables and indexes of another page size be created, in a buffer pool of that page size. The buffer pool of
+   * BUSTUB_PAGE_SIZE pages is the one the catalog was constructed with.
+   * @param bpm The buffer pool, not owned by the catalog. Its page 0 must be reserved as the header page of its
+   * indexes.
+   */
+  void AddBufferPool(BufferPoolManager *bpm) { sized_bpms_[bpm->GetPageSize()] = bpm; }
+
+  /** @return The buffer pool of page_size pages, nullptr if there is none */
+  auto GetBufferPool(size_t page_size) const -> BufferPoolManager * {
+    if (page_size == BUSTUB_PAGE_SIZE) {
+      return bpm_;
+    }
+    auto bpm = sized_bpms_.find(page_size);
+    return bpm == sized_bpms_.end() ? nullptr : bpm->second;
+  }
+
   auto GetTableNames() -> std::vector<std::string> {
     std::vector<std::string> result;
     for (const auto &x : table_names_) {
@@ -345,6 +385,8 @@ class Catalog {
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
+  /** Map page size -> buffer pool of that page size, other than BUSTUB_PAGE_SIZE. */
+  std::map<size_t, BufferPoolManager *> sized_bpms_;
 
   /**
    * Map table identifier -> table metadata.
@@ -34,6 +34,9 @@ class Transaction;
 class ExecutorContext;
 class DiskManager;
 class BufferPoolManager;
+class ReadAheadPrefetcher;
+class BackgroundWriter;
+class PageScrubber;
 class LockManager;
 class TransactionManager;
 class LogManager;
@@ -246,6 +249,14 @@ class BustubInstance {
 
   DiskManager *disk_manager_;
   BufferPoolManager *buffer_pool_manager_;
+  /** Disk managers of the buffer pools of larger pages, one file each. */
+  std::vector<DiskManager *> sized_disk_managers_;
+  /** Buffer pools of larger pages, for tables and indexes created with the page_size variable set. */
+  std::vector<BufferPoolManager *> sized_buffer_pool_managers_;
+  ReadAheadPrefetcher *prefetcher_{nullptr};
+  BackgroundWriter *background_writer_{nullptr};
+  /** Verifies the cold pages of the database file, nullptr if it is kept in memory. */
+  PageScrubber *page_scrubber_{nullptr};
   LockManager *lock_manager_;
   TransactionManager *txn_manager_;
   LogManager *log_manager_;
@@ -261,6 +272,9 @@ class BustubInstance {
     return "";
   }
 
+  /** @return the page size new tables and indexes get, from the page_size variable */
+  auto GetPageSizeVariable() -> size_t;
+
   auto IsForceStarterRule() -> bool {
     auto variable = StringUtil::Lower(GetSessionVariable("force_optimizer_starter_rule"));
     return variable == "1" || variable == "true" || variable == "yes";
@@ -269,8 +283,21 @@ class BustubInstance {
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
+  /** Show the counters of each buffer pool and of the disk manager under it. */
+  void CmdDisplayStats(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
+  /**
+   * Create the buffer pools of the page sizes other than BUSTUB_PAGE_SIZE and register them with the catalog.
+   * @param db_file_name the database file, whose name the files of the pools are derived from, empty to keep them in
+   * memory
+   */
+  void AddSizedBufferPools(const std::string &db_file_name);
+  /**
+   * Resize the main buffer pool, for `SET buffer_pool_size`.
+   * @param value the new number of frames, as given to SET
+   */
+  void ResizeBufferPool(const std::string &value);
   std::unordered_map<std::string, std::string> session_variables_;
 };
 
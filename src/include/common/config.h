@@ -27,15 +27,40 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The background writer cleans frames of the buffer pool every BACKGROUND_WRITER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds background_writer_interval;
+
+/** The background writer writes a warm-up snapshot of its buffer pool every WARMUP_SNAPSHOT_INTERVAL, if asked to. */
+extern std::chrono::milliseconds warmup_snapshot_interval;
+
+/**
+ * True if a BustubInstance checksums the pages of its database files and scrubs them, see PageChecksumMode. Verifying
+ * a page costs about 5% of a read that hits the page cache, so checksums are off by default.
+ */
+extern std::atomic<bool> enable_page_checksums;
+
+/** Shrinking a buffer pool gives up if the frames it drops still hold pinned pages after BUFFER_POOL_RESIZE_TIMEOUT. */
+extern std::chrono::milliseconds buffer_pool_resize_timeout;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
+static constexpr int INVALID_FRAME_ID = -1;                                          // invalid frame id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
 static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_MAX_PAGE_SIZE = 65536;  // largest page size of a table or an index, a multiple of the above
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
+static constexpr int BUFFER_POOL_INSTANCES = 4;                                      // shards of a parallel buffer pool
+static constexpr int BUFFER_POOL_MAX_SIZE = 65536;  // frames the buffer pool of a BustubInstance can grow to at runtime
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int SCAN_RING_SIZE = 16;   // frames a sequential scan or vacuum recycles in a buffer pool instance
+static constexpr int BULK_WRITE_RING_SIZE = 64;  // frames a bulk write recycles in a buffer pool instance
+static constexpr int READ_AHEAD_DEPTH = 4;       // pages a scan's read-ahead loads ahead of it
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;  // page reads and writes an async disk manager keeps in flight
+static constexpr int ASYNC_IO_THREADS = 4;       // threads of the async disk manager when io_uring is unavailable
+static constexpr int PAGE_SCRUB_RATE = 64;       // pages per second a page scrubber reads
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/crc32c.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * CRC-32C (Castagnoli), the checksum of iSCSI, ext4 and most storage engines. It is computed with the SSE4.2 crc32
+ * instruction on x86-64 CPUs that have it, with the CRC32 extension on ARMv8 builds that target it, and with a table
+ * otherwise.
+ */
+class Crc32c {
+ public:
+  /**
+   * @param data the bytes to checksum
+   * @param size the number of bytes
+   * @param crc the CRC of the bytes before data, to checksum a buffer in pieces
+   * @return the CRC of the bytes before data followed by data
+   */
+  static auto Compute(const char *data, size_t size, uint32_t crc = 0) -> uint32_t;
+
+  /**
+   * Checksum num_blocks adjacent blocks of block_size bytes each, as the sectors of a page. The blocks are independent,
+   * so their CRCs are computed interleaved, which keeps the CRC unit of the CPU busy where one CRC would wait for the
+   * latency of each instruction.
+   * @param data the blocks
+   * @param block_size the size of a block
+   * @param num_blocks the number of blocks
+   * @param[out] crcs the CRC of each block
+   */
+  static void ComputeBlocks(const char *data, size_t block_size, size_t num_blocks, uint32_t *crcs);
+
+  /** @return true if the CRCs are computed with CPU instructions rather than a table */
+  static auto UsesHardware() -> bool;
+};
+
+}  // namespace bustub
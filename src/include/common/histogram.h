@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// histogram.h
+//
+// Identification: src/include/common/histogram.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bustub {
+
+/**
+ * Histogram counts values, such as latencies in nanoseconds or probe lengths, in buckets of powers of two: bucket 0
+ * holds 0, and bucket i holds the values of bit width i, [2^(i-1), 2^i). Recording a value is two relaxed atomic
+ * increments and takes no lock, so a histogram can be shared by threads on a hot path. Reads are not a consistent
+ * snapshot of concurrent records, which is good enough for monitoring.
+ */
+class Histogram {
+ public:
+  /** One bucket for 0 and one for each bit width of a 64-bit value. */
+  static constexpr size_t NUM_BUCKETS = 65;
+
+  Histogram() = default;
+
+  /** Copy the counts of other as they are when read. */
+  Histogram(const Histogram &other) { Merge(other); }
+
+  auto operator=(const Histogram &other) -> Histogram & {
+    if (this != &other) {
+      Reset();
+      Merge(other);
+    }
+    return *this;
+  }
+
+  ~Histogram() = default;
+
+  /** Count one value. */
+  void Record(uint64_t value) {
+    buckets_[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /** Count the nanoseconds elapsed since start. */
+  void RecordSince(std::chrono::steady_clock::time_point start) {
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+  }
+
+  /** Add the counts of other to this histogram. */
+  void Merge(const Histogram &other);
+
+  /** Forget every value counted. */
+  void Reset();
+
+  /** @return the number of values counted */
+  auto GetCount() const -> uint64_t;
+
+  /** @return the sum of the values counted */
+  auto GetSum() const -> uint64_t { return sum_.load(std::memory_order_relaxed); }
+
+  /** @return the mean of the values counted, 0 if there are none */
+  auto GetMean() const -> double;
+
+  /**
+   * @param percentile between 0 and 100
+   * @return an upper bound of the given percentile of the values counted: the largest value of the bucket it falls in,
+   * 0 if there are none
+   */
+  auto GetPercentile(double percentile) const -> uint64_t;
+
+  /** @return the number of values counted in a bucket */
+  auto GetBucketCount(size_t bucket) const -> uint64_t { return buckets_[bucket].load(std::memory_order_relaxed); }
+
+  /** @return the bucket a value is counted in */
+  static auto BucketOf(uint64_t value) -> size_t {
+    return value == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(value));
+  }
+
+  /** @return the largest value a bucket holds */
+  static auto BucketUpperBound(size_t bucket) -> uint64_t {
+    return bucket >= 64 ? UINT64_MAX : (static_cast<uint64_t>(1) << bucket) - 1;
+  }
+
+  /** @return "count=... mean=... p50<=... p99<=... max<=..." */
+  auto ToString() const -> std::string;
+
+ private:
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_{};
+  std::atomic<uint64_t> sum_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4.h
+//
+// Identification: src/include/common/lz4.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * A compressor for the LZ4 block format, so blocks it writes can be read by the reference LZ4 library and the other way
+ * round. A block is a run of sequences, each a token (the lengths of the literals and of the match, 4 bits each), the
+ * literals, and a match: a 2-byte offset back into the output and the length to copy from there.
+ *
+ * The compressor is a greedy single-pass one with a hash table of 4-byte prefixes, like the default (fast) mode of LZ4:
+ * it finds fewer matches than an optimal parser but compresses hundreds of megabytes per second, and decompressing is
+ * mostly memcpy. Inputs are at most 64 KiB, a page, so every position fits in the 16-bit offset.
+ */
+class Lz4 {
+ public:
+  /** The largest input Compress() accepts. */
+  static constexpr size_t MAX_INPUT_SIZE = 65536;
+
+  /**
+   * @param src the bytes to compress
+   * @param size the number of bytes, at most MAX_INPUT_SIZE
+   * @param[out] dst the compressed block
+   * @param capacity the size of dst
+   * @return the size of the compressed block, 0 if it does not fit in capacity bytes
+   */
+  static auto Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t;
+
+  /**
+   * @param src a compressed block
+   * @param size the size of the compressed block
+   * @param[out] dst the decompressed bytes
+   * @param dst_size the size the block decompresses to
+   * @return false if src is not a valid block that decompresses to exactly dst_size bytes
+   */
+  static auto Decompress(const char *src, size_t size, char *dst, size_t dst_size) -> bool;
+};
+
+}  // namespace bustub
@@ -29,6 +29,12 @@ class ReaderWriterLatch {
    */
   void WLock() { mutex_.lock(); }
 
+  /**
+   * Acquire a write latch if no one holds the latch.
+   * @return true if the write latch was acquired
+   */
+  auto TryWLock() -> bool { return mutex_.try_lock(); }
+
   /**
    * Release a write latch.
    */
@@ -291,6 +291,21 @@ class LockManager {
    */
   auto LockRow(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const RID &rid) -> bool;
 
+  /**
+   * Acquire locks on several rows of a table in the given lock_mode, as LockRow() does for each.
+   *
+   * The transaction and its table lock are checked once, and the rows nobody else has requested a lock on, such as
+   * those the transaction just inserted, are granted under a single pass over the lock map rather than one lookup and
+   * wait each.
+   *
+   * @param txn the transaction requesting the locks
+   * @param lock_mode the lock mode for the requested locks
+   * @param oid the table_oid_t of the table the rows belong to
+   * @param rids the RIDs of the rows to be locked
+   * @return true if every lock is granted, false otherwise
+   */
+  auto LockRows(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const std::vector<RID> &rids) -> bool;
+
   /**
    * Release the lock held on a row by the transaction.
    *
@@ -351,8 +366,25 @@ class LockManager {
   /** Coordination */
   std::mutex table_lock_map_latch_;
 
-  /** Structure that holds lock requests for a given RID */
-  std::unordered_map<RID, std::shared_ptr<LockRequestQueue>> row_lock_map_;
+  /**
+   * Hash of a row, which is identified by its table as well as its RID: tables in buffer pools of different page
+   * sizes number their pages independently.
+   */
+  struct RowHash {
+    auto operator()(const std::pair<table_oid_t, RID> &row) const -> size_t {
+      return std::hash<RID>{}(row.second) ^ (static_cast<size_t>(row.first) * 0x9E3779B97F4A7C15ULL);
+    }
+  };
+
+  /**
+   * Check that a transaction may lock a row of a table in lock_mode: it is still running, the mode is one for rows,
+   * its isolation level and state allow it, and it holds a lock on the table that covers it.
+   * @return false if the transaction has already finished, true if it may lock the row
+   */
+  auto CheckRowLock(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool;
+
+  /** Structure that holds lock requests for a given row of a table */
+  std::unordered_map<std::pair<table_oid_t, RID>, std::shared_ptr<LockRequestQueue>, RowHash> row_lock_map_;
   /** Coordination */
   std::mutex row_lock_map_latch_;
 
@@ -17,18 +17,33 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "common/macros.h"
+#include "common/rwlatch.h"
 #include "container/hash/hash_table.h"
 
 namespace bustub {
 
 /**
  * ExtendibleHashTable implements a hash table using the extendible hashing algorithm.
+ *
+ * A bucket keeps its entries in flat arrays, with a one-byte fingerprint of each key's hash that is compared 16 at a
+ * time with SSE2 before any key is. Writers latch only the bucket they change, and splits are serialized among
+ * themselves. Lookups take no latch when keys and values are trivially copyable: they read a bucket optimistically
+ * and retry if its version shows that it was written meanwhile. Otherwise they hold the bucket's read latch.
+ *
+ * The directory is replaced, not resized, when it doubles, so readers still on the old one are not blocked. Buckets
+ * know which hashes they cover, and a reader that reached a bucket through a stale directory entry starts over.
+ * Replaced directories and buckets are only freed with the table, so nobody ever reads freed memory. Their size is
+ * bounded by that of the live ones, since the table never shrinks.
+ *
  * @tparam K key type
  * @tparam V value type
  */
@@ -36,14 +51,15 @@ template <typename K, typename V>
 class ExtendibleHashTable : public HashTable<K, V> {
  public:
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Create a new ExtendibleHashTable.
    * @param bucket_size: fixed size for each bucket
    */
   explicit ExtendibleHashTable(size_t bucket_size);
 
+  DISALLOW_COPY_AND_MOVE(ExtendibleHashTable);
+
+  ~ExtendibleHashTable() override = default;
+
   /**
    * @brief Get the global depth of the directory.
    * @return The global depth of the directory.
@@ -72,13 +88,7 @@ class ExtendibleHashTable : public HashTable<K, V> {
   auto GetLocalHighBit(int dir_index) -> int;
 
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Find the value associated with the given key.
-   *
-   * Use IndexOf(key) to find the directory index the key hashes to.
-   *
    * @param key The key to be searched.
    * @param[out] value The value associated with the key.
    * @return True if the key is found, false otherwise.
@@ -86,9 +96,6 @@ class ExtendibleHashTable : public HashTable<K, V> {
   auto Find(const K &key, V &value) -> bool override;
 
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Insert the given key-value pair into the hash table.
    * If a key already exists, the value should be updated.
    * If the bucket is full and can't be inserted, do the following steps before retrying:
@@ -103,9 +110,6 @@ class ExtendibleHashTable : public HashTable<K, V> {
   void Insert(const K &key, const V &value) override;
 
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Given the key, remove the corresponding key-value pair in the hash table.
    * Shrink & Combination is not required for this project
    * @param key The key to be deleted.
@@ -114,38 +118,37 @@ class ExtendibleHashTable : public HashTable<K, V> {
   auto Remove(const K &key) -> bool override;
 
   /**
-   * Bucket class for each hash table bucket that the directory points to.
+   * Bucket class for each hash table bucket that the directory points to. It covers the hashes whose low depth bits
+   * are its prefix. Its methods expect the caller to hold its latch, or to validate an optimistic read with its
+   * version.
    */
   class Bucket {
    public:
-    explicit Bucket(size_t size, int depth = 0);
+    explicit Bucket(size_t size, int depth = 0, size_t prefix = 0);
 
     /** @brief Check if a bucket is full. */
-    inline auto IsFull() const -> bool { return list_.size() == size_; }
+    inline auto IsFull() const -> bool { return num_items_ == size_; }
 
     /** @brief Get the local depth of the bucket. */
-    inline auto GetDepth() const -> int { return depth_; }
+    inline auto GetDepth() const -> int { return depth_.load(std::memory_order_acquire); }
 
     /** @brief Increment the local depth of a bucket. */
-    inline void IncrementDepth() { depth_++; }
+    inline void IncrementDepth() { depth_.store(GetDepth() + 1, std::memory_order_release); }
 
-    inline auto GetItems() -> std::list<std::pair<K, V>> & { return list_; }
+    /** @brief Check whether keys with the given hash belong in this bucket, which a split may have changed. */
+    inline auto Covers(size_t hash) const -> bool {
+      return (hash & ((static_cast<size_t>(1) << GetDepth()) - 1)) == prefix_;
+    }
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Find the value associated with the given key in the bucket.
      * @param key The key to be searched.
      * @param[out] value The value associated with the key.
      * @return True if the key is found, false otherwise.
      */
-    auto Find(const K &key, V &value) -> bool;
+    auto Find(const K &key, V &value) const -> bool;
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Given the key, remove the corresponding key-value pair in the bucket.
      * @param key The key to be deleted.
      * @return True if the key exists, false otherwise.
@@ -153,9 +156,6 @@ class ExtendibleHashTable : public HashTable<K, V> {
     auto Remove(const K &key) -> bool;
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Insert the given key-value pair into the bucket.
      *      1. If a key already exists, the value should be updated.
      *      2. If the bucket is full, do nothing and return false.
@@ -166,33 +166,61 @@ class ExtendibleHashTable : public HashTable<K, V> {
     auto Insert(const K &key, const V &value) -> bool;
 
    private:
-    // TODO(student): You may add additional private members and helper functions
+    friend class ExtendibleHashTable;
+
+    /** @return the slot holding key, or size_ if there is none */
+    auto SlotOf(const K &key) const -> size_t;
+
+    /** @return the first slot whose fingerprint is fingerprint, or size_ if there is none */
+    auto FirstSlotWith(uint8_t fingerprint) const -> size_t;
+
+    /** Make the version odd, so that optimistic readers of the bucket retry, before writing it. */
+    void BeginWrite();
+
+    /** Make the version even again after writing the bucket. */
+    void EndWrite();
+
     size_t size_;
-    int depth_;
-    std::list<std::pair<K, V>> list_;
+    std::atomic<int> depth_;
+    const size_t prefix_;
+    size_t num_items_{0};
+    /** Odd while the bucket is being written, incremented twice by every write. */
+    std::atomic<uint64_t> version_{0};
+    /** Taken for write by writers of the bucket, and for read by Find() when it cannot read optimistically. */
+    ReaderWriterLatch latch_;
+    /** One byte of the hash of the key in each slot, 0 for an empty slot, padded with 0 to a multiple of 16. */
+    std::vector<uint8_t> fingerprints_;
+    std::vector<K> keys_;
+    std::vector<V> values_;
   };
 
  private:
-  // TODO(student): You may add additional private members and helper functions and remove the ones
-  // you don't need.
+  /** Whether Find() may read buckets without latching them, copying keys and values that may be torn. */
+  static constexpr bool OPTIMISTIC_READS = std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>;
+
+  /** The directory, which is replaced by one twice its size when it doubles. */
+  struct Directory {
+    explicit Directory(int global_depth)
+        : global_depth_(global_depth), slots_(new std::atomic<Bucket *>[static_cast<size_t>(1) << global_depth]) {}
+
+    auto Size() const -> size_t { return static_cast<size_t>(1) << global_depth_; }
 
-  int global_depth_;    // The global depth of the directory
-  size_t bucket_size_;  // The size of a bucket
-  int num_buckets_;     // The number of buckets in the hash table
-  mutable std::mutex latch_;
-  std::vector<std::shared_ptr<Bucket>> dir_;  // The directory of the hash table
+    const int global_depth_;
+    std::unique_ptr<std::atomic<Bucket *>[]> slots_;
+  };
+
+  /** @return the non-zero fingerprint of a hash */
+  static auto FingerprintOf(size_t hash) -> uint8_t;
 
-  // The following functions are completely optional, you can delete them if you have your own ideas.
+  /** @return the bucket the current directory maps hash to */
+  auto BucketOf(size_t hash) const -> Bucket *;
 
   /**
-   * @brief Redistribute the kv pairs in a full bucket.
-   * @param bucket The bucket to be redistributed.
+   * @brief Split the full bucket that hash maps to, doubling the directory first if it has to. Does nothing if the
+   * bucket is not full anymore.
+   * @param hash the hash of the key that did not fit
    */
-  auto RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void;
-
-  /*****************************************************************
-   * Must acquire latch_ first before calling the below functions. *
-   *****************************************************************/
+  void SplitBucket(size_t hash);
 
   /**
    * @brief For the given key, return the entry index in the directory where the key hashes to.
@@ -201,9 +229,14 @@ class ExtendibleHashTable : public HashTable<K, V> {
    */
   auto IndexOf(const K &key) -> size_t;
 
-  auto GetGlobalDepthInternal() const -> int;
-  auto GetLocalDepthInternal(int dir_index) const -> int;
-  auto GetNumBucketsInternal() const -> int;
+  size_t bucket_size_;               // The size of a bucket
+  std::atomic<int> num_buckets_{1};  // The number of buckets in the hash table
+  std::atomic<Directory *> dir_;     // The directory of the hash table
+  /** Serializes splits, the only writers of the directory. */
+  std::mutex split_latch_;
+  /** Every directory and bucket ever allocated, freed with the table. Guarded by split_latch_. */
+  std::vector<std::unique_ptr<Directory>> directories_;
+  std::vector<std::unique_ptr<Bucket>> buckets_;
 };
 
 }  // namespace bustub
@@ -57,6 +57,9 @@ class InsertExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
+  /** The number of child tuples inserted, and their rows locked, at a time */
+  static constexpr size_t BATCH_SIZE = 256;
+
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
 
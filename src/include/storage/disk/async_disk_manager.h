@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * AsyncDiskManager keeps up to queue_depth page reads and writes in flight at once, instead of one per calling thread.
+ *
+ * Requests go to an io_uring instance: a batch is one io_uring_enter() call, and a background thread reaps the
+ * completions and sets the callbacks. Where io_uring is unavailable, because of the kernel or a seccomp filter, a
+ * pool of ASYNC_IO_THREADS threads runs the requests with pread() and pwrite() instead.
+ *
+ * The synchronous ReadPage() and WritePage() are inherited from DiskManager, and bypass the queue.
+ */
+class AsyncDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new async disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param queue_depth how many requests may be in flight at once
+   * @param use_io_uring false to use the thread pool even if io_uring is available
+   * @param direct_io true to open the database file with O_DIRECT, see DiskManager
+   * @param checksum_mode whether to checksum the pages, see DiskManager
+   */
+  explicit AsyncDiskManager(const std::string &db_file, size_t queue_depth = ASYNC_IO_QUEUE_DEPTH,
+                            bool use_io_uring = true, bool direct_io = false,
+                            PageChecksumMode checksum_mode = PageChecksumMode::NONE);
+
+  /** Waits for the requests in flight and stops the background threads. */
+  ~AsyncDiskManager() override;
+
+  /** Waits for the requests in flight, then closes the files. */
+  void ShutDown() override;
+
+  /**
+   * Submit the requests, blocking only while queue_depth requests are already in flight. The checksums of the pages
+   * to write are stamped first, and a read whose page fails verification completes with false.
+   * @param requests the requests, which are moved from
+   */
+  void SubmitBatch(std::vector<DiskRequest> *requests) override;
+
+  /** @return true if requests go through io_uring, false if they go through the thread pool */
+  auto UsesIoUring() const -> bool { return ring_fd_ >= 0; }
+
+ private:
+  /**
+   * A request, and the iovec io_uring reads it through, kept alive until its completion. With O_DIRECT, a request
+   * whose buffer is not aligned goes through aligned_data_ instead. Its latency is timed from when it is queued.
+   */
+  struct InFlightRequest {
+    DiskRequest request_;
+    iovec iov_;
+    std::unique_ptr<char, decltype(&std::free)> aligned_data_{nullptr, &std::free};
+    std::chrono::steady_clock::time_point submitted_{std::chrono::steady_clock::now()};
+  };
+
+  /** Set up the rings and start the reaper thread. @return false if io_uring is unavailable */
+  auto SetUpIoUring() -> bool;
+
+  /** Unmap whatever SetUpIoUring() has mapped. */
+  void UnmapRings();
+
+  /** Write one submission for in_flight, or a no-op stop marker if it is nullptr. Caller should hold latch_. */
+  void QueueSqe(InFlightRequest *in_flight);
+
+  /** Queue requests into the submission ring and enter them. Caller should hold latch_. */
+  void SubmitToRing(std::vector<DiskRequest> *requests, std::unique_lock<std::mutex> *lock);
+
+  /** Enter the submissions queued since the last call. Caller should hold latch_. */
+  void EnterSubmissions();
+
+  /** Reap completions until the stop marker comes back. */
+  void ReapCompletions();
+
+  /** Run queued requests until the disk manager stops. */
+  void RunWorker();
+
+  /** Set the callback of a finished request and free it. @param result bytes transferred, or -errno */
+  void Complete(InFlightRequest *request, ssize_t result);
+
+  /** Wait for the requests in flight and stop the background threads. Safe to call twice. */
+  void Stop();
+
+  const size_t queue_depth_;
+
+  /** Protects everything below but the ring pointers, which only the submitter or only the reaper touch. */
+  std::mutex latch_;
+  /** Signaled when a request completes. */
+  std::condition_variable completed_cv_;
+  /** Signaled when a request is queued for the thread pool. */
+  std::condition_variable queued_cv_;
+  size_t num_in_flight_{0};
+  bool stopped_{false};
+
+  // io_uring state, ring_fd_ is -1 when the thread pool is used instead.
+  int ring_fd_{-1};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  /** Submissions written to the ring but not entered yet. */
+  unsigned num_unentered_{0};
+  std::thread reaper_;
+
+  // Thread pool state.
+  std::deque<InFlightRequest *> queue_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
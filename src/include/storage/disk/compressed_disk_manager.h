@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_disk_manager.h
+//
+// Identification: src/include/storage/disk/compressed_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * CompressedDiskManager compresses each page with LZ4 when it is written, that is when a buffer pool evicts or flushes
+ * a dirty page, and decompresses it when it is read, on a buffer pool miss. Pages of tables that are appended to and
+ * seldom read, such as logs, shrink several times, and so do the file and the bytes read to scan them. The buffer pool
+ * and everything above it see plain pages.
+ *
+ * A compressed page takes a variable number of SLOT_SIZE slots of the database file, so the page of a page id is no
+ * longer at a fixed offset: a page map, kept in test.map for test.db and in memory, records where each page starts and
+ * how many bytes it takes. A rewritten page stays where it is if it takes as many slots as before and moves otherwise,
+ * the slots it leaves are reused by later writes of pages of that size or smaller. Pages that do not compress by at
+ * least a slot are stored as they are.
+ *
+ * Checksums, if enabled, are those of the uncompressed page, so they are verified after decompressing. There is no
+ * direct I/O: compressed pages are not aligned to pages.
+ */
+class CompressedDiskManager : public DiskManager {
+ public:
+  /** Pages take whole slots, so that a page never shares a disk sector with another. */
+  static constexpr size_t SLOT_SIZE = 512;
+  static constexpr size_t SLOTS_PER_PAGE = BUSTUB_PAGE_SIZE / SLOT_SIZE;
+
+  /**
+   * Open or create a compressed database file and its page map.
+   * @param db_file the file name of the database file
+   * @param checksum_mode whether to checksum the pages, see DiskManager
+   */
+  explicit CompressedDiskManager(const std::string &db_file, PageChecksumMode checksum_mode = PageChecksumMode::NONE);
+
+  /** Close the database file and the page map. */
+  void ShutDown() override;
+
+  /**
+   * Decompress a page. A page that was never written reads as zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Read a run of pages one by one, they are not adjacent in the file. */
+  void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) override {
+    for (size_t i = 0; i < pages.size(); i++) {
+      ReadPage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
+  }
+
+  /** @return the number of pages in the page map */
+  auto GetNumPages() const -> page_id_t override;
+
+  /** @return the number of bytes the pages take in the database file, including the free slots between them */
+  auto GetFileBytes() const -> size_t;
+
+  /** @return the number of bytes of the database file read so far */
+  auto GetBytesRead() const -> uint64_t { return bytes_read_; }
+
+  /** @return the number of bytes of the database file written so far */
+  auto GetBytesWritten() const -> uint64_t { return bytes_written_; }
+
+ protected:
+  /**
+   * Compress a page into its slots and record where they are, or read its slots and decompress them.
+   * @return BUSTUB_PAGE_SIZE, 0 when reading a page that was never written, or -1 with errno set
+   */
+  auto PageIO(bool is_write, page_id_t page_id, char *data) -> ssize_t override;
+
+ private:
+  /** Where a page is in the database file, as the page map holds it. All zeros for a page that was never written. */
+  struct PageLocation {
+    /** The first slot of the page. */
+    uint32_t first_slot_;
+    /** The size of the compressed page, BUSTUB_PAGE_SIZE if it is stored as it is, 0 if it was never written. */
+    uint32_t size_;
+  };
+
+  /** @return the number of slots a page of size bytes takes */
+  static auto SlotsOf(size_t size) -> size_t { return (size + SLOT_SIZE - 1) / SLOT_SIZE; }
+
+  /** Take a run of num_slots free slots, from a free run as small as possible or from the end of the file. */
+  auto AllocateSlots(size_t num_slots) -> uint32_t;
+
+  /** Give back a run of slots. */
+  void FreeSlots(uint32_t first_slot, size_t num_slots);
+
+  /** Rebuild the free runs from the gaps between the pages of the page map. */
+  void RebuildFreeSlots();
+
+  std::string map_name_;
+  int map_fd_{-1};
+  /** Protects page_map_, free_runs_ and num_slots_. */
+  mutable std::mutex map_latch_;
+  std::vector<PageLocation> page_map_;
+  /** The first slot of each free run, by the length of the run. */
+  std::array<std::vector<uint32_t>, SLOTS_PER_PAGE + 1> free_runs_;
+  /** The number of slots of the database file. */
+  uint32_t num_slots_{0};
+  std::atomic<uint64_t> bytes_read_{0};
+  std::atomic<uint64_t> bytes_written_{0};
+};
+
+}  // namespace bustub
@@ -12,16 +12,48 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "common/histogram.h"
 
 namespace bustub {
 
+/**
+ * A read or a write of one page, submitted through DiskManager::SubmitBatch().
+ */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+  /** The buffer to read the page into, or the data to write. It must stay valid until the request completes. */
+  char *data_;
+  /** The page to read or write. */
+  page_id_t page_id_;
+  /** Set to true once the request has completed, or to false if it failed. */
+  std::promise<bool> callback_;
+};
+
+/** Whether a DiskManager checksums the pages it writes, see DiskManager. */
+enum class PageChecksumMode { NONE = 0, CHECKSUM, DETECT_TORN_WRITES };
+
+/** What verifying a page against its checksums found. */
+enum class PageStatus {
+  /** The page is what was last written. */
+  OK = 0,
+  /** There are no checksums to verify the page against. */
+  UNCHECKED,
+  /** The page is neither what was last written nor a mix of it and the version before. */
+  CORRUPT,
+  /** Each sector of the page is either what was last written or what was written before: a write did not complete. */
+  TORN
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -30,9 +62,26 @@ class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
+   *
+   * With direct_io, the database file is opened with O_DIRECT, so that pages are cached by the buffer pool only and not
+   * a second time by the kernel. Page buffers aligned to BUSTUB_PAGE_SIZE, as the frames of a buffer pool are, go
+   * straight to the disk; others go through an aligned per-thread copy. File systems without O_DIRECT, such as tmpfs,
+   * fall back to buffered I/O.
+   *
+   * With checksums, the CRC-32C of each SECTOR_SIZE sector of a page is stamped when the page is written and verified
+   * when it is read, so that a read cannot return a page that was damaged on disk or cut short without it being
+   * noticed. Pages have no room for a checksum, so the checksums are kept next to the database file, in test.crc for
+   * test.db, and in memory. The checksums of the version of a page before the last one are kept too, which tells a
+   * torn write, a page whose sectors are a mix of both versions, from a corrupt page. The checksums are written before
+   * the page, and with DETECT_TORN_WRITES they are also synced before it, so that after a crash a page is never ahead
+   * of its checksums and an interrupted write is reported as torn rather than corrupt. That costs a sync per write.
+   *
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to bypass the kernel page cache for the database file
+   * @param checksum_mode whether to checksum the pages
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false,
+                       PageChecksumMode checksum_mode = PageChecksumMode::NONE);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
@@ -42,7 +91,7 @@ class DiskManager {
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
@@ -58,6 +107,38 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Read a run of consecutive pages with one preadv() system call, straight into buffers that need not be adjacent,
+   * such as the frames of a buffer pool. Pages past the end of the file read as zeros.
+   * @param first_page_id id of the first page of the run
+   * @param pages the output buffer of each page of the run
+   */
+  virtual void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages);
+
+  /**
+   * Read a page without waiting for it.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the returned future is ready
+   * @return a future that is set once the page has been read
+   */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool>;
+
+  /**
+   * Write a page without waiting for it.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid until the returned future is ready
+   * @return a future that is set once the page has been written
+   */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool>;
+
+  /**
+   * Submit a batch of requests at once. Each request's callback is set when it completes, in no particular order.
+   * The default implementation runs the requests one after the other on the calling thread, through ReadPage() and
+   * WritePage().
+   * @param requests the requests, which are moved from
+   */
+  virtual void SubmitBatch(std::vector<DiskRequest> *requests);
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -83,6 +164,47 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /**
+   * @return the nanoseconds each page read took, from its submission to its completion. A run of pages read by
+   * ReadPages() with one system call counts once.
+   */
+  auto GetReadLatency() const -> const Histogram & { return read_latency_; }
+
+  /** @return the nanoseconds each page write took, from its submission to its completion */
+  auto GetWriteLatency() const -> const Histogram & { return write_latency_; }
+
+  /** @return whether pages are checksummed */
+  auto GetChecksumMode() const -> PageChecksumMode { return checksum_mode_; }
+
+  /**
+   * Verify a page read from disk against its checksums. A CORRUPT or TORN page is logged and counted.
+   * @param page_id id of the page
+   * @param page_data the page as read
+   * @return what the page was found to be, UNCHECKED if pages are not checksummed
+   */
+  auto VerifyPage(page_id_t page_id, const char *page_data) -> PageStatus;
+
+  /**
+   * Read a page and verify it, on behalf of a scrubber that walks the database file. A page verified by a read or
+   * stamped by a write since the scrubber last visited it is not read again, it is not cold. Like VerifyPage(), a
+   * CORRUPT or TORN page is logged and counted.
+   * @param page_id id of the page
+   * @return what the page was found to be, OK if it was skipped
+   */
+  auto ScrubPage(page_id_t page_id) -> PageStatus;
+
+  /** @return the number of pages found CORRUPT by reads and scrubs */
+  auto GetNumCorruptPages() const -> uint64_t { return num_corrupt_pages_; }
+
+  /** @return the number of pages found TORN by reads and scrubs */
+  auto GetNumTornPages() const -> uint64_t { return num_torn_pages_; }
+
+  /** @return the number of pages the database file spans */
+  virtual auto GetNumPages() const -> page_id_t;
+
+  /** @return true if the database file is opened with O_DIRECT */
+  auto UsesDirectIO() const -> bool { return direct_io_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -93,7 +215,68 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
-  auto GetFileSize(const std::string &file_name) -> int;
+  auto GetFileSize(const std::string &file_name) const -> int;
+
+  /**
+   * pread() or pwrite() one page of the database file, through an aligned buffer if the file is opened with O_DIRECT
+   * and data is not aligned. Safe to call concurrently. Subclasses that lay pages out differently override it.
+   * @return the number of bytes transferred, or -1 with errno set
+   */
+  virtual auto PageIO(bool is_write, page_id_t page_id, char *data) -> ssize_t;
+
+  /**
+   * Compute the checksums of a page about to be written, keep the ones it replaces as the previous version, and write
+   * them to the checksum file, synced with DETECT_TORN_WRITES. Restamping a page with what it already holds keeps the
+   * previous version. Does nothing if pages are not checksummed.
+   */
+  void StampChecksum(page_id_t page_id, const char *page_data);
+
+  static constexpr size_t SECTOR_SIZE = 512;
+  static constexpr size_t SECTORS_PER_PAGE = BUSTUB_PAGE_SIZE / SECTOR_SIZE;
+
+  /** The checksums of a page, as the checksum file holds them. All zeros if the page has none. */
+  struct PageChecksum {
+    /** The CRC-32C of each sector of the page as last written. */
+    std::array<uint32_t, SECTORS_PER_PAGE> current_;
+    /** The CRC-32C of each sector of the page as written before that, those of a page of zeros at first. */
+    std::array<uint32_t, SECTORS_PER_PAGE> previous_;
+  };
+
+  /**
+   * The header of the checksum file, which records the database file its checksums are of. A checksum file of another
+   * database file, one left behind when the database file was deleted and created again, is discarded when opened.
+   */
+  struct ChecksumFileHeader {
+    uint64_t magic_;
+    /** The device and inode of the database file. */
+    uint64_t device_;
+    uint64_t inode_;
+  };
+
+  static constexpr uint64_t CHECKSUM_FILE_MAGIC = 0x4255535443524331;  // "BUSTCRC1", the last character is the version
+  /** The checksums of page i are at CHECKSUM_FILE_HEADER_SIZE + i * sizeof(PageChecksum) in the checksum file. */
+  static constexpr size_t CHECKSUM_FILE_HEADER_SIZE = 64;
+  static_assert(sizeof(ChecksumFileHeader) <= CHECKSUM_FILE_HEADER_SIZE);
+
+  /** Open the checksum file of the database file and load its checksums, or start it over if it is not of it. */
+  void OpenChecksumFile();
+
+  /** @return the checksums of the sectors of page_data */
+  static auto ComputeChecksum(const char *page_data) -> std::array<uint32_t, SECTORS_PER_PAGE>;
+
+  /** @return what page_data is, given the checksums of its page */
+  static auto ClassifyPage(const PageChecksum &checksum, const char *page_data) -> PageStatus;
+
+  /**
+   * Copy the checksums of a page. Caller should not hold checksum_latch_.
+   * @param mark_verified true to record that the page was verified, so that the scrubber skips it once
+   * @return false if the page has no checksums
+   */
+  auto GetChecksum(page_id_t page_id, PageChecksum *checksum, bool mark_verified) -> bool;
+
+  /** Log and count a page that failed verification. */
+  void ReportBadPage(page_id_t page_id, PageStatus status);
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
@@ -102,12 +285,27 @@ class DiskManager {
   std::string file_name_;
   int db_fd_;
   int log_fd_;
+  bool direct_io_{false};
 
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
+  Histogram read_latency_;
+  Histogram write_latency_;
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
+  PageChecksumMode checksum_mode_{PageChecksumMode::NONE};
+  std::string checksum_name_;
+  int checksum_fd_{-1};
+  /** Protects checksums_ and verified_. */
+  std::mutex checksum_latch_;
+  /** The checksums of each page, loaded from the checksum file when it is opened. */
+  std::vector<PageChecksum> checksums_;
+  /** Whether each page was verified or stamped since the scrubber last visited it. */
+  std::vector<bool> verified_;
+  std::atomic<uint64_t> num_corrupt_pages_{0};
+  std::atomic<uint64_t> num_torn_pages_{0};
+  // Page reads and writes go through pread() and pwrite(), which take their own offset, so concurrent buffer pool
+  // instances do not need a latch around the db file. Only ShutDown() takes this one.
   std::mutex db_io_latch_;
 };
 
@@ -52,6 +52,13 @@ class DiskManagerMemory : public DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data) override;
 
+  /** Read a run of pages one by one, a copy out of memory has nothing to gain from a vectored read. */
+  void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) override {
+    for (size_t i = 0; i < pages.size(); i++) {
+      ReadPage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
+  }
+
  private:
   char *memory_;
 };
@@ -106,6 +113,13 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
   }
 
+  /** Read a run of pages one by one, a copy out of memory has nothing to gain from a vectored read. */
+  void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) override {
+    for (size_t i = 0; i < pages.size(); i++) {
+      ReadPage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
+  }
+
  private:
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
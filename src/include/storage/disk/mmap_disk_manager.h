@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.h
+//
+// Identification: src/include/storage/disk/mmap_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * MmapDiskManager serves a database file read-only out of one shared mapping of the whole file, for read-only copies
+ * of a database. ReadPage() is a memcpy() out of the mapping instead of a pread() system call, and GetPageData() lets
+ * readers that do not need a buffer pool frame read a page in place.
+ *
+ * The file is mapped at its size when it is opened: pages past its end read as zeros. Nothing can change the file, so
+ * WritePage() accepts a page only if it holds what the file already has, as when a buffer pool flushes a clean page,
+ * and throws otherwise. There is no log file.
+ */
+class MmapDiskManager : public DiskManager {
+ public:
+  /**
+   * Map the database file read-only.
+   * @param db_file the file name of the database file
+   */
+  explicit MmapDiskManager(const std::string &db_file);
+
+  /** Unmaps the file if ShutDown() has not. */
+  ~MmapDiskManager() override;
+
+  /** Unmap and close the file. */
+  void ShutDown() override;
+
+  /**
+   * Check that a page is unchanged, since the file cannot be written.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must be what the file holds for the page
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Copy a page out of the mapping.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Copy a run of pages out of the mapping one by one. */
+  void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) override {
+    for (size_t i = 0; i < pages.size(); i++) {
+      ReadPage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
+  }
+
+  /**
+   * @param page_id id of the page
+   * @return the page in the mapping, valid until ShutDown(), or nullptr if the page is past the end of the file
+   */
+  auto GetPageData(page_id_t page_id) const -> const char *;
+
+  /** @return the number of pages in the mapping */
+  auto GetNumPages() const -> page_id_t override { return static_cast<page_id_t>(size_ / BUSTUB_PAGE_SIZE); }
+
+ private:
+  /** Unmap and close the file. Safe to call twice. */
+  void Unmap();
+
+  char *data_{nullptr};
+  size_t size_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_scrubber.h
+//
+// Identification: src/include/storage/disk/page_scrubber.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * PageScrubber walks the database file of a checksumming DiskManager on a background thread, over and over, and
+ * verifies each page against its checksums, see DiskManager::ScrubPage(). Pages that are read find out they are
+ * damaged when they are read; the scrubber finds out for the cold ones, which may not be read for a long time. It reads
+ * at most pages_per_second pages a second, so that it takes little of the I/O the database needs.
+ */
+class PageScrubber {
+ public:
+  /**
+   * Create a new PageScrubber and start its background thread.
+   * @param disk_manager the disk manager of the file to scrub, which checksums its pages
+   * @param pages_per_second how many pages to verify a second, at least 1
+   */
+  explicit PageScrubber(DiskManager *disk_manager, size_t pages_per_second = PAGE_SCRUB_RATE);
+
+  /** Stop and join the background thread. */
+  ~PageScrubber();
+
+  /** @return how many pages the scrubber has visited */
+  auto GetNumScrubbed() const -> size_t { return num_scrubbed_; }
+
+  /** @return how many times the scrubber has walked the whole file */
+  auto GetNumPasses() const -> size_t { return num_passes_; }
+
+  /** @return the pages the scrubber has found CORRUPT or TORN, each once, in the order it first found them */
+  auto GetBadPages() -> std::vector<page_id_t>;
+
+ private:
+  /** Visit a page every 1 / pages_per_second_ seconds until the scrubber is destroyed. */
+  void Run();
+
+  DiskManager *disk_manager_;
+  const size_t pages_per_second_;
+
+  /** Protects stop_ and bad_pages_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  std::vector<page_id_t> bad_pages_;
+
+  std::atomic<size_t> num_scrubbed_{0};
+  std::atomic<size_t> num_passes_{0};
+
+  std::thread worker_;
+};
+
+}  // namespace bustub
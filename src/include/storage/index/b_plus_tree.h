@@ -96,6 +96,22 @@ class BPlusTree {
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
 
  private:
+  /** Which leaf FindLeafOptimistic() descends to: that of a key, the first, or the last. */
+  enum class Seek { KEY, FIRST, LAST };
+
+  /** Times a reader restarts its optimistic descent, after writers changed a page under it, before it crabs down. */
+  static constexpr int OPTIMISTIC_ATTEMPTS = 16;
+
+  // Find a leaf without latching the pages above it, pinned and latched for op, nullptr if the tree is empty
+  auto FindLeafOptimistic(const KeyType &key, Seek seek, Operation op = READ) -> Page *;
+
+  // Insert into or remove from a leaf that FindLeafOptimistic() write latched, if that won't change its parent
+  auto InsertOptimistic(const KeyType &key, const ValueType &value, bool *inserted) -> bool;
+  auto RemoveOptimistic(const KeyType &key) -> bool;
+
+  // Find a leaf crabbing down with read latches, read latched and pinned, nullptr if the tree is empty
+  auto FindLeafPessimistic(const KeyType &key, Seek seek) -> Page *;
+
   void UpdateRootPageId(int insert_record = 0);
 
   /* Debug Routines for FREE!! */
@@ -13,7 +13,9 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
+#include "storage/index/normalized_key.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -35,12 +37,25 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  /**
+   * Set the key from a tuple of key_schema, as NormalizedKey encodes it if it encodes keys of key_schema, and as
+   * SetFromKey(tuple) otherwise. The indexes set their keys this way, so that their comparators can tell which.
+   */
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    if (NormalizedKey::IsEncoded(key_schema, KeySize)) {
+      NormalizedKey::Encode(tuple, key_schema, data_, KeySize);
+    } else {
+      SetFromKey(tuple);
+    }
+  }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
     memcpy(data_, &key, sizeof(int64_t));
   }
 
+  // NOTE: the key must not be encoded
   inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
     const char *data_ptr;
     const auto &col = schema->GetColumn(column_idx);
@@ -72,11 +87,165 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * How it compares is chosen from the key schema when it is constructed, which for an index is when the catalog creates
+ * it: keys that NormalizedKey encodes are compared with a memcmp() of as many bytes as any of them takes, a single
+ * INTEGER or BIGINT column as a native integer, and other keys of fixed size columns column by column at their
+ * offsets, as the native type of each. Only keys that have a VARCHAR column too long to encode build a Value of every
+ * column.
+ * A NULL sorts first, as NormalizedKey has it: it is stored as the smallest value of its type, and as the largest
+ * TIMESTAMP, which is compared plus one so that it wraps to zero. Only a Value compares it equal to everything.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    switch (kind_) {
+      case KeyKind::INTEGER:
+        return CompareAt<int32_t>(lhs, rhs, 0);
+      case KeyKind::BIGINT:
+        return CompareAt<int64_t>(lhs, rhs, 0);
+      case KeyKind::NORMALIZED: {
+        const int cmp = memcmp(lhs.data_, rhs.data_, normalized_size_);
+        return static_cast<int>(cmp > 0) - static_cast<int>(cmp < 0);
+      }
+      case KeyKind::FIXED:
+        return CompareFixed(lhs, rhs);
+      default:
+        return CompareValues(lhs, rhs);
+    }
+  }
+
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_},
+        kind_{other.kind_},
+        normalized_size_{other.normalized_size_},
+        columns_{other.columns_},
+        integer_key_type_{other.integer_key_type_} {}
+
+  // constructor
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {
+    if (key_schema_ == nullptr) {
+      return;
+    }
+    if (NormalizedKey::IsEncoded(*key_schema_, KeySize)) {
+      kind_ = KeyKind::NORMALIZED;
+      normalized_size_ = NormalizedKey::GetMaxSize(*key_schema_);
+      return;
+    }
+    kind_ = KeyKind::FIXED;
+    for (const auto &column : key_schema_->GetColumns()) {
+      const uint32_t size = FixedSize(column.GetType());
+      if (size == 0 || column.GetOffset() + size > KeySize) {
+        kind_ = KeyKind::VALUES;
+        columns_.clear();
+        break;
+      }
+      columns_.push_back({column.GetOffset(), column.GetType()});
+    }
+    if (columns_.size() == 1) {
+      const TypeId type = columns_[0].type_;
+      if (type == TypeId::INTEGER || type == TypeId::BIGINT) {
+        kind_ = type == TypeId::INTEGER ? KeyKind::INTEGER : KeyKind::BIGINT;
+      }
+      if (type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT) {
+        integer_key_type_ = type;
+      }
+    }
+  }
+
+  /**
+   * @return the type of the keys if they are a single integer column, which the B+ tree pages then search as integers
+   * (NULL, the smallest value of the type, sorting first), INVALID otherwise
+   */
+  inline auto GetIntegerKeyType() const -> TypeId { return integer_key_type_; }
+
+ private:
+  /** How keys are compared. */
+  enum class KeyKind { INTEGER, BIGINT, NORMALIZED, FIXED, VALUES };
+
+  /** A column of a key of fixed size columns. */
+  struct KeyColumn {
+    uint32_t offset_;
+    TypeId type_;
+  };
+
+  /** @return the bytes a column of type takes in a key, 0 if that varies */
+  static auto FixedSize(TypeId type) -> uint32_t {
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return sizeof(int8_t);
+      case TypeId::SMALLINT:
+        return sizeof(int16_t);
+      case TypeId::INTEGER:
+        return sizeof(int32_t);
+      case TypeId::BIGINT:
+        return sizeof(int64_t);
+      case TypeId::DECIMAL:
+        return sizeof(double);
+      case TypeId::TIMESTAMP:
+        return sizeof(uint64_t);
+      default:
+        return 0;
+    }
+  }
+
+  /** @return the order of the native values of type T at offset in two keys */
+  template <typename T>
+  static inline auto CompareAt(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs, uint32_t offset)
+      -> int {
+    T lhs_value;
+    T rhs_value;
+    memcpy(&lhs_value, lhs.data_ + offset, sizeof(T));
+    memcpy(&rhs_value, rhs.data_ + offset, sizeof(T));
+    return static_cast<int>(rhs_value < lhs_value) - static_cast<int>(lhs_value < rhs_value);
+  }
+
+  /** @return the order of the TIMESTAMPs at offset in two keys, plus one so that NULL, the largest, sorts first */
+  static inline auto CompareTimestampAt(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs,
+                                        uint32_t offset) -> int {
+    uint64_t lhs_value;
+    uint64_t rhs_value;
+    memcpy(&lhs_value, lhs.data_ + offset, sizeof(uint64_t));
+    memcpy(&rhs_value, rhs.data_ + offset, sizeof(uint64_t));
+    lhs_value++;
+    rhs_value++;
+    return static_cast<int>(rhs_value < lhs_value) - static_cast<int>(lhs_value < rhs_value);
+  }
+
+  inline auto CompareFixed(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    for (const auto &column : columns_) {
+      int cmp;
+      switch (column.type_) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          cmp = CompareAt<int8_t>(lhs, rhs, column.offset_);
+          break;
+        case TypeId::SMALLINT:
+          cmp = CompareAt<int16_t>(lhs, rhs, column.offset_);
+          break;
+        case TypeId::INTEGER:
+          cmp = CompareAt<int32_t>(lhs, rhs, column.offset_);
+          break;
+        case TypeId::BIGINT:
+          cmp = CompareAt<int64_t>(lhs, rhs, column.offset_);
+          break;
+        case TypeId::DECIMAL:
+          cmp = CompareAt<double>(lhs, rhs, column.offset_);
+          break;
+        default:
+          cmp = CompareTimestampAt(lhs, rhs, column.offset_);
+          break;
+      }
+      if (cmp != 0) {
+        return cmp;
+      }
+    }
+    return 0;
+  }
+
+  inline auto CompareValues(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
@@ -94,13 +263,11 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
-
-  // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
-
- private:
   Schema *key_schema_;
+  KeyKind kind_{KeyKind::VALUES};
+  size_t normalized_size_{0};
+  std::vector<KeyColumn> columns_;
+  TypeId integer_key_type_{TypeId::INVALID};
 };
 
 }  // namespace bustub
@@ -41,6 +41,9 @@ class IndexIterator {
   }
 
  private:
+  /** @return the next link of a read latched leaf page */
+  static auto NextLeafPageId(Page *page) -> page_id_t;
+
   page_id_t page_id_ = INVALID_PAGE_ID;
   // KV pair index
   int index_ = 0;
@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include "type/type_id.h"
+
+namespace bustub {
+
+/**
+ * The searches below look for a key among the sorted keys of a B+ tree page, which are stride bytes apart as they are
+ * stored with their values. Each returns the number of keys less than the key or, with Upper, less than or equal to
+ * it: the lower or the upper bound.
+ *
+ * Both halve the range without branching on the comparisons, so that the descent does not stall on mispredictions.
+ * Integer keys are compared as integers rather than through the comparator, and the last KEY_SEARCH_WINDOW of them
+ * side by side, with SIMD instructions where the target has them.
+ */
+static constexpr int KEY_SEARCH_WINDOW = 16;
+
+/** @return the bound of key among n keys, compared by comparator */
+template <bool Upper, typename KeyType, typename KeyComparator>
+inline auto SearchKeys(const char *keys, size_t stride, int n, const KeyType &key, const KeyComparator &comparator)
+    -> int {
+  if (n == 0) {
+    return 0;
+  }
+  const auto below = [&](int index) {
+    const int cmp = comparator(*reinterpret_cast<const KeyType *>(keys + index * stride), key);
+    return Upper ? cmp <= 0 : cmp < 0;
+  };
+  // All the keys before base are below key, and none from base + n on.
+  int base = 0;
+  while (n > 1) {
+    const int half = n / 2;
+    base = below(base + half) ? base + half : base;
+    n -= half;
+  }
+  return base + static_cast<int>(below(base));
+}
+
+/** @return the number of the KEY_SEARCH_WINDOW keys of window below key */
+template <bool Upper, typename IntType>
+inline auto CountWindow(const IntType *window, IntType key) -> int {
+#if defined(__SSE2__)
+  if constexpr (std::is_same_v<IntType, int32_t>) {
+    // Count those above key, which for Upper are those not below it.
+    const __m128i needle = _mm_set1_epi32(key);
+    int count = 0;
+    for (int i = 0; i < KEY_SEARCH_WINDOW; i += 4) {
+      const __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(window + i));
+      const __m128i mask = Upper ? _mm_cmpgt_epi32(keys, needle) : _mm_cmpgt_epi32(needle, keys);
+      count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+    }
+    return Upper ? KEY_SEARCH_WINDOW - count : count;
+  }
+#endif
+#if defined(__SSE4_2__)
+  if constexpr (std::is_same_v<IntType, int64_t>) {
+    const __m128i needle = _mm_set1_epi64x(key);
+    int count = 0;
+    for (int i = 0; i < KEY_SEARCH_WINDOW; i += 2) {
+      const __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(window + i));
+      const __m128i mask = Upper ? _mm_cmpgt_epi64(keys, needle) : _mm_cmpgt_epi64(needle, keys);
+      count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(mask)));
+    }
+    return Upper ? KEY_SEARCH_WINDOW - count : count;
+  }
+#endif
+  // A loop the compiler vectorizes where it can.
+  int count = 0;
+  for (int i = 0; i < KEY_SEARCH_WINDOW; i++) {
+    count += static_cast<int>(Upper ? window[i] <= key : window[i] < key);
+  }
+  return count;
+}
+
+/** @return the bound of key among n keys of IntType, the first bytes of each key */
+template <bool Upper, typename IntType>
+inline auto SearchIntegerKeys(const char *keys, size_t stride, int n, const char *key) -> int {
+  const auto load = [&](const char *data) {
+    IntType value;
+    memcpy(&value, data, sizeof(IntType));
+    return value;
+  };
+  const IntType needle = load(key);
+  int base = 0;
+  while (n > KEY_SEARCH_WINDOW) {
+    const int half = n / 2;
+    const IntType probe = load(keys + (base + half) * stride);
+    base = (Upper ? probe <= needle : probe < needle) ? base + half : base;
+    n -= half;
+  }
+  // Gather the rest, padded with the key itself: below it only for Upper, which then counts the padding out.
+  IntType window[KEY_SEARCH_WINDOW];
+  for (int i = 0; i < KEY_SEARCH_WINDOW; i++) {
+    window[i] = i < n ? load(keys + (base + i) * stride) : needle;
+  }
+  return base + CountWindow<Upper>(window, needle) - (Upper ? KEY_SEARCH_WINDOW - n : 0);
+}
+
+/**
+ * @param keys the first key
+ * @param stride the bytes from one key to the next
+ * @param n the number of keys
+ * @return the number of keys less than key or, with Upper, less than or equal to it
+ */
+template <bool Upper, typename KeyType, typename KeyComparator>
+inline auto KeyBound(const KeyType *keys, size_t stride, int n, const KeyType &key, const KeyComparator &comparator)
+    -> int {
+  const auto *data = reinterpret_cast<const char *>(keys);
+  const auto *needle = reinterpret_cast<const char *>(&key);
+  switch (comparator.GetIntegerKeyType()) {
+    case TypeId::TINYINT:
+      return SearchIntegerKeys<Upper, int8_t>(data, stride, n, needle);
+    case TypeId::SMALLINT:
+      return SearchIntegerKeys<Upper, int16_t>(data, stride, n, needle);
+    case TypeId::INTEGER:
+      return SearchIntegerKeys<Upper, int32_t>(data, stride, n, needle);
+    case TypeId::BIGINT:
+      return SearchIntegerKeys<Upper, int64_t>(data, stride, n, needle);
+    default:
+      return SearchKeys<Upper>(data, stride, n, key, comparator);
+  }
+}
+
+}  // namespace bustub
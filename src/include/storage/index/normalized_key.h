@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * NormalizedKey encodes index keys so that their bytes order as the keys do, and two keys compare with one memcmp().
+ *
+ * The columns are encoded one after the other:
+ * - integers big-endian with the sign bit flipped, so that the NULL of each, its smallest value, sorts first;
+ * - BOOLEAN as the TINYINT it is stored as;
+ * - DECIMAL as the bits of the double, all of them flipped if it is negative and only the sign bit otherwise;
+ * - TIMESTAMP big-endian, plus one so that its NULL, the largest value, wraps to zero and sorts first too;
+ * - VARCHAR as 0x00 if it is NULL, otherwise as 0x01 and then its bytes, 0x00 escaped as 0x00 0xFF, and 0x00 0x00.
+ *
+ * No encoding of a column is a prefix of another, so the zeros that pad a key out do not change its order, and only
+ * the first GetMaxSize() bytes of keys need comparing.
+ */
+class NormalizedKey {
+ public:
+  /** @return the most bytes a key of key_schema encodes to, 0 if a column is of a type that is not encoded */
+  static auto GetMaxSize(const Schema &key_schema) -> size_t;
+
+  /**
+   * @return true if keys of key_schema in key_size bytes are encoded: those of more than one column or of a VARCHAR
+   * column that fit. Keys of a single fixed size column are left as they are stored, which compares as fast.
+   */
+  static auto IsEncoded(const Schema &key_schema, size_t key_size) -> bool;
+
+  /**
+   * Encode a key into data, padded with zeros.
+   * @param key a tuple of key_schema
+   * @param key_schema the key schema, IsEncoded() in size bytes
+   * @param[out] data the size bytes to encode into
+   * @param size the bytes of data
+   */
+  static void Encode(const Tuple &key, const Schema &key_schema, char *data, size_t size);
+};
+
+}  // namespace bustub
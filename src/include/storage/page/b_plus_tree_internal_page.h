@@ -38,6 +38,10 @@ class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  // the number of pairs that fit in an internal page of page_size bytes, INTERNAL_PAGE_SIZE for BUSTUB_PAGE_SIZE
+  static constexpr auto MaxSizeFor(size_t page_size) -> int {
+    return static_cast<int>((page_size - INTERNAL_PAGE_HEADER_SIZE) / sizeof(MappingType));
+  }
 
   auto KeyAt(int index) const -> KeyType;
   void SetKeyAt(int index, const KeyType &key);
@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A page of the free space map of a table, see FreeSpaceMap. It lists table pages and the free space of each, in
+ * units of 1/256 of a page, so that a 4 KiB page holds over 800 of them.
+ *
+ *  Header format (size in bytes):
+ *  -----------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | NumEntries (4) | ... |
+ *  -----------------------------------------------------------------
+ *  followed by the table page ids of the entries, 4 bytes each, and then their free space, a byte each.
+ */
+class FreeSpaceMapPage : public Page {
+ public:
+  /** Initialize an empty map page. */
+  void Init(page_id_t page_id) {
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    SetNextPageId(INVALID_PAGE_ID);
+    SetNumEntries(0);
+  }
+
+  /** @return the page ID of the next page of the map */
+  auto GetNextPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page ID of the next page of the map. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of table pages listed */
+  auto GetNumEntries() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_NUM_ENTRIES); }
+
+  /** Set the number of table pages listed. */
+  void SetNumEntries(uint32_t num_entries) { memcpy(GetData() + OFFSET_NUM_ENTRIES, &num_entries, sizeof(uint32_t)); }
+
+  /** @return the number of table pages a map page of this size lists */
+  auto GetCapacity() -> size_t { return (GetSize() - SIZE_HEADER) / (sizeof(page_id_t) + sizeof(uint8_t)); }
+
+  /** @return the table page of an entry */
+  auto GetTablePageId(size_t index) -> page_id_t {
+    return *reinterpret_cast<page_id_t *>(GetData() + SIZE_HEADER + index * sizeof(page_id_t));
+  }
+
+  /** @return the free space of the table page of an entry */
+  auto GetFreeSpace(size_t index) -> uint8_t {
+    return *reinterpret_cast<uint8_t *>(GetData() + SIZE_HEADER + GetCapacity() * sizeof(page_id_t) + index);
+  }
+
+  /** Set the table page and its free space of an entry. */
+  void SetEntry(size_t index, page_id_t table_page_id, uint8_t free_space) {
+    memcpy(GetData() + SIZE_HEADER + index * sizeof(page_id_t), &table_page_id, sizeof(page_id_t));
+    memcpy(GetData() + SIZE_HEADER + GetCapacity() * sizeof(page_id_t) + index, &free_space, sizeof(uint8_t));
+  }
+
+ private:
+  static constexpr size_t SIZE_HEADER = 16;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NUM_ENTRIES = 12;
+};
+
+}  // namespace bustub
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -30,8 +33,15 @@ class Page {
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates the page data and zeros it out. */
+  Page() : owned_data_(new char[BUSTUB_PAGE_SIZE]), data_(owned_data_.get()) { ResetMemory(); }
+
+  /**
+   * Constructor for a frame of the buffer pool. Zeros out the page data.
+   * @param data the bytes the page data lives in, owned by the caller and outliving the page
+   * @param size the page size of the buffer pool, a multiple of BUSTUB_PAGE_SIZE
+   */
+  Page(char *data, size_t size) : data_(data), size_(size) { ResetMemory(); }
 
   /** Default destructor. */
   ~Page() = default;
@@ -39,6 +49,9 @@ class Page {
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
 
+  /** @return the size of the page data in bytes, BUSTUB_PAGE_SIZE unless the page is from a larger page size pool */
+  inline auto GetSize() const -> size_t { return size_; }
+
   /** @return the page id of this page */
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
@@ -49,10 +62,25 @@ class Page {
   inline auto IsDirty() -> bool { return is_dirty_; }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1);
+  }
+
+  /** Acquire the page write latch if it is free. @return true if it was acquired */
+  inline auto TryWLatch() -> bool {
+    if (!rwlatch_.TryWLock()) {
+      return false;
+    }
+    version_.fetch_add(1);
+    return true;
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,6 +88,26 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Read the page without a latch: take its version, read, and check with ValidateVersion() that no writer latched
+   * it in the meantime, which would have left what was read inconsistent.
+   * @return the version of the page, once no writer holds its write latch
+   */
+  inline auto ReadVersion() const -> uint64_t {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    while ((version & 1) != 0) {
+      std::this_thread::yield();
+      version = version_.load(std::memory_order_acquire);
+    }
+    return version;
+  }
+
+  /** @return true if no writer has latched the page since ReadVersion() returned version */
+  inline auto ValidateVersion(uint64_t version) const -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -76,18 +124,27 @@ class Page {
 
  private:
   /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
-
-  /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, size_); }
+
+  /** The data of a page that is not a buffer pool frame, nullptr for a frame. */
+  std::unique_ptr<char[]> owned_data_;
+  /** The actual data that is stored within a page. Buffer pool frames point into the frame arena. */
+  char *data_;
+  /** The size of the data in bytes. */
+  size_t size_{BUSTUB_PAGE_SIZE};
+  /** The ID of this page. Read without the buffer pool latch by the buffer-hit fast path. */
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /**
+   * The pin count of this page. A frame that is being evicted, deleted or (re)loaded is claimed by the buffer pool
+   * manager by swapping the count from 0 to -1, which keeps the lock-free fast path from pinning it in the meantime.
+   */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** The number of times the write latch was taken and released, odd while it is held. */
+  std::atomic<uint64_t> version_ = 0;
 };
 
 }  // namespace bustub
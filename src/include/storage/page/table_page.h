@@ -36,10 +36,13 @@ namespace bustub {
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  -------------------------------------------------------------------------------------------
+ *  | TupleCount (4) | FreeSpaceMapPageId (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  -------------------------------------------------------------------------------------------
  *
+ *  FreeSpaceMapPageId is the first page of the free space map of the table on its first page, and INVALID_PAGE_ID
+ *  on the others, see FreeSpaceMap. It moved the tuple slots 4 bytes further, so table pages written before it was
+ *  added are not read correctly and are not supported.
  */
 class TablePage : public Page {
  public:
@@ -72,6 +75,27 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  /** @return the first page of the free space map of the table, if this is the first page of the table */
+  auto GetFreeSpaceMapPageId() -> page_id_t {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_FREE_SPACE_MAP_PAGE_ID);
+  }
+
+  /** Set the first page of the free space map of the table. */
+  void SetFreeSpaceMapPageId(page_id_t page_id) {
+    memcpy(GetData() + OFFSET_FREE_SPACE_MAP_PAGE_ID, &page_id, sizeof(page_id_t));
+  }
+
+  /** @return the size of the largest tuple that fits in an empty table page of page_size bytes */
+  static auto MaxTupleSize(uint32_t page_size) -> uint32_t {
+    return page_size - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
+  }
+
+  /** @return the size of the largest tuple that fits in the free space of this page */
+  auto GetMaxInsertSize() -> uint32_t {
+    const uint32_t free_space = GetFreeSpaceRemaining();
+    return free_space > SIZE_TUPLE ? free_space - SIZE_TUPLE : 0;
+  }
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -141,14 +165,15 @@ class TablePage : public Page {
  private:
   static_assert(sizeof(page_id_t) == 4);
 
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 28;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;  // Naming things is hard.
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FREE_SPACE_MAP_PAGE_ID = 24;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 28;  // Naming things is hard.
+  static constexpr size_t OFFSET_TUPLE_SIZE = 32;
 
   /** @return pointer to the end of the current free space, see header comment */
   auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap records how much free space each page of a table heap has, so that an insert goes straight to a page
+ * with room for its tuple instead of trying every page of the table in turn.
+ *
+ * The map is kept in a chain of FreeSpaceMapPage pages in the buffer pool of the table, the first of which the first
+ * table page points to, and in memory as a tree of maximums over the pages, in the order they were added to the table,
+ * which finds the first page at or after a position with enough room in O(log n). Free space is recorded in units of
+ * 1/256 of a page, rounded down, so a page the map picks always has the room; a page is written to the map pages only
+ * when its free space changes by a unit. A map is a hint and only one TableHeap should update it.
+ */
+class FreeSpaceMap {
+ public:
+  /**
+   * @param bpm the buffer pool of the table
+   */
+  explicit FreeSpaceMap(BufferPoolManager *bpm);
+
+  /**
+   * Create the map of a new table, with no pages.
+   * @return the first page of the map, INVALID_PAGE_ID if the buffer pool has no frame for it
+   */
+  auto Create() -> page_id_t;
+
+  /**
+   * Load the map of an existing table from its pages.
+   * @param first_page_id the first page of the map
+   */
+  void Load(page_id_t first_page_id);
+
+  /**
+   * Add a new page, the last one of the table. Callers add one page at a time, as TableHeap does under the latch of
+   * its last page.
+   * @param table_page_id the page
+   * @param free_space the size of the largest tuple that fits in the page
+   * @return false if the buffer pool had no frame for a new page of the map, the page is not in the map then
+   */
+  auto AddPage(page_id_t table_page_id, uint32_t free_space) -> bool;
+
+  /**
+   * Record the free space of a page of the table, which should be write latched so that its free space does not
+   * change, and so that the entries of a page are written to the map pages in order.
+   * @param table_page_id the page, ignored if it is not in the map
+   * @param free_space the size of the largest tuple that fits in the page
+   */
+  void UpdatePage(page_id_t table_page_id, uint32_t free_space);
+
+  /**
+   * Find a page with room for a tuple.
+   * @param size the size of the tuple
+   * @param[in,out] position the position of the first page to consider, in the order the pages were added, set to
+   * that of the page found
+   * @return the first page at or after position with room for the tuple, INVALID_PAGE_ID if there is none
+   */
+  auto FindPage(uint32_t size, size_t *position) const -> page_id_t;
+
+  /** @return the free space recorded for a page, rounded down to a unit, 0 if the page is not in the map */
+  auto GetFreeSpace(page_id_t table_page_id) const -> uint32_t;
+
+  /** @return true if a page of the table is in the map */
+  auto Contains(page_id_t table_page_id) const -> bool;
+
+  /** @return the number of pages in the map */
+  auto GetNumPages() const -> size_t;
+
+  /** @return the last page added, INVALID_PAGE_ID if there is none */
+  auto GetLastPageId() const -> page_id_t;
+
+  /** @return the first page of the map */
+  auto GetFirstPageId() const -> page_id_t;
+
+ private:
+  static constexpr size_t NPOS = SIZE_MAX;
+
+  /** @return free space in units, rounded down */
+  auto ToUnits(uint32_t free_space) const -> uint8_t;
+
+  /** Set the free space of the page at position in the tree, growing it as needed. Caller holds latch_. */
+  void SetUnits(size_t position, uint8_t units);
+
+  /** An entry of the map, copied out of it to write to its map page. */
+  struct Entry {
+    page_id_t map_page_id_;
+    size_t index_;
+    page_id_t table_page_id_;
+    uint8_t units_;
+  };
+
+  /** @return the entry of the page at position. Caller holds latch_. */
+  auto GetEntry(size_t position) const -> Entry;
+
+  /** Write an entry to its map page. Caller does not hold latch_, which would wait on the buffer pool. */
+  void WriteEntry(const Entry &entry);
+
+  /** @return the first leaf of the subtree of node, covering [low, high), at or after from with at least units */
+  auto FindLeaf(size_t node, size_t low, size_t high, size_t from, uint8_t units) const -> size_t;
+
+  BufferPoolManager *bpm_;
+  /** The bytes of a unit of free space. */
+  uint32_t unit_;
+  /** Protects everything below. Never held while fetching or latching a page. */
+  mutable std::mutex latch_;
+  /** The pages of the map, in chain order. */
+  std::vector<page_id_t> map_page_ids_;
+  /** The number of entries a page of the map holds. */
+  size_t entries_per_page_{0};
+  /** The pages of the table, in the order they were added. */
+  std::vector<page_id_t> table_page_ids_;
+  /** The position of each page of the table. */
+  std::unordered_map<page_id_t, size_t> positions_;
+  /** tree_[1] is the maximum free space of all pages, node i has children 2i and 2i+1, leaf i is node num_leaves_+i. */
+  std::vector<uint8_t> tree_;
+  size_t num_leaves_{0};
+};
+
+}  // namespace bustub
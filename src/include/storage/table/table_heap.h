@@ -12,9 +12,13 @@
 
 #pragma once
 
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -22,7 +26,7 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages, and a free space map that inserts use to find a page with room.
  */
 class TableHeap {
   friend class TableIterator;
@@ -31,7 +35,8 @@ class TableHeap {
   ~TableHeap() = default;
 
   /**
-   * Create a table heap without a transaction. (open table)
+   * Create a table heap without a transaction. (open table) Its free space map is loaded, or built by reading every
+   * page of the table if it has none.
    * @param buffer_pool_manager the buffer pool manager
    * @param lock_manager the lock manager
    * @param log_manager the log manager
@@ -52,6 +57,10 @@ class TableHeap {
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   *
+   * The tuple goes to a page the free space map says has room, or to a new page at the end of the table if none has.
+   * Each thread starts looking at its own position in the map and skips the pages other inserters have latched, so
+   * that concurrent inserts fill different pages rather than queue on the same one.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -59,6 +68,18 @@ class TableHeap {
    */
   auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
 
+  /**
+   * Insert a batch of tuples into the table. If any tuple is too large (>= page_size), none is inserted.
+   *
+   * Each page is latched once and filled with as many of the tuples, in order, as it takes, and the pages the tuples
+   * that are left need are appended together, so a batch costs a fetch and a latch per page rather than per tuple.
+   * @param tuples the tuples to insert
+   * @param[out] rids the rids of the inserted tuples, in the order of tuples
+   * @param txn the transaction performing the insert
+   * @return true iff every tuple is inserted, the transaction is aborted otherwise
+   */
+  auto InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) -> bool;
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
@@ -95,12 +116,19 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param acquire_read_lock whether to read latch the page
+   * @param hint what the page is fetched for
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true,
+                AccessHint hint = AccessHint::NORMAL) -> bool;
 
-  /** @return the begin iterator of this table */
-  auto Begin(Transaction *txn) -> TableIterator;
+  /**
+   * @param txn transaction performing the scan
+   * @param hint what the pages are fetched for, SEQUENTIAL_SCAN keeps a full scan from flushing the buffer pool
+   * @return the begin iterator of this table
+   */
+  auto Begin(Transaction *txn, AccessHint hint = AccessHint::NORMAL) -> TableIterator;
 
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
@@ -108,11 +136,71 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the free space map of this table */
+  inline auto GetFreeSpaceMap() const -> const FreeSpaceMap & { return free_space_map_; }
+
  private:
+  /**
+   * Find and write latch a page the free space map says has room for a tuple, skipping those other inserters have
+   * latched. The search starts at position and wraps around once, to the page before start.
+   * @param size the size of the tuple
+   * @param start the position the search began at
+   * @param[in,out] position the position to continue the search at, set to that of the page found
+   * @param[in,out] wrapped true once the search has wrapped around
+   * @return the page, write latched and pinned, nullptr if there is none
+   */
+  auto FindPageWithRoom(uint32_t size, size_t start, size_t *position, bool *wrapped) -> TablePage *;
+
+  /**
+   * Insert a tuple into a write latched page, and record the free space it leaves. The page is unlatched and unpinned.
+   * @param is_dirty true if the page was modified before
+   * @return true if the tuple fit
+   */
+  auto InsertIntoPage(TablePage *page, const Tuple &tuple, RID *rid, Transaction *txn, bool is_dirty) -> bool;
+
+  /**
+   * Insert tuples into a write latched page from *next on, until one does not fit, and record the free space they
+   * leave. The page is unlatched and unpinned.
+   * @param[in,out] next the index of the first tuple to insert, set to that of the first one not inserted
+   * @param is_dirty true if the page was modified before
+   */
+  void FillPage(TablePage *page, const std::vector<Tuple> &tuples, size_t *next, std::vector<RID> *rids,
+                Transaction *txn, bool is_dirty);
+
+  /**
+   * Add pages at the end of the table and to the free space map.
+   * @param num_pages the number of pages to add, at most MAX_APPEND_PAGES
+   * @return the new pages in table order, write latched and pinned, fewer if the buffer pool runs out of frames
+   */
+  auto AppendPages(Transaction *txn, size_t num_pages) -> std::vector<TablePage *>;
+
+  /**
+   * Load the free space map of the table, creating it if the table has none, and add the pages of the table it
+   * misses: all of them for a new map, and those appended when the map had no room.
+   */
+  void LoadFreeSpaceMap();
+
+  /**
+   * Tell the read-ahead prefetcher of the buffer pool, if there is one, that a scan has reached page.
+   * @param page the read latched page the scan is on
+   * @param hint what the scan fetches its pages for
+   */
+  void ReadAhead(TablePage *page, AccessHint hint);
+
+  /** @return the next link of a read latched table page */
+  static auto NextPageId(Page *page) -> page_id_t;
+
+  /** The most pages a batch insert appends at once, and so holds pinned. */
+  static constexpr size_t MAX_APPEND_PAGES = 16;
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  FreeSpaceMap free_space_map_;
+  /** Serializes appending pages, so that each new page is linked after the last one. */
+  std::mutex append_latch_;
+  page_id_t last_page_id_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
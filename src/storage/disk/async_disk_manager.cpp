@@ -0,0 +1,317 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define BUSTUB_HAS_IO_URING
+#endif
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef BUSTUB_HAS_IO_URING
+namespace {
+
+// There is no liburing dependency, the two system calls are all we need.
+auto IoUringSetup(unsigned entries, io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+#endif
+
+AsyncDiskManager::AsyncDiskManager(const std::string &db_file, size_t queue_depth, bool use_io_uring,
+                                   bool direct_io, PageChecksumMode checksum_mode)
+    : DiskManager(db_file, direct_io, checksum_mode), queue_depth_(std::max<size_t>(queue_depth, 1)) {
+  if (use_io_uring && SetUpIoUring()) {
+    return;
+  }
+  const size_t num_workers = std::min<size_t>(ASYNC_IO_THREADS, queue_depth_);
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back([this] { RunWorker(); });
+  }
+}
+
+AsyncDiskManager::~AsyncDiskManager() { Stop(); }
+
+void AsyncDiskManager::ShutDown() {
+  Stop();
+  DiskManager::ShutDown();
+}
+
+void AsyncDiskManager::SubmitBatch(std::vector<DiskRequest> *requests) {
+  // Stamped before the latch is taken, since it may sync. A write that falls back to WritePage() restamps the same.
+  for (const auto &request : *requests) {
+    if (request.is_write_) {
+      StampChecksum(request.page_id_, request.data_);
+    }
+  }
+  std::unique_lock<std::mutex> lock(latch_);
+  if (stopped_) {
+    lock.unlock();
+    DiskManager::SubmitBatch(requests);
+    return;
+  }
+  if (ring_fd_ >= 0) {
+    SubmitToRing(requests, &lock);
+    return;
+  }
+
+  for (auto &request : *requests) {
+    completed_cv_.wait(lock, [this] { return num_in_flight_ < queue_depth_; });
+    queue_.push_back(new InFlightRequest{std::move(request), {}});
+    num_in_flight_++;
+    queued_cv_.notify_one();
+  }
+}
+
+auto AsyncDiskManager::SetUpIoUring() -> bool {
+#ifdef BUSTUB_HAS_IO_URING
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  const int ring_fd = IoUringSetup(static_cast<unsigned>(queue_depth_), &params);
+  if (ring_fd < 0) {
+    LOG_DEBUG("io_uring is unavailable (%s), using a thread pool", std::strerror(errno));
+    return false;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  auto map = [ring_fd](size_t size, off_t offset) -> void * {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  };
+  sq_ring_ = map(sq_ring_size_, IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap ? sq_ring_ : map(cq_ring_size_, IORING_OFF_CQ_RING);
+  sqes_ = map(sqes_size_, IORING_OFF_SQES);
+  if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr) {
+    LOG_DEBUG("cannot map the io_uring rings, using a thread pool");
+    UnmapRings();
+    close(ring_fd);
+    return false;
+  }
+
+  auto *sq_ring = static_cast<char *>(sq_ring_);
+  auto *cq_ring = static_cast<char *>(cq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = cq_ring + params.cq_off.cqes;
+  ring_fd_ = ring_fd;
+  reaper_ = std::thread([this] { ReapCompletions(); });
+  return true;
+#else
+  return false;
+#endif
+}
+
+void AsyncDiskManager::UnmapRings() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  sqes_ = cq_ring_ = sq_ring_ = nullptr;
+}
+
+void AsyncDiskManager::QueueSqe(InFlightRequest *in_flight) {
+#ifdef BUSTUB_HAS_IO_URING
+  // The ring never holds more submissions than requests in flight, so there is always a free entry.
+  const unsigned tail = *sq_tail_;
+  const unsigned index = tail & *sq_mask_;
+  io_uring_sqe *sqe = &static_cast<io_uring_sqe *>(sqes_)[index];
+  std::memset(sqe, 0, sizeof(*sqe));
+  if (in_flight == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+  } else {
+    char *data = in_flight->request_.data_;
+    if (direct_io_ && reinterpret_cast<uintptr_t>(data) % BUSTUB_PAGE_SIZE != 0) {
+      in_flight->aligned_data_.reset(static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE)));
+      if (in_flight->request_.is_write_) {
+        std::memcpy(in_flight->aligned_data_.get(), data, BUSTUB_PAGE_SIZE);
+      }
+      data = in_flight->aligned_data_.get();
+    }
+    in_flight->iov_.iov_base = data;
+    in_flight->iov_.iov_len = BUSTUB_PAGE_SIZE;
+    sqe->opcode = in_flight->request_.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = db_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&in_flight->iov_);
+    sqe->len = 1;
+    sqe->off = static_cast<uint64_t>(in_flight->request_.page_id_) * BUSTUB_PAGE_SIZE;
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(in_flight);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  num_unentered_++;
+#endif
+}
+
+void AsyncDiskManager::SubmitToRing(std::vector<DiskRequest> *requests, std::unique_lock<std::mutex> *lock) {
+  for (auto &request : *requests) {
+    if (num_in_flight_ == queue_depth_) {
+      EnterSubmissions();
+      completed_cv_.wait(*lock, [this] { return num_in_flight_ < queue_depth_; });
+    }
+    QueueSqe(new InFlightRequest{std::move(request), {}});
+    num_in_flight_++;
+  }
+  EnterSubmissions();
+}
+
+void AsyncDiskManager::EnterSubmissions() {
+#ifdef BUSTUB_HAS_IO_URING
+  while (num_unentered_ > 0) {
+    const int num_entered = IoUringEnter(ring_fd_, num_unentered_, 0, 0);
+    if (num_entered < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        std::this_thread::yield();
+        continue;
+      }
+      throw Exception("can't submit to io_uring");
+    }
+    num_unentered_ -= static_cast<unsigned>(num_entered);
+  }
+#endif
+}
+
+void AsyncDiskManager::ReapCompletions() {
+#ifdef BUSTUB_HAS_IO_URING
+  const auto *cqes = static_cast<const io_uring_cqe *>(cqes_);
+  while (true) {
+    if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+      LOG_DEBUG("I/O error while waiting for io_uring completions");
+    }
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    bool stop = false;
+    for (; head != tail; head++) {
+      const io_uring_cqe &cqe = cqes[head & *cq_mask_];
+      auto *in_flight = reinterpret_cast<InFlightRequest *>(cqe.user_data);
+      if (in_flight == nullptr) {
+        stop = true;
+      } else {
+        Complete(in_flight, cqe.res);
+      }
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    if (stop) {
+      return;
+    }
+  }
+#endif
+}
+
+void AsyncDiskManager::RunWorker() {
+  while (true) {
+    InFlightRequest *in_flight;
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      queued_cv_.wait(lock, [this] { return stopped_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      in_flight = queue_.front();
+      queue_.pop_front();
+    }
+    const DiskRequest &request = in_flight->request_;
+    const ssize_t result = PageIO(request.is_write_, request.page_id_, request.data_);
+    Complete(in_flight, result < 0 ? -errno : result);
+  }
+}
+
+void AsyncDiskManager::Complete(InFlightRequest *in_flight, ssize_t result) {
+  DiskRequest &request = in_flight->request_;
+  (request.is_write_ ? write_latency_ : read_latency_).RecordSince(in_flight->submitted_);
+  if (result < 0) {
+    LOG_DEBUG("I/O error on page %d: %s", request.page_id_, std::strerror(static_cast<int>(-result)));
+    request.callback_.set_value(false);
+  } else {
+    if (request.is_write_) {
+      num_writes_ += 1;
+    } else if (in_flight->aligned_data_ != nullptr) {
+      std::memcpy(request.data_, in_flight->aligned_data_.get(), result);
+    }
+    if (!request.is_write_ && result < BUSTUB_PAGE_SIZE) {
+      // Reading past the end of the file.
+      std::memset(request.data_ + result, 0, BUSTUB_PAGE_SIZE - result);
+    }
+    const PageStatus status = request.is_write_ ? PageStatus::OK : VerifyPage(request.page_id_, request.data_);
+    request.callback_.set_value(status != PageStatus::CORRUPT && status != PageStatus::TORN);
+  }
+  delete in_flight;
+
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    num_in_flight_--;
+  }
+  completed_cv_.notify_all();
+}
+
+void AsyncDiskManager::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    if (stopped_) {
+      return;
+    }
+    completed_cv_.wait(lock, [this] { return num_in_flight_ == 0; });
+    stopped_ = true;
+    if (ring_fd_ >= 0) {
+      QueueSqe(nullptr);
+      EnterSubmissions();
+    }
+  }
+  queued_cv_.notify_all();
+  if (reaper_.joinable()) {
+    reaper_.join();
+  }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  if (ring_fd_ >= 0) {
+    UnmapRings();
+    close(ring_fd_);
+    ring_fd_ = -1;
+  }
+}
+
+}  // namespace bustub
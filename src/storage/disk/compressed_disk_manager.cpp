@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_disk_manager.cpp
+//
+// Identification: src/storage/disk/compressed_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/compressed_disk_manager.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/lz4.h"
+
+namespace bustub {
+
+CompressedDiskManager::CompressedDiskManager(const std::string &db_file, PageChecksumMode checksum_mode)
+    : DiskManager(db_file, false, checksum_mode) {
+  std::string::size_type n = file_name_.rfind('.');
+  if (n == std::string::npos) {
+    return;
+  }
+  map_name_ = file_name_.substr(0, n) + ".map";
+  map_fd_ = open(map_name_.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+  if (map_fd_ < 0) {
+    DiskManager::ShutDown();
+    throw Exception("can't open page map file");
+  }
+  const int size = GetFileSize(map_name_);
+  page_map_.resize(std::max(size, 0) / sizeof(PageLocation));
+  if (!page_map_.empty() && pread(map_fd_, page_map_.data(), page_map_.size() * sizeof(PageLocation), 0) < 0) {
+    LOG_WARN("I/O error while reading %s, the database is empty", map_name_.c_str());
+    page_map_.clear();
+  }
+  for (auto &location : page_map_) {
+    if (location.size_ > BUSTUB_PAGE_SIZE) {
+      LOG_WARN("invalid entry in %s, the page reads as zeros", map_name_.c_str());
+      location = PageLocation{};
+    }
+  }
+  RebuildFreeSlots();
+}
+
+void CompressedDiskManager::ShutDown() {
+  if (map_fd_ >= 0) {
+    close(map_fd_);
+    map_fd_ = -1;
+  }
+  DiskManager::ShutDown();
+}
+
+void CompressedDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  const auto start = std::chrono::steady_clock::now();
+  const ssize_t bytes_read = PageIO(false, page_id, page_data);
+  read_latency_.RecordSince(start);
+  if (bytes_read < BUSTUB_PAGE_SIZE) {
+    if (bytes_read < 0) {
+      LOG_WARN("can't read page %d of %s: %s", page_id, file_name_.c_str(), strerror(errno));
+    }
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+  }
+  VerifyPage(page_id, page_data);
+}
+
+auto CompressedDiskManager::PageIO(bool is_write, page_id_t page_id, char *data) -> ssize_t {
+  if (page_id < 0) {
+    errno = EINVAL;
+    return -1;
+  }
+  const auto index = static_cast<size_t>(page_id);
+  thread_local char compressed[BUSTUB_PAGE_SIZE];
+
+  if (!is_write) {
+    PageLocation location{};
+    {
+      std::scoped_lock lock(map_latch_);
+      if (index < page_map_.size()) {
+        location = page_map_[index];
+      }
+    }
+    if (location.size_ == 0) {
+      return 0;
+    }
+    const off_t offset = static_cast<off_t>(location.first_slot_) * SLOT_SIZE;
+    if (location.size_ == BUSTUB_PAGE_SIZE) {
+      const ssize_t bytes_read = pread(db_fd_, data, BUSTUB_PAGE_SIZE, offset);
+      bytes_read_ += std::max<ssize_t>(bytes_read, 0);
+      return bytes_read;
+    }
+    const ssize_t bytes_read = pread(db_fd_, compressed, location.size_, offset);
+    bytes_read_ += std::max<ssize_t>(bytes_read, 0);
+    if (bytes_read != static_cast<ssize_t>(location.size_)) {
+      if (bytes_read >= 0) {
+        errno = EIO;  // the file was cut short
+      }
+      return -1;
+    }
+    if (!Lz4::Decompress(compressed, location.size_, data, BUSTUB_PAGE_SIZE)) {
+      errno = EIO;
+      return -1;
+    }
+    return BUSTUB_PAGE_SIZE;
+  }
+
+  // Keep the compressed page only if it saves a slot, and pad it to its slots so no stale bytes follow it.
+  size_t size = Lz4::Compress(data, BUSTUB_PAGE_SIZE, compressed, BUSTUB_PAGE_SIZE - SLOT_SIZE);
+  const char *image = compressed;
+  if (size == 0) {
+    size = BUSTUB_PAGE_SIZE;
+    image = data;
+  }
+  const size_t num_slots = SlotsOf(size);
+  if (image == compressed) {
+    memset(compressed + size, 0, num_slots * SLOT_SIZE - size);
+  }
+  PageLocation location;
+  PageLocation old;
+  {
+    std::scoped_lock lock(map_latch_);
+    if (index >= page_map_.size()) {
+      page_map_.resize(index + 1, PageLocation{});
+    }
+    old = page_map_[index];
+    if (old.size_ != 0 && SlotsOf(old.size_) == num_slots) {
+      location.first_slot_ = old.first_slot_;
+      old = PageLocation{};  // nothing to release
+    } else {
+      location.first_slot_ = AllocateSlots(num_slots);
+    }
+    location.size_ = static_cast<uint32_t>(size);
+    page_map_[index] = location;
+  }
+
+  // The page is written before its map entry, so the entry never points at slots that do not hold the page yet.
+  const ssize_t bytes_written =
+      pwrite(db_fd_, image, num_slots * SLOT_SIZE, static_cast<off_t>(location.first_slot_) * SLOT_SIZE);
+  if (bytes_written != static_cast<ssize_t>(num_slots * SLOT_SIZE)) {
+    return -1;
+  }
+  bytes_written_ += bytes_written;
+  if (pwrite(map_fd_, &location, sizeof(location), static_cast<off_t>(index * sizeof(PageLocation))) !=
+      sizeof(location)) {
+    return -1;
+  }
+  // The old slots are released only now: until the new entry is persisted, the map file still points at them and no
+  // other page may overwrite them. On the error paths above they stay allocated until the map is reloaded.
+  if (old.size_ != 0) {
+    std::scoped_lock lock(map_latch_);
+    FreeSlots(old.first_slot_, SlotsOf(old.size_));
+  }
+  return BUSTUB_PAGE_SIZE;
+}
+
+auto CompressedDiskManager::GetNumPages() const -> page_id_t {
+  std::scoped_lock lock(map_latch_);
+  return static_cast<page_id_t>(page_map_.size());
+}
+
+auto CompressedDiskManager::GetFileBytes() const -> size_t {
+  std::scoped_lock lock(map_latch_);
+  return static_cast<size_t>(num_slots_) * SLOT_SIZE;
+}
+
+auto CompressedDiskManager::AllocateSlots(size_t num_slots) -> uint32_t {
+  for (size_t length = num_slots; length <= SLOTS_PER_PAGE; length++) {
+    if (free_runs_[length].empty()) {
+      continue;
+    }
+    const uint32_t first_slot = free_runs_[length].back();
+    free_runs_[length].pop_back();
+    if (length > num_slots) {
+      free_runs_[length - num_slots].push_back(first_slot + num_slots);
+    }
+    return first_slot;
+  }
+  const uint32_t first_slot = num_slots_;
+  num_slots_ += num_slots;
+  return first_slot;
+}
+
+void CompressedDiskManager::FreeSlots(uint32_t first_slot, size_t num_slots) {
+  free_runs_[num_slots].push_back(first_slot);
+}
+
+void CompressedDiskManager::RebuildFreeSlots() {
+  std::vector<std::pair<uint32_t, uint32_t>> runs;
+  for (const auto &location : page_map_) {
+    if (location.size_ != 0) {
+      runs.emplace_back(location.first_slot_, location.first_slot_ + SlotsOf(location.size_));
+    }
+  }
+  std::sort(runs.begin(), runs.end());
+  uint32_t end = 0;
+  for (const auto &[first_slot, last_slot] : runs) {
+    for (uint32_t slot = end; slot < first_slot;) {
+      const auto length = std::min<uint32_t>(first_slot - slot, SLOTS_PER_PAGE);
+      FreeSlots(slot, length);
+      slot += length;
+    }
+    end = std::max(end, last_slot);
+  }
+  num_slots_ = end;
+}
+
+}  // namespace bustub
@@ -11,18 +11,25 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <algorithm>
 #include <cassert>
+#include <chrono>  // NOLINT
+#include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
 
+#include "common/crc32c.h"
 #include "common/exception.h"
 #include "common/logger.h"
 #include "storage/disk/disk_manager.h"
 #include <unistd.h>
 #include <fcntl.h>
+#include <climits>
 
 namespace bustub {
 
@@ -32,7 +39,8 @@ static char *buffer_used;
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io, PageChecksumMode checksum_mode)
+    : file_name_(db_file), direct_io_(direct_io), checksum_mode_(checksum_mode) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -47,12 +55,36 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   }
 
   // Open db file using file descriptor
-  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+#ifdef O_DIRECT
+  if (direct_io_) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, S_IRUSR | S_IWUSR);
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_WARN("%s does not support O_DIRECT, using buffered I/O", db_file.c_str());
+      direct_io_ = false;
+    }
+  }
+#else
+  direct_io_ = false;
+#endif
+  if (!direct_io_) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+  }
   if (db_fd_ < 0) {
     close(log_fd_);
     throw Exception("can't open db file");
   }
 
+  if (checksum_mode_ != PageChecksumMode::NONE) {
+    checksum_name_ = file_name_.substr(0, n) + ".crc";
+    checksum_fd_ = open(checksum_name_.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (checksum_fd_ < 0) {
+      close(db_fd_);
+      close(log_fd_);
+      throw Exception("can't open checksum file");
+    }
+    OpenChecksumFile();
+  }
+
   buffer_used = nullptr;
 }
 
@@ -65,6 +97,10 @@ void DiskManager::ShutDown() {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     close(db_fd_);  // Close the db file descriptor
   }
+  if (checksum_fd_ >= 0) {
+    close(checksum_fd_);
+    checksum_fd_ = -1;
+  }
   close(log_fd_);  // Close the log file descriptor
 }
 
@@ -72,10 +108,10 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-
-  ssize_t bytes_written = pwrite(db_fd_, page_data, BUSTUB_PAGE_SIZE, offset);
+  StampChecksum(page_id, page_data);
+  const auto start = std::chrono::steady_clock::now();
+  ssize_t bytes_written = PageIO(true, page_id, const_cast<char *>(page_data));  // NOLINT
+  write_latency_.RecordSince(start);
   if (bytes_written == -1) {
     LOG_DEBUG("I/O error while writing with pwrite");
     return;
@@ -88,14 +124,19 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
   int offset = page_id * BUSTUB_PAGE_SIZE;
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error reading past end of file");
+    if (checksum_mode_ != PageChecksumMode::NONE) {
+      // The file may have been cut short, as a page with checksums has been written.
+      memset(page_data, 0, BUSTUB_PAGE_SIZE);
+      VerifyPage(page_id, page_data);
+    }
   } else {
-
-    ssize_t bytes_read = pread(db_fd_, page_data, BUSTUB_PAGE_SIZE, offset);
+    const auto start = std::chrono::steady_clock::now();
+    ssize_t bytes_read = PageIO(false, page_id, page_data);
+    read_latency_.RecordSince(start);
     if (bytes_read == -1) {
       LOG_DEBUG("I/O error while reading with pread");
       return;
@@ -106,6 +147,238 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
       LOG_DEBUG("Read less than a page");
       memset(page_data + bytes_read, 0, BUSTUB_PAGE_SIZE - bytes_read);
     }
+    VerifyPage(page_id, page_data);
+  }
+}
+
+void DiskManager::ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) {
+  std::vector<iovec> iov;
+  for (size_t done = 0; done < pages.size();) {
+    const size_t num_pages = std::min<size_t>(pages.size() - done, IOV_MAX);
+    iov.clear();
+    for (size_t i = 0; i < num_pages; i++) {
+      iov.push_back(iovec{pages[done + i], BUSTUB_PAGE_SIZE});
+    }
+    const auto aligned = std::all_of(iov.begin(), iov.end(), [](const iovec &v) {
+      return reinterpret_cast<uintptr_t>(v.iov_base) % BUSTUB_PAGE_SIZE == 0;
+    });
+    const off_t offset = (static_cast<off_t>(first_page_id) + static_cast<off_t>(done)) * BUSTUB_PAGE_SIZE;
+    ssize_t bytes_read = 0;
+    if (!direct_io_ || aligned) {
+      const auto start = std::chrono::steady_clock::now();
+      bytes_read = preadv(db_fd_, iov.data(), static_cast<int>(num_pages), offset);
+      read_latency_.RecordSince(start);
+    }
+    // The pages a short read, or an unaligned buffer under O_DIRECT, left out are read one by one.
+    const size_t pages_read = bytes_read > 0 ? static_cast<size_t>(bytes_read) / BUSTUB_PAGE_SIZE : 0;
+    for (size_t i = 0; i < pages_read; i++) {
+      VerifyPage(static_cast<page_id_t>(first_page_id + done + i), pages[done + i]);
+    }
+    for (size_t i = pages_read; i < num_pages; i++) {
+      const auto page_id = static_cast<page_id_t>(first_page_id + done + i);
+      memset(pages[done + i], 0, BUSTUB_PAGE_SIZE);
+      if (page_id * BUSTUB_PAGE_SIZE < GetFileSize(file_name_)) {
+        ReadPage(page_id, pages[done + i]);
+      }
+    }
+    done += num_pages;
+  }
+}
+
+auto DiskManager::PageIO(bool is_write, page_id_t page_id, char *data) -> ssize_t {
+  const off_t offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  if (!direct_io_ || reinterpret_cast<uintptr_t>(data) % BUSTUB_PAGE_SIZE == 0) {
+    return is_write ? pwrite(db_fd_, data, BUSTUB_PAGE_SIZE, offset) : pread(db_fd_, data, BUSTUB_PAGE_SIZE, offset);
+  }
+  // O_DIRECT wants the buffer aligned to the logical block size, which a page-aligned buffer always is.
+  alignas(BUSTUB_PAGE_SIZE) thread_local char aligned[BUSTUB_PAGE_SIZE];
+  if (is_write) {
+    memcpy(aligned, data, BUSTUB_PAGE_SIZE);
+    return pwrite(db_fd_, aligned, BUSTUB_PAGE_SIZE, offset);
+  }
+  ssize_t bytes_read = pread(db_fd_, aligned, BUSTUB_PAGE_SIZE, offset);
+  if (bytes_read > 0) {
+    memcpy(data, aligned, bytes_read);
+  }
+  return bytes_read;
+}
+
+void DiskManager::OpenChecksumFile() {
+  ChecksumFileHeader header{CHECKSUM_FILE_MAGIC, 0, 0};
+  struct stat db_stat;
+  if (fstat(db_fd_, &db_stat) == 0) {
+    header.device_ = static_cast<uint64_t>(db_stat.st_dev);
+    header.inode_ = static_cast<uint64_t>(db_stat.st_ino);
+  }
+  // An empty database file has no pages to verify, even if an inode was reused for it.
+  const int size = GetFileSize(checksum_name_);
+  ChecksumFileHeader stored{};
+  if (size >= static_cast<int>(CHECKSUM_FILE_HEADER_SIZE) && GetFileSize(file_name_) > 0 &&
+      pread(checksum_fd_, &stored, sizeof(stored), 0) == sizeof(stored) && stored.magic_ == header.magic_ &&
+      stored.device_ == header.device_ && stored.inode_ == header.inode_) {
+    checksums_.resize((size - CHECKSUM_FILE_HEADER_SIZE) / sizeof(PageChecksum));
+    if (!checksums_.empty() && pread(checksum_fd_, checksums_.data(), checksums_.size() * sizeof(PageChecksum),
+                                     CHECKSUM_FILE_HEADER_SIZE) < 0) {
+      LOG_WARN("I/O error while reading %s, pages are not verified", checksum_name_.c_str());
+      checksums_.clear();
+    }
+  } else {
+    if (size > 0) {
+      LOG_WARN("%s does not hold the checksums of %s, discarding it", checksum_name_.c_str(), file_name_.c_str());
+    }
+    if (ftruncate(checksum_fd_, 0) != 0 || pwrite(checksum_fd_, &header, sizeof(header), 0) != sizeof(header)) {
+      LOG_WARN("I/O error while writing %s", checksum_name_.c_str());
+    }
+  }
+  verified_.resize(checksums_.size(), false);
+}
+
+void DiskManager::StampChecksum(page_id_t page_id, const char *page_data) {
+  if (checksum_mode_ == PageChecksumMode::NONE) {
+    return;
+  }
+  PageChecksum checksum;
+  checksum.current_ = ComputeChecksum(page_data);
+  {
+    std::scoped_lock lock(checksum_latch_);
+    const auto index = static_cast<size_t>(page_id);
+    if (index >= checksums_.size()) {
+      checksums_.resize(index + 1, PageChecksum{});
+      verified_.resize(index + 1, false);
+    }
+    const PageChecksum &old = checksums_[index];
+    if (old.current_ == checksum.current_) {
+      checksum.previous_ = old.previous_;
+    } else if (old.current_ == PageChecksum{}.current_) {
+      static const auto ZERO_PAGE_CHECKSUM = ComputeChecksum(std::string(BUSTUB_PAGE_SIZE, '\0').data());
+      checksum.previous_ = ZERO_PAGE_CHECKSUM;
+    } else {
+      checksum.previous_ = old.current_;
+    }
+    checksums_[index] = checksum;
+    verified_[index] = true;
+  }
+
+  const off_t offset = CHECKSUM_FILE_HEADER_SIZE + static_cast<off_t>(page_id) * sizeof(PageChecksum);
+  if (pwrite(checksum_fd_, &checksum, sizeof(checksum), offset) != sizeof(checksum)) {
+    LOG_WARN("I/O error while writing the checksums of page %d", page_id);
+    return;
+  }
+  if (checksum_mode_ == PageChecksumMode::DETECT_TORN_WRITES) {
+    fdatasync(checksum_fd_);
+  }
+}
+
+auto DiskManager::ComputeChecksum(const char *page_data) -> std::array<uint32_t, SECTORS_PER_PAGE> {
+  std::array<uint32_t, SECTORS_PER_PAGE> crcs;
+  Crc32c::ComputeBlocks(page_data, SECTOR_SIZE, SECTORS_PER_PAGE, crcs.data());
+  return crcs;
+}
+
+auto DiskManager::ClassifyPage(const PageChecksum &checksum, const char *page_data) -> PageStatus {
+  const auto crcs = ComputeChecksum(page_data);
+  if (crcs == checksum.current_) {
+    return PageStatus::OK;
+  }
+  for (size_t i = 0; i < SECTORS_PER_PAGE; i++) {
+    if (crcs[i] != checksum.current_[i] && crcs[i] != checksum.previous_[i]) {
+      return PageStatus::CORRUPT;
+    }
+  }
+  return PageStatus::TORN;
+}
+
+auto DiskManager::GetChecksum(page_id_t page_id, PageChecksum *checksum, bool mark_verified) -> bool {
+  std::scoped_lock lock(checksum_latch_);
+  const auto index = static_cast<size_t>(page_id);
+  if (index >= checksums_.size() || checksums_[index].current_ == PageChecksum{}.current_) {
+    return false;
+  }
+  *checksum = checksums_[index];
+  if (mark_verified) {
+    verified_[index] = true;
+  }
+  return true;
+}
+
+auto DiskManager::VerifyPage(page_id_t page_id, const char *page_data) -> PageStatus {
+  PageChecksum checksum;
+  if (checksum_mode_ == PageChecksumMode::NONE || !GetChecksum(page_id, &checksum, true)) {
+    return PageStatus::UNCHECKED;
+  }
+  const PageStatus status = ClassifyPage(checksum, page_data);
+  ReportBadPage(page_id, status);
+  return status;
+}
+
+auto DiskManager::ScrubPage(page_id_t page_id) -> PageStatus {
+  if (checksum_mode_ == PageChecksumMode::NONE) {
+    return PageStatus::UNCHECKED;
+  }
+  {
+    std::scoped_lock lock(checksum_latch_);
+    const auto index = static_cast<size_t>(page_id);
+    if (index < verified_.size() && verified_[index]) {
+      verified_[index] = false;
+      return PageStatus::OK;
+    }
+  }
+
+  PageChecksum before;
+  if (!GetChecksum(page_id, &before, false)) {
+    return PageStatus::UNCHECKED;
+  }
+  alignas(BUSTUB_PAGE_SIZE) thread_local char page_data[BUSTUB_PAGE_SIZE];
+  const ssize_t bytes_read = PageIO(false, page_id, page_data);
+  memset(page_data + std::max<ssize_t>(bytes_read, 0), 0, BUSTUB_PAGE_SIZE - std::max<ssize_t>(bytes_read, 0));
+  PageChecksum after;
+  if (!GetChecksum(page_id, &after, false) || after.current_ != before.current_) {
+    return PageStatus::OK;  // written meanwhile, so not cold
+  }
+  const PageStatus status = ClassifyPage(after, page_data);
+  ReportBadPage(page_id, status);
+  return status;
+}
+
+void DiskManager::ReportBadPage(page_id_t page_id, PageStatus status) {
+  if (status == PageStatus::CORRUPT) {
+    LOG_WARN("page %d of %s does not match its checksums", page_id, file_name_.c_str());
+    num_corrupt_pages_++;
+  } else if (status == PageStatus::TORN) {
+    LOG_WARN("page %d of %s is torn, its last write did not complete", page_id, file_name_.c_str());
+    num_torn_pages_++;
+  }
+}
+
+auto DiskManager::GetNumPages() const -> page_id_t {
+  const int size = GetFileSize(file_name_);
+  return size <= 0 ? 0 : static_cast<page_id_t>((size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE);
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> {
+  std::vector<DiskRequest> requests;
+  requests.push_back(DiskRequest{false, page_data, page_id, {}});
+  auto future = requests[0].callback_.get_future();
+  SubmitBatch(&requests);
+  return future;
+}
+
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool> {
+  std::vector<DiskRequest> requests;
+  requests.push_back(DiskRequest{true, const_cast<char *>(page_data), page_id, {}});  // NOLINT
+  auto future = requests[0].callback_.get_future();
+  SubmitBatch(&requests);
+  return future;
+}
+
+void DiskManager::SubmitBatch(std::vector<DiskRequest> *requests) {
+  for (auto &request : *requests) {
+    if (request.is_write_) {
+      WritePage(request.page_id_, request.data_);
+    } else {
+      ReadPage(request.page_id_, request.data_);
+    }
+    request.callback_.set_value(true);
   }
 }
 
@@ -175,7 +448,7 @@ auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-auto DiskManager::GetFileSize(const std::string &file_name) -> int {
+auto DiskManager::GetFileSize(const std::string &file_name) const -> int {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
   return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.cpp
+//
+// Identification: src/storage/disk/mmap_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/mmap_disk_manager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+MmapDiskManager::MmapDiskManager(const std::string &db_file) {
+  file_name_ = db_file;
+  log_fd_ = -1;
+  db_fd_ = open(db_file.c_str(), O_RDONLY);
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0) {
+    close(db_fd_);
+    throw Exception("can't stat db file");
+  }
+  // A torn last page is left out, it reads as zeros like any page past the end.
+  size_ = static_cast<size_t>(stat_buf.st_size) / BUSTUB_PAGE_SIZE * BUSTUB_PAGE_SIZE;
+  if (size_ == 0) {
+    return;  // mmap() refuses empty mappings
+  }
+  void *data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (data == MAP_FAILED) {
+    close(db_fd_);
+    throw Exception("can't map db file");
+  }
+  data_ = static_cast<char *>(data);
+}
+
+MmapDiskManager::~MmapDiskManager() { Unmap(); }
+
+void MmapDiskManager::ShutDown() { Unmap(); }
+
+void MmapDiskManager::Unmap() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+  }
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+}
+
+void MmapDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  const char *data = GetPageData(page_id);
+  const bool unchanged = data != nullptr ? std::memcmp(data, page_data, BUSTUB_PAGE_SIZE) == 0
+                                         : std::all_of(page_data, page_data + BUSTUB_PAGE_SIZE,
+                                                       [](char byte) { return byte == 0; });
+  if (!unchanged) {
+    throw Exception(fmt::format("can't write page {} to the read-only db file {}", page_id, file_name_));
+  }
+}
+
+void MmapDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  const char *data = GetPageData(page_id);
+  if (data == nullptr) {
+    std::memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  std::memcpy(page_data, data, BUSTUB_PAGE_SIZE);
+}
+
+auto MmapDiskManager::GetPageData(page_id_t page_id) const -> const char * {
+  if (data_ == nullptr || page_id < 0 || page_id >= GetNumPages()) {
+    return nullptr;
+  }
+  return data_ + static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+}
+
+}  // namespace bustub
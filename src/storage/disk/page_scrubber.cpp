@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_scrubber.cpp
+//
+// Identification: src/storage/disk/page_scrubber.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_scrubber.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+
+namespace bustub {
+
+PageScrubber::PageScrubber(DiskManager *disk_manager, size_t pages_per_second)
+    : disk_manager_(disk_manager),
+      pages_per_second_(std::max<size_t>(pages_per_second, 1)),
+      worker_([this] { Run(); }) {}
+
+PageScrubber::~PageScrubber() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+auto PageScrubber::GetBadPages() -> std::vector<page_id_t> {
+  std::scoped_lock lock(latch_);
+  return bad_pages_;
+}
+
+void PageScrubber::Run() {
+  const auto period = std::chrono::nanoseconds(std::chrono::seconds(1)) / static_cast<int64_t>(pages_per_second_);
+  auto next = std::chrono::steady_clock::now();
+  page_id_t page_id = 0;
+  while (true) {
+    {
+      std::unique_lock lock(latch_);
+      cv_.wait_until(lock, next, [this] { return stop_; });
+      if (stop_) {
+        return;
+      }
+    }
+    // A scrubber that fell behind does not catch up in a burst.
+    next = std::max(next + period, std::chrono::steady_clock::now());
+
+    if (page_id >= disk_manager_->GetNumPages()) {
+      if (page_id > 0) {
+        num_passes_++;
+      }
+      page_id = 0;
+      continue;
+    }
+    const PageStatus status = disk_manager_->ScrubPage(page_id);
+    if (status == PageStatus::CORRUPT || status == PageStatus::TORN) {
+      std::scoped_lock lock(latch_);
+      if (std::find(bad_pages_.begin(), bad_pages_.end(), page_id) == bad_pages_.end()) {
+        bad_pages_.push_back(page_id);
+      }
+    }
+    num_scrubbed_++;
+    page_id++;
+  }
+}
+
+}  // namespace bustub
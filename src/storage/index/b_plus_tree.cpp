@@ -32,36 +32,126 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_P
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  // std::cout << "进入getvalue  " << key << std::endl;
-  if (IsEmpty()) {
-    return false;
-  }
-
-  Page *page = FindLeafCN(key, transaction, READ);
+  Page *page = FindLeafOptimistic(key, Seek::KEY);
   if (page == nullptr) {
     return false;
   }
   auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
 
   int index = leaf_page->KeyIndex(key, comparator_);
-  if (index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
+  const bool found = index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0;
+  if (found) {
     result->push_back(leaf_page->ValueAt(index));
-    if (transaction) {
-      UnlockAndUnpinPages(transaction, READ);
-    } else {
-      page->RUnlatch();
-      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*
+ * Optimistic lock coupling: descend without latching the internal pages, reading each at a version and validating
+ * the version once the child is pinned, so that readers do not all take the root latch. A page that a writer latched
+ * in the meantime may have been read half changed, so the descent restarts from the root. Only the leaf is latched,
+ * read latched for a READ and write latched otherwise, and checked to be unchanged since the parent pointed to it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key, Seek seek, Operation op) -> Page * {
+  for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++) {
+    const page_id_t root_page_id = root_page_id_;
+    if (root_page_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(root_page_id);
+    if (page == nullptr) {
+      return nullptr;
+    }
+    uint64_t version = page->ReadVersion();
+    bool valid = root_page_id_ == root_page_id;
+    while (valid) {
+      auto node = reinterpret_cast<InternalPage *>(page->GetData());
+      if (node->IsLeafPage()) {
+        if (op == READ) {
+          page->RLatch();
+          if (page->ValidateVersion(version)) {
+            return page;
+          }
+          page->RUnlatch();
+          break;
+        }
+        // Taking the write latch bumps the version once.
+        page->WLatch();
+        if (page->ValidateVersion(version + 1)) {
+          return page;
+        }
+        page->WUnlatch();
+        break;
+      }
+      // A size a writer left half changed can be anything, don't search past the page with it.
+      const int size = node->GetSize();
+      if (size < 1 || size > internal_max_size_) {
+        break;
+      }
+      page_id_t child_page_id;
+      if (seek == Seek::KEY) {
+        child_page_id = node->Find(key, comparator_);
+      } else {
+        child_page_id = node->ValueAt(seek == Seek::FIRST ? 0 : size - 1);
+      }
+      if (!page->ValidateVersion(version)) {
+        break;
+      }
+      Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+      if (child_page == nullptr) {
+        break;
+      }
+      const uint64_t child_version = child_page->ReadVersion();
+      // Still the child of the page, not merged away or split off since.
+      valid = page->ValidateVersion(version);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = child_page;
+      version = child_version;
     }
-    return true;
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
   }
-  if (transaction) {
-    UnlockAndUnpinPages(transaction, READ);
-  } else {
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+  return op == READ ? FindLeafPessimistic(key, seek) : nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPessimistic(const KeyType &key, Seek seek) -> Page * {
+  Page *curr_page;
+  while (true) {
+    const page_id_t root_page_id = root_page_id_;
+    if (root_page_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    curr_page = buffer_pool_manager_->FetchPage(root_page_id);
+    if (curr_page == nullptr) {
+      return nullptr;
+    }
+    curr_page->RLatch();
+    if (root_page_id_ == root_page_id) {
+      break;
+    }
+    curr_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(root_page_id, false);
   }
+  auto curr_inter_node = reinterpret_cast<InternalPage *>(curr_page->GetData());
+  while (!curr_inter_node->IsLeafPage()) {
+    page_id_t next_page_id;
+    if (seek == Seek::KEY) {
+      next_page_id = curr_inter_node->Find(key, comparator_);
+    } else {
+      next_page_id = curr_inter_node->ValueAt(seek == Seek::FIRST ? 0 : curr_inter_node->GetSize() - 1);
+    }
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    next_page->RLatch();
+    curr_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
 
-  return false;
+    curr_page = next_page;
+    curr_inter_node = reinterpret_cast<InternalPage *>(curr_page->GetData());
+  }
+  return curr_page;
 }
 
 /*****************************************************************************
@@ -159,6 +249,10 @@ auto BPLUSTREE_TYPE::FindLeafCN(const KeyType &key, Transaction *transaction, Op
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
   // std::cout << "Inserting " << key << std::endl;
+  bool inserted;
+  if (InsertOptimistic(key, value, &inserted)) {
+    return inserted;
+  }
   Page *page = FindLeafCN(key, transaction, INSERT);
 
   while (page == nullptr) {
@@ -205,6 +299,30 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   return true;
 }
 
+/*
+ * Most inserts don't split the leaf, so first latch only the leaf, found optimistically, and leave the pages above it
+ * to other writers. Only a leaf that could split sends the insert back to crabbing down with write latches.
+ * @return false if the insert has to crab down, otherwise true, with whether the key was inserted in inserted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertOptimistic(const KeyType &key, const ValueType &value, bool *inserted) -> bool {
+  Page *page = FindLeafOptimistic(key, Seek::KEY, INSERT);
+  if (page == nullptr) {
+    return false;
+  }
+  auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  if (!IsSafe(page, INSERT)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  int index = leaf_page->KeyIndex(key, comparator_);
+  *inserted = leaf_page->Insert(std::make_pair(key, value), index, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), *inserted);
+  return true;
+}
+
 /*
  * Custom method to insert the middle key to parent
  */
@@ -281,7 +399,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(Page *leaf, const KeyType &key, Page *chil
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-  if (IsEmpty()) {
+  if (IsEmpty() || RemoveOptimistic(key)) {
     return;
   }
   Page *page = FindLeafCN(key, transaction, DELETE);
@@ -292,6 +410,31 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   UnlockAndUnpinPages(transaction, DELETE);
 }
 
+/*
+ * Remove from the leaf alone, found optimistically, if it keeps enough entries not to merge or borrow, or the root
+ * leaf some not to empty the tree.
+ * @return false if the remove has to crab down with write latches, otherwise true
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveOptimistic(const KeyType &key) -> bool {
+  Page *page = FindLeafOptimistic(key, Seek::KEY, DELETE);
+  if (page == nullptr) {
+    return false;
+  }
+  auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  const bool safe =
+      leaf_page->IsRootPage() ? leaf_page->GetSize() > 1 : leaf_page->GetSize() > leaf_page->GetMinSize();
+  if (!safe) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  const bool removed = leaf_page->Delete(key, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+  return true;
+}
+
 /*
  * Custom method to delete the entry from the leaf page (concurrent)
  */
@@ -717,23 +860,10 @@ bool BPLUSTREE_TYPE::IsSafe(Page *page, Operation op) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  if (IsEmpty()) {
+  Page *curr_page = FindLeafOptimistic(KeyType{}, Seek::FIRST);
+  if (curr_page == nullptr) {
     return INDEXITERATOR_TYPE();
   }
-  Page *curr_page = buffer_pool_manager_->FetchPage(root_page_id_);
-  curr_page->RLatch();
-  auto curr_inter_node = reinterpret_cast<InternalPage *>(curr_page->GetData());
-  while (!curr_inter_node->IsLeafPage()) {
-    Page *next_page = buffer_pool_manager_->FetchPage(curr_inter_node->ValueAt(0));
-    next_page->RLatch();
-    auto next_inter_node = reinterpret_cast<InternalPage *>(next_page->GetData());
-    curr_page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
-
-    curr_page = next_page;
-    curr_inter_node = next_inter_node;
-  }
-
   return INDEXITERATOR_TYPE(curr_page, curr_page->GetPageId(), 0, buffer_pool_manager_);
 }
 
@@ -744,21 +874,15 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  if (IsEmpty()) {
+  auto leaf_page = FindLeafOptimistic(key, Seek::KEY);
+  if (leaf_page == nullptr) {
     return INDEXITERATOR_TYPE();
   }
-  auto leaf_page = FindLeafCN(key, nullptr, READ);
   auto leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
 
-  int index = 0;
-  for (; index < leaf_node->GetSize(); index++) {
-    if (comparator_(leaf_node->KeyAt(index), key) == 0) {
-      break;
-    }
-  }
-  // return end, just like <iterator>
-  if (index == leaf_node->GetSize()) {
-    leaf_page->WUnlatch();
+  int index = leaf_node->KeyIndex(key, comparator_);
+  if (index == leaf_node->GetSize() || comparator_(leaf_node->KeyAt(index), key) != 0) {
+    leaf_page->RUnlatch();
     buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
     return End();
   }
@@ -772,29 +896,18 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
-  if (IsEmpty()) {
+  Page *curr_page = FindLeafOptimistic(KeyType{}, Seek::LAST);
+  if (curr_page == nullptr) {
     return INDEXITERATOR_TYPE();
   }
-  Page *curr_page = buffer_pool_manager_->FetchPage(root_page_id_);
-  curr_page->RLatch();
-  auto curr_inter_node = reinterpret_cast<InternalPage *>(curr_page->GetData());
-  while (!curr_inter_node->IsLeafPage()) {
-    Page *next_page = buffer_pool_manager_->FetchPage(curr_inter_node->ValueAt(curr_inter_node->GetSize() - 1));
-    next_page->RLatch();
-    auto next_inter_node = reinterpret_cast<InternalPage *>(next_page->GetData());
-    curr_page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
-
-    curr_page = next_page;
-    curr_inter_node = next_inter_node;
-  }
   auto curr_node = reinterpret_cast<LeafPage *>(curr_page->GetData());
 
   page_id_t page_id = curr_page->GetPageId();
+  const int size = curr_node->GetSize();
   curr_page->RUnlatch();
   buffer_pool_manager_->UnpinPage(page_id, false);
 
-  return INDEXITERATOR_TYPE(curr_page, page_id, curr_node->GetSize(), buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(curr_page, page_id, size, buffer_pool_manager_);
 }
 
 /**
@@ -3,6 +3,7 @@
  */
 #include <cassert>
 
+#include "buffer/read_ahead_prefetcher.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -46,6 +47,11 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
     curr_page_ = next_page;
     page_id_ = curr_page_->GetPageId();
     index_ = 0;
+    if (auto *prefetcher = buffer_pool_manager_->GetPrefetcher(); prefetcher != nullptr) {
+      auto next_leaf_node = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(curr_page_->GetData());
+      prefetcher->ScanAt(page_id_, next_leaf_node->GetNextPageId(), &INDEXITERATOR_TYPE::NextLeafPageId,
+                         AccessHint::NORMAL);
+    }
   } else /* at the end but no next */ {
     if (index_ == curr_leaf_node->GetSize() && curr_leaf_node->GetNextPageId() == INVALID_PAGE_ID) {
       curr_page_->RUnlatch();
@@ -56,6 +62,11 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::NextLeafPageId(Page *page) -> page_id_t {
+  return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData())->GetNextPageId();
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
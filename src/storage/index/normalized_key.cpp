@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.cpp
+//
+// Identification: src/storage/index/normalized_key.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/normalized_key.h"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the bytes a column of type takes encoded, 0 if it varies or the type is not encoded */
+auto FixedSize(TypeId type) -> size_t {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return sizeof(int8_t);
+    case TypeId::SMALLINT:
+      return sizeof(int16_t);
+    case TypeId::INTEGER:
+      return sizeof(int32_t);
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+    case TypeId::TIMESTAMP:
+      return sizeof(int64_t);
+    default:
+      return 0;
+  }
+}
+
+/** Write the low size bytes of bits big-endian to out. */
+void PutBigEndian(uint64_t bits, size_t size, char *out) {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = static_cast<char>(bits >> (8 * (size - 1 - i)));
+  }
+}
+
+/** @return the signed integer of size bytes at data, with the sign bit flipped */
+template <typename IntType>
+auto FlipSign(const char *data) -> uint64_t {
+  IntType value;
+  memcpy(&value, data, sizeof(IntType));
+  const auto bits = static_cast<std::make_unsigned_t<IntType>>(value);
+  return static_cast<uint64_t>(bits) ^ (uint64_t{1} << (8 * sizeof(IntType) - 1));
+}
+
+}  // namespace
+
+auto NormalizedKey::GetMaxSize(const Schema &key_schema) -> size_t {
+  size_t size = 0;
+  for (const auto &column : key_schema.GetColumns()) {
+    if (column.GetType() == TypeId::VARCHAR) {
+      // The NULL byte, every byte escaped, and the terminator.
+      size += 1 + 2 * static_cast<size_t>(column.GetLength()) + 2;
+    } else if (FixedSize(column.GetType()) != 0) {
+      size += FixedSize(column.GetType());
+    } else {
+      return 0;
+    }
+  }
+  return size;
+}
+
+auto NormalizedKey::IsEncoded(const Schema &key_schema, size_t key_size) -> bool {
+  if (key_schema.GetColumnCount() == 1 && key_schema.GetColumn(0).GetType() != TypeId::VARCHAR) {
+    return false;
+  }
+  const size_t max_size = GetMaxSize(key_schema);
+  return max_size != 0 && max_size <= key_size;
+}
+
+void NormalizedKey::Encode(const Tuple &key, const Schema &key_schema, char *data, size_t size) {
+  BUSTUB_ASSERT(IsEncoded(key_schema, size), "keys of this schema are not encoded");
+  memset(data, 0, size);
+  char *out = data;
+  for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+    const auto &column = key_schema.GetColumn(i);
+    const char *value = key.GetData() + column.GetOffset();
+    switch (column.GetType()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        PutBigEndian(FlipSign<int8_t>(value), sizeof(int8_t), out);
+        break;
+      case TypeId::SMALLINT:
+        PutBigEndian(FlipSign<int16_t>(value), sizeof(int16_t), out);
+        break;
+      case TypeId::INTEGER:
+        PutBigEndian(FlipSign<int32_t>(value), sizeof(int32_t), out);
+        break;
+      case TypeId::BIGINT:
+        PutBigEndian(FlipSign<int64_t>(value), sizeof(int64_t), out);
+        break;
+      case TypeId::DECIMAL: {
+        double number;
+        memcpy(&number, value, sizeof(double));
+        // -0.0 equals 0.0, so it encodes as that.
+        number = number == 0 ? 0 : number;
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(double));
+        const uint64_t sign = uint64_t{1} << 63;
+        PutBigEndian((bits & sign) != 0 ? ~bits : bits ^ sign, sizeof(double), out);
+        break;
+      }
+      case TypeId::TIMESTAMP: {
+        uint64_t timestamp;
+        memcpy(&timestamp, value, sizeof(uint64_t));
+        PutBigEndian(timestamp + 1, sizeof(uint64_t), out);
+        break;
+      }
+      default: {
+        const Value varchar = key.GetValue(&key_schema, i);
+        if (varchar.IsNull()) {
+          *out++ = 0;
+          continue;
+        }
+        *out++ = 1;
+        // A VARCHAR Value counts the terminating '\0', which comparisons leave out. One longer than its column is
+        // cut short to the room GetMaxSize() leaves it.
+        const uint32_t length = varchar.GetLength() == 0 ? 0 : varchar.GetLength() - 1;
+        const char *bytes = varchar.GetData();
+        const char *limit = out + 2 * static_cast<size_t>(column.GetLength());
+        for (uint32_t j = 0; j < length && out + 2 <= limit; j++) {
+          *out++ = bytes[j];
+          if (bytes[j] == 0) {
+            *out++ = static_cast<char>(0xFF);
+          }
+        }
+        // The terminator, which the padding already is.
+        out += 2;
+        continue;
+      }
+    }
+    out += FixedSize(column.GetType());
+  }
+}
+
+}  // namespace bustub
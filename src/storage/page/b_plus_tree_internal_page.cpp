@@ -13,6 +13,7 @@
 #include <sstream>
 
 #include "common/exception.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -55,16 +56,14 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &valu
 }
 
 /*
- * Custom method to find value inside
+ * Custom method to find value inside: the child of the last key not greater than key, by binary search
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Find(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
-  for (int i = 1; i < GetSize(); i++) {
-    if (comparator(array_[i].first, key) > 0) {
-      return array_[i - 1].second;
-    }
+  if (GetSize() <= 1) {
+    return array_[0].second;
   }
-  return array_[GetSize() - 1].second;
+  return array_[KeyBound<true>(&array_[1].first, sizeof(MappingType), GetSize() - 1, key, comparator)].second;
 }
 
 /*
@@ -101,25 +100,15 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Delete(const KeyType &key, const KeyCompara
 }
 
 /*
- * Custom method to find the index of the key
+ * Custom method to find the index of the key: that of the first key not less than it, by binary search
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) -> int {
   // binary search
-  int l = 1;
-  int r = GetSize();
-  if (l >= r) {
+  if (GetSize() <= 1) {
     return GetSize();
   }
-  while (l < r) {
-    int mid = (l + r) / 2;
-    if (comparator(array_[mid].first, key) < 0) {
-      l = mid + 1;
-    } else {
-      r = mid;
-    }
-  }
-  return l;
+  return 1 + KeyBound<false>(&array_[1].first, sizeof(MappingType), GetSize() - 1, key, comparator);
 }
 
 /*
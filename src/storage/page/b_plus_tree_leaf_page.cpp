@@ -13,6 +13,7 @@
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -114,24 +115,11 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Delete(const KeyType &key, const KeyComparator
 }
 
 /*
- * Custom method to find the index of the key
+ * Custom method to find the index of the key: that of the first key not less than it, by binary search
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) -> int {
-  int l = 0;
-  int r = GetSize();
-  if (l >= r) {
-    return GetSize();
-  }
-  while (l < r) {
-    int mid = (l + r) / 2;
-    if (comparator(array_[mid].first, key) < 0) {
-      l = mid + 1;
-    } else {
-      r = mid;
-    }
-  }
-  return l;
+  return KeyBound<false>(&array_[0].first, sizeof(MappingType), GetSize(), key, comparator);
 }
 
 /*
@@ -0,0 +1,231 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/logger.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *bpm)
+    : bpm_(bpm), unit_(static_cast<uint32_t>(bpm->GetPageSize() / 256)) {}
+
+auto FreeSpaceMap::Create() -> page_id_t {
+  page_id_t page_id;
+  auto *page = static_cast<FreeSpaceMapPage *>(bpm_->NewPage(&page_id));
+  if (page == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  page->Init(page_id);
+  const size_t capacity = page->GetCapacity();
+  bpm_->UnpinPage(page_id, true);
+  std::scoped_lock lock(latch_);
+  entries_per_page_ = capacity;
+  map_page_ids_.push_back(page_id);
+  return page_id;
+}
+
+void FreeSpaceMap::Load(page_id_t first_page_id) {
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *page = static_cast<FreeSpaceMapPage *>(bpm_->FetchPage(page_id));
+    if (page == nullptr) {
+      LOG_WARN("can't read free space map page %d, the rest of the map is lost", page_id);
+      return;
+    }
+    page->RLatch();
+    std::vector<std::pair<page_id_t, uint8_t>> entries;
+    for (size_t i = 0; i < page->GetNumEntries(); i++) {
+      entries.emplace_back(page->GetTablePageId(i), page->GetFreeSpace(i));
+    }
+    const size_t capacity = page->GetCapacity();
+    const page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    bpm_->UnpinPage(page_id, false);
+    {
+      std::scoped_lock lock(latch_);
+      entries_per_page_ = capacity;
+      for (const auto &[table_page_id, units] : entries) {
+        positions_.emplace(table_page_id, table_page_ids_.size());
+        SetUnits(table_page_ids_.size(), units);
+        table_page_ids_.push_back(table_page_id);
+      }
+      map_page_ids_.push_back(page_id);
+    }
+    page_id = next_page_id;
+  }
+}
+
+auto FreeSpaceMap::AddPage(page_id_t table_page_id, uint32_t free_space) -> bool {
+  size_t position;
+  page_id_t last_map_page_id = INVALID_PAGE_ID;
+  {
+    std::scoped_lock lock(latch_);
+    if (map_page_ids_.empty()) {
+      return false;
+    }
+    position = table_page_ids_.size();
+    if (position == map_page_ids_.size() * entries_per_page_) {
+      last_map_page_id = map_page_ids_.back();
+    }
+  }
+  if (last_map_page_id != INVALID_PAGE_ID) {
+    // The last page of the map is full, chain a new one.
+    page_id_t page_id;
+    auto *page = static_cast<FreeSpaceMapPage *>(bpm_->NewPage(&page_id));
+    if (page == nullptr) {
+      return false;
+    }
+    page->Init(page_id);
+    bpm_->UnpinPage(page_id, true);
+    auto *last_page = static_cast<FreeSpaceMapPage *>(bpm_->FetchPage(last_map_page_id));
+    if (last_page == nullptr) {
+      bpm_->DeletePage(page_id);
+      return false;
+    }
+    last_page->WLatch();
+    last_page->SetNextPageId(page_id);
+    last_page->WUnlatch();
+    bpm_->UnpinPage(last_map_page_id, true);
+    std::scoped_lock lock(latch_);
+    map_page_ids_.push_back(page_id);
+  }
+  Entry entry{};
+  {
+    std::scoped_lock lock(latch_);
+    table_page_ids_.push_back(table_page_id);
+    positions_.emplace(table_page_id, position);
+    SetUnits(position, ToUnits(free_space));
+    entry = GetEntry(position);
+  }
+  WriteEntry(entry);
+  return true;
+}
+
+void FreeSpaceMap::UpdatePage(page_id_t table_page_id, uint32_t free_space) {
+  Entry entry{};
+  {
+    std::scoped_lock lock(latch_);
+    const auto iter = positions_.find(table_page_id);
+    if (iter == positions_.end()) {
+      return;
+    }
+    const uint8_t units = ToUnits(free_space);
+    if (tree_[num_leaves_ + iter->second] == units) {
+      return;
+    }
+    SetUnits(iter->second, units);
+    entry = GetEntry(iter->second);
+  }
+  WriteEntry(entry);
+}
+
+auto FreeSpaceMap::FindPage(uint32_t size, size_t *position) const -> page_id_t {
+  // Round up, so that a page with that many units, rounded down, has the room.
+  const uint32_t units = (size + unit_ - 1) / unit_;
+  std::scoped_lock lock(latch_);
+  if (units > UINT8_MAX || *position >= table_page_ids_.size()) {
+    return INVALID_PAGE_ID;
+  }
+  const size_t leaf = FindLeaf(1, 0, num_leaves_, *position, static_cast<uint8_t>(std::max<uint32_t>(units, 1)));
+  if (leaf == NPOS) {
+    return INVALID_PAGE_ID;
+  }
+  *position = leaf;
+  return table_page_ids_[leaf];
+}
+
+auto FreeSpaceMap::GetFreeSpace(page_id_t table_page_id) const -> uint32_t {
+  std::scoped_lock lock(latch_);
+  const auto iter = positions_.find(table_page_id);
+  return iter == positions_.end() ? 0 : tree_[num_leaves_ + iter->second] * unit_;
+}
+
+auto FreeSpaceMap::Contains(page_id_t table_page_id) const -> bool {
+  std::scoped_lock lock(latch_);
+  return positions_.count(table_page_id) != 0;
+}
+
+auto FreeSpaceMap::GetNumPages() const -> size_t {
+  std::scoped_lock lock(latch_);
+  return table_page_ids_.size();
+}
+
+auto FreeSpaceMap::GetLastPageId() const -> page_id_t {
+  std::scoped_lock lock(latch_);
+  return table_page_ids_.empty() ? INVALID_PAGE_ID : table_page_ids_.back();
+}
+
+auto FreeSpaceMap::GetFirstPageId() const -> page_id_t {
+  std::scoped_lock lock(latch_);
+  return map_page_ids_.empty() ? INVALID_PAGE_ID : map_page_ids_.front();
+}
+
+auto FreeSpaceMap::ToUnits(uint32_t free_space) const -> uint8_t {
+  return static_cast<uint8_t>(std::min<uint32_t>(free_space / unit_, UINT8_MAX));
+}
+
+void FreeSpaceMap::SetUnits(size_t position, uint8_t units) {
+  if (position >= num_leaves_) {
+    // Double the leaves, and rebuild the inner nodes above them.
+    const size_t num_leaves = std::max<size_t>(num_leaves_ * 2, 64);
+    std::vector<uint8_t> tree(2 * num_leaves, 0);
+    std::copy(tree_.begin() + num_leaves_, tree_.end(), tree.begin() + num_leaves);
+    for (size_t node = num_leaves - 1; node > 0; node--) {
+      tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+    }
+    tree_ = std::move(tree);
+    num_leaves_ = num_leaves;
+  }
+  size_t node = num_leaves_ + position;
+  tree_[node] = units;
+  for (node /= 2; node > 0; node /= 2) {
+    tree_[node] = std::max(tree_[2 * node], tree_[2 * node + 1]);
+  }
+}
+
+auto FreeSpaceMap::GetEntry(size_t position) const -> Entry {
+  return {map_page_ids_[position / entries_per_page_], position % entries_per_page_, table_page_ids_[position],
+          tree_[num_leaves_ + position]};
+}
+
+void FreeSpaceMap::WriteEntry(const Entry &entry) {
+  auto *page = static_cast<FreeSpaceMapPage *>(bpm_->FetchPage(entry.map_page_id_));
+  if (page == nullptr) {
+    // The map in memory is still right, the page is only stale until the entry changes again.
+    return;
+  }
+  page->WLatch();
+  page->SetEntry(entry.index_, entry.table_page_id_, entry.units_);
+  if (entry.index_ >= page->GetNumEntries()) {
+    page->SetNumEntries(static_cast<uint32_t>(entry.index_ + 1));
+  }
+  page->WUnlatch();
+  bpm_->UnpinPage(entry.map_page_id_, true);
+}
+
+auto FreeSpaceMap::FindLeaf(size_t node, size_t low, size_t high, size_t from, uint8_t units) const -> size_t {
+  if (high <= from || tree_[node] < units) {
+    return NPOS;
+  }
+  if (high - low == 1) {
+    return low;
+  }
+  const size_t middle = (low + high) / 2;
+  const size_t leaf = FindLeaf(2 * node, low, middle, from, units);
+  return leaf != NPOS ? leaf : FindLeaf(2 * node + 1, middle, high, from, units);
+}
+
+}  // namespace bustub
@@ -10,8 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <thread>  // NOLINT
 
+#include "buffer/read_ahead_prefetcher.h"
 #include "common/logger.h"
 #include "fmt/format.h"
 #include "storage/table/table_heap.h"
@@ -23,74 +27,232 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      free_space_map_(buffer_pool_manager) {
+  LoadFreeSpaceMap();
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      free_space_map_(buffer_pool_manager) {
   // Initialize the first table page.
   auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
-  first_page->Init(first_page_id_, BUSTUB_PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  first_page->Init(first_page_id_, static_cast<uint32_t>(buffer_pool_manager_->GetPageSize()), INVALID_LSN,
+                   log_manager_, txn);
+  first_page->SetFreeSpaceMapPageId(free_space_map_.Create());
+  free_space_map_.AddPage(first_page_id_, first_page->GetMaxInsertSize());
+  last_page_id_ = first_page_id_;
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
-  if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) {  // larger than one page size
+  if (tuple.size_ > TablePage::MaxTupleSize(static_cast<uint32_t>(buffer_pool_manager_->GetPageSize()))) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  // Try the pages the free space map says have room, from a position of each thread's own.
+  const size_t num_pages = free_space_map_.GetNumPages();
+  const size_t start = num_pages == 0 ? 0 : std::hash<std::thread::id>{}(std::this_thread::get_id()) % num_pages;
+  size_t position = start;
+  bool wrapped = false;
+  for (TablePage *cur_page; (cur_page = FindPageWithRoom(tuple.size_, start, &position, &wrapped)) != nullptr;) {
+    if (InsertIntoPage(cur_page, tuple, rid, txn, false)) {
+      // Update the transaction's write set.
+      txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+      return true;
+    }
+    // The map was stale, InsertIntoPage() has corrected it.
+    position++;
+  }
+
+  // No page has room, or the pages that have are all being inserted into: add one.
+  auto new_pages = AppendPages(txn, 1);
+  if (new_pages.empty() || !InsertIntoPage(new_pages[0], tuple, rid, txn, true)) {
+    // Then life sucks and we abort the transaction.
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  return true;
+}
 
-  cur_page->WLatch();
-
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      next_page->WLatch();
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+auto TableHeap::InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) -> bool {
+  for (const auto &tuple : tuples) {
+    if (tuple.size_ > TablePage::MaxTupleSize(static_cast<uint32_t>(buffer_pool_manager_->GetPageSize()))) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+  }
+  rids->clear();
+  rids->reserve(tuples.size());
+
+  // Fill the pages the free space map says have room, as InsertTuple() looks for one.
+  const size_t num_pages = free_space_map_.GetNumPages();
+  const size_t start = num_pages == 0 ? 0 : std::hash<std::thread::id>{}(std::this_thread::get_id()) % num_pages;
+  size_t position = start;
+  bool wrapped = false;
+  size_t next = 0;
+  for (TablePage *cur_page;
+       next < tuples.size() && (cur_page = FindPageWithRoom(tuples[next].size_, start, &position, &wrapped)) != nullptr;
+       position++) {
+    FillPage(cur_page, tuples, &next, rids, txn, false);
+  }
+
+  // Append the pages the rest of the tuples take, each with its slot, in one go.
+  while (next < tuples.size()) {
+    size_t bytes = 0;
+    for (size_t i = next; i < tuples.size(); i++) {
+      bytes += tuples[i].size_ + 2 * sizeof(uint32_t);
+    }
+    const size_t page_bytes =
+        TablePage::MaxTupleSize(static_cast<uint32_t>(buffer_pool_manager_->GetPageSize())) + 2 * sizeof(uint32_t);
+    auto new_pages = AppendPages(txn, std::min((bytes + page_bytes - 1) / page_bytes, MAX_APPEND_PAGES));
+    if (new_pages.empty()) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    // An empty page that takes no tuple would be followed by more of them forever, so give up instead.
+    bool stuck = false;
+    for (auto new_page : new_pages) {
+      const size_t filled = next;
+      FillPage(new_page, tuples, &next, rids, txn, true);
+      stuck = stuck || (next == filled && next < tuples.size());
+    }
+    if (stuck) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
     }
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
+auto TableHeap::FindPageWithRoom(uint32_t size, size_t start, size_t *position, bool *wrapped) -> TablePage * {
+  while (true) {
+    const page_id_t page_id = free_space_map_.FindPage(size, position);
+    if (page_id == INVALID_PAGE_ID || (*wrapped && *position >= start)) {
+      if (*wrapped || start == 0) {
+        return nullptr;
+      }
+      *wrapped = true;
+      *position = 0;
+      continue;
+    }
+    auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (cur_page == nullptr) {
+      // No frame for it: leave the tuple to a new page, which fails too if the buffer pool is still full.
+      return nullptr;
+    }
+    // Rather than wait for another inserter to be done with this page, try the next one.
+    if (!cur_page->TryWLatch()) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      (*position)++;
+      continue;
+    }
+    return cur_page;
+  }
+}
+
+auto TableHeap::InsertIntoPage(TablePage *page, const Tuple &tuple, RID *rid, Transaction *txn, bool is_dirty)
+    -> bool {
+  const bool inserted = page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+  free_space_map_.UpdatePage(page->GetTablePageId(), page->GetMaxInsertSize());
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), inserted || is_dirty);
+  return inserted;
+}
+
+void TableHeap::FillPage(TablePage *page, const std::vector<Tuple> &tuples, size_t *next, std::vector<RID> *rids,
+                         Transaction *txn, bool is_dirty) {
+  RID rid;
+  for (; *next < tuples.size() && page->InsertTuple(tuples[*next], &rid, txn, lock_manager_, log_manager_); (*next)++) {
+    rids->push_back(rid);
+    // Update the transaction's write set.
+    txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
+    is_dirty = true;
+  }
+  free_space_map_.UpdatePage(page->GetTablePageId(), page->GetMaxInsertSize());
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_dirty);
+}
+
+auto TableHeap::AppendPages(Transaction *txn, size_t num_pages) -> std::vector<TablePage *> {
+  std::vector<TablePage *> new_pages;
+  std::scoped_lock lock(append_latch_);
+  const page_id_t last_page_id = last_page_id_;
+  auto last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
+  if (last_page == nullptr) {
+    return new_pages;
+  }
+  last_page->WLatch();
+  TablePage *prev_page = last_page;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t new_page_id;
+    auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&new_page_id));
+    if (new_page == nullptr) {
+      break;
+    }
+    new_page->WLatch();
+    new_page->Init(new_page_id, static_cast<uint32_t>(buffer_pool_manager_->GetPageSize()), last_page_id_,
+                   log_manager_, txn);
+    // The previous page is latched, either the last page of the table or a new page of this call.
+    prev_page->SetNextPageId(new_page_id);
+    last_page_id_ = new_page_id;
+    if (!free_space_map_.AddPage(new_page_id, new_page->GetMaxInsertSize())) {
+      LOG_WARN("no frame for the free space map, page %d is only filled by this insert", new_page_id);
+    }
+    new_pages.push_back(new_page);
+    prev_page = new_page;
+  }
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id, !new_pages.empty());
+  return new_pages;
+}
+
+void TableHeap::LoadFreeSpaceMap() {
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  if (first_page == nullptr) {
+    LOG_WARN("can't read the first page of table heap %d", first_page_id_);
+    return;
+  }
+  first_page->WLatch();
+  page_id_t page_id = first_page_id_;
+  bool is_dirty = false;
+  if (first_page->GetFreeSpaceMapPageId() != INVALID_PAGE_ID) {
+    free_space_map_.Load(first_page->GetFreeSpaceMapPageId());
+    page_id = free_space_map_.GetLastPageId();
+  } else {
+    first_page->SetFreeSpaceMapPageId(free_space_map_.Create());
+    is_dirty = true;
+  }
+  first_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, is_dirty);
+
+  // Add the pages the map misses, which follow the last page it has.
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      LOG_WARN("can't read page %d of table heap %d", page_id, first_page_id_);
+      return;
+    }
+    page->RLatch();
+    if (!free_space_map_.Contains(page_id)) {
+      free_space_map_.AddPage(page_id, page->GetMaxInsertSize());
+    }
+    const page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    last_page_id_ = page_id;
+    page_id = next_page_id;
+  }
+}
+
 auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
@@ -122,6 +284,7 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   Tuple old_tuple;
   page->WLatch();
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  free_space_map_.UpdatePage(page->GetTablePageId(), page->GetMaxInsertSize());
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
   // Update the transaction's write set.
@@ -138,6 +301,7 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Delete the tuple from the page.
   page->WLatch();
   page->ApplyDelete(rid, txn, log_manager_);
+  free_space_map_.UpdatePage(page->GetTablePageId(), page->GetMaxInsertSize());
   /** Commented out to make compatible with p4; This is called only on commit or delete, which consequently unlocks the
    * tuple; so should be fine */
   // lock_manager_->Unlock(txn, rid);
@@ -156,9 +320,10 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
-auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock) -> bool {
+auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock, AccessHint hint)
+    -> bool {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId(), hint));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -176,26 +341,37 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool ac
   return res;
 }
 
-auto TableHeap::Begin(Transaction *txn) -> TableIterator {
+auto TableHeap::Begin(Transaction *txn, AccessHint hint) -> TableIterator {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, hint));
     page->RLatch();
+    ReadAhead(page, hint);
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto next_page_id = page->GetNextPageId();
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = next_page_id;
   }
-  return {this, rid, txn};
+  return {this, rid, txn, hint};
 }
 
 auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0), nullptr}; }
 
+void TableHeap::ReadAhead(TablePage *page, AccessHint hint) {
+  auto *prefetcher = buffer_pool_manager_->GetPrefetcher();
+  if (prefetcher != nullptr) {
+    prefetcher->ScanAt(page->GetTablePageId(), page->GetNextPageId(), &TableHeap::NextPageId, hint);
+  }
+}
+
+auto TableHeap::NextPageId(Page *page) -> page_id_t { return static_cast<TablePage *>(page)->GetNextPageId(); }
+
 }  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// background_writer_test.cpp
+//
+// Identification: test/buffer/background_writer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "buffer/background_writer.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+TEST(BackgroundWriterTest, CleanTest) {
+  const size_t num_instances = 2;
+  const size_t pool_size_per_instance = 8;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, pool_size_per_instance, disk_manager.get());
+
+  for (size_t i = 0; i < num_instances * pool_size_per_instance; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: the writer cleans half the frames of every instance, and leaves the rest dirty.
+  BackgroundWriter writer(bpm.get(), pool_size_per_instance, std::chrono::milliseconds(10));
+  writer.Wake();
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (writer.GetNumWritten() < pool_size_per_instance && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(pool_size_per_instance, writer.GetNumWritten());
+
+  // Scenario: once enough frames are clean, later rounds write nothing.
+  size_t num_rounds = writer.GetNumRounds();
+  while (writer.GetNumRounds() < num_rounds + 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(pool_size_per_instance, writer.GetNumWritten());
+
+  // Scenario: evicting the pages does not lose their data.
+  for (size_t i = 0; i < num_instances * pool_size_per_instance; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_instances * pool_size_per_instance); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+TEST(BackgroundWriterTest, WarmupSnapshotTest) {
+  const std::string snapshot_name = "background_writer_test.warmup";
+  remove(snapshot_name.c_str());
+  const size_t num_instances = 2;
+  const size_t pool_size_per_instance = 4;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, pool_size_per_instance, disk_manager.get());
+  for (size_t i = 0; i < num_instances * pool_size_per_instance; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: the writer keeps a snapshot of the pool, which warms up a pool over the same disk.
+  BackgroundWriter writer(bpm.get(), 0, std::chrono::milliseconds(10));
+  writer.SaveWarmupSnapshots(snapshot_name, std::chrono::milliseconds(20));
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (writer.GetNumSnapshots() == 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_LT(0U, writer.GetNumSnapshots());
+
+  auto restarted =
+      std::make_unique<ParallelBufferPoolManager>(num_instances, pool_size_per_instance, disk_manager.get());
+  EXPECT_EQ(num_instances * pool_size_per_instance, restarted->LoadWarmupSnapshot(snapshot_name));
+  EXPECT_EQ(num_instances * pool_size_per_instance, restarted->GetWarmupEntries().size());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_instances * pool_size_per_instance); page_id++) {
+    auto *page = restarted->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+    EXPECT_TRUE(restarted->UnpinPage(page_id, false));
+  }
+  remove(snapshot_name.c_str());
+}
+
+}  // namespace bustub
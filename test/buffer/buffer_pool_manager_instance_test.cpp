@@ -12,15 +12,43 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
 #include <random>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
+/** A DiskManager that counts the pages it reads, to tell the misses of a buffer pool from its hits. */
+class CountingDiskManager : public DiskManager {
+ public:
+  using DiskManager::DiskManager;
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    num_reads_++;
+    DiskManager::ReadPage(page_id, page_data);
+  }
+
+  void ReadPages(page_id_t first_page_id, const std::vector<char *> &pages) override {
+    num_reads_ += pages.size();
+    num_runs_++;
+    DiskManager::ReadPages(first_page_id, pages);
+  }
+
+  std::atomic<size_t> num_reads_{0};
+  std::atomic<size_t> num_runs_{0};
+};
+
 TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
@@ -536,6 +564,587 @@ TEST(BufferPoolManagerInstanceTest, ConcurrencyTest) {
   }
 }
 
+TEST(BufferPoolManagerInstanceTest, HitPathEvictionTest) {
+  // More pages than frames, so that buffer hits through the lock-free fast path race with evictions of the same frames.
+  const int num_threads = 8;
+  const int num_pages = 24;
+  const int num_fetches = 2000;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(8, disk_manager);
+
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(i, page_id);
+    strcpy(page->GetData(), std::to_string(page_id).c_str());  // NOLINT
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&bpm, tid]() {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      for (int i = 0; i < num_fetches; i++) {
+        page_id_t page_id = dist(rng);
+        Page *page = bpm->FetchPage(page_id);
+        while (page == nullptr) {
+          page = bpm->FetchPage(page_id);
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_LE(1, page->GetPinCount());
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_id).c_str(), page->GetData()));
+        EXPECT_EQ(1, bpm->UnpinPage(page_id, i % 4 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every pin has been dropped, and every frame can be evicted again.
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, std::strcmp(std::to_string(i).c_str(), page->GetData()));
+    EXPECT_EQ(1, bpm->UnpinPage(i, false));
+    EXPECT_EQ(0, bpm->UnpinPage(i, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, ReplacerPolicyTest) {
+  const int num_threads = 4;
+  const int num_pages = 24;
+  const int num_fetches = 1000;
+  for (ReplacerPolicy policy :
+       {ReplacerPolicy::LRU_K, ReplacerPolicy::TWO_Q, ReplacerPolicy::ARC, ReplacerPolicy::CLOCK_PRO}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(8, disk_manager, LRUK_REPLACER_K, nullptr, policy);
+
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      strcpy(page->GetData(), std::to_string(page_id).c_str());  // NOLINT
+      EXPECT_EQ(1, bpm->UnpinPage(page_id, true));
+    }
+
+    // Scenario: every policy keeps evicting and reloading pages correctly under concurrent fetches.
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&bpm, tid]() {
+        std::mt19937 rng(tid);
+        std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+        for (int i = 0; i < num_fetches; i++) {
+          page_id_t page_id = dist(rng);
+          Page *page = bpm->FetchPage(page_id);
+          while (page == nullptr) {
+            page = bpm->FetchPage(page_id);
+          }
+          EXPECT_EQ(0, std::strcmp(std::to_string(page_id).c_str(), page->GetData()));
+          EXPECT_EQ(1, bpm->UnpinPage(page_id, false));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // Scenario: once every page is pinned, nothing can be evicted, and unpinning one frees a frame again.
+    for (int i = 0; i < 8; i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+    }
+    EXPECT_EQ(nullptr, bpm->FetchPage(8));
+    EXPECT_EQ(1, bpm->UnpinPage(3, false));
+    auto *page = bpm->FetchPage(8);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, std::strcmp("8", page->GetData()));
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+TEST(BufferPoolManagerInstanceTest, AccessHintTest) {
+  const size_t buffer_pool_size = 10;
+  const int num_scan_pages = 40;
+  const int num_hot_pages = 5;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_scan_pages + num_hot_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    strcpy(page->GetData(), std::to_string(page_id).c_str());  // NOLINT
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = num_scan_pages; page_id < num_scan_pages + num_hot_pages; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, false));
+  }
+  auto num_resident_hot_pages = [&bpm]() {
+    int count = 0;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      page_id_t page_id = bpm->GetPages()[i].GetPageId();
+      count += page_id >= num_scan_pages && page_id < num_scan_pages + num_hot_pages ? 1 : 0;
+    }
+    return count;
+  };
+  auto scan = [&bpm](AccessHint hint) {
+    for (page_id_t page_id = 0; page_id < num_scan_pages; page_id++) {
+      auto *page = bpm->FetchPage(page_id, hint);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, std::strcmp(std::to_string(page_id).c_str(), page->GetData()));
+      EXPECT_EQ(1, bpm->UnpinPage(page_id, false));
+    }
+  };
+
+  // Scenario: a sequential scan recycles a small ring of frames and leaves the hot pages alone.
+  scan(AccessHint::SEQUENTIAL_SCAN);
+  EXPECT_EQ(num_hot_pages, num_resident_hot_pages());
+
+  // Scenario: a ring page that is accessed normally leaves the ring, and is not recycled by the next scan.
+  ASSERT_NE(nullptr, bpm->FetchPage(num_scan_pages - 1));
+  EXPECT_EQ(1, bpm->UnpinPage(num_scan_pages - 1, false));
+  scan(AccessHint::SEQUENTIAL_SCAN);
+  EXPECT_EQ(num_hot_pages, num_resident_hot_pages());
+
+  // Scenario: the same scan without the hint flushes the hot pages out.
+  scan(AccessHint::NORMAL);
+  EXPECT_GT(num_hot_pages, num_resident_hot_pages());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** Records the order in which pages are written. */
+class WriteRecordingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    written_.push_back(page_id);
+    DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+  }
+
+  std::vector<page_id_t> written_;
+};
+
+TEST(BufferPoolManagerInstanceTest, WriteBackTest) {
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new WriteRecordingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool with dirty pages, and keep page 3 pinned.
+  const page_id_t pinned_page_id = 3;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    strcpy(page->GetData(), std::to_string(page_id).c_str());  // NOLINT
+    if (page_id != pinned_page_id) {
+      EXPECT_EQ(1, bpm->UnpinPage(page_id, true));
+    }
+  }
+
+  // Scenario: the lowest unpinned dirty pages are written back, in page id order, until enough frames are clean.
+  EXPECT_EQ(4, bpm->WriteBackDirtyPages(4));
+  EXPECT_EQ((std::vector<page_id_t>{0, 1, 2, 4}), disk_manager->written_);
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id = bpm->GetPages()[i].GetPageId();
+    EXPECT_EQ(page_id > pinned_page_id + 1, bpm->GetPages()[i].IsDirty());
+  }
+  EXPECT_EQ(0, bpm->WriteBackDirtyPages(4));
+
+  // Scenario: evicting a cleaned page does not write it again.
+  page_id_t new_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  EXPECT_EQ(4, disk_manager->written_.size());
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, std::strcmp("0", page->GetData()));
+  EXPECT_EQ(1, bpm->UnpinPage(0, false));
+
+  // Scenario: flushing everything writes the pinned pages and the dirty ones in one pass, in page id order.
+  disk_manager->written_.clear();
+  bpm->FlushAllPages();
+  EXPECT_EQ((std::vector<page_id_t>{3, 5, 6, 7, 8, 9, 10}), disk_manager->written_);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, DirectIOTest) {
+  const std::string db_name = "direct_io_test.db";
+  const size_t buffer_pool_size = 5;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name, true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: every frame is aligned for O_DIRECT.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(bpm->GetPages()[i].GetData()) % BUSTUB_PAGE_SIZE);
+  }
+
+  // Scenario: pages evicted through O_DIRECT read back unchanged.
+  for (size_t i = 0; i < buffer_pool_size * 2; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * 2); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove("direct_io_test.log");
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const std::string db_name = "stats_test.db";
+  const size_t buffer_pool_size = 4;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: fetches of resident pages are hits, each with one page table lookup.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, false));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.hits_);
+  EXPECT_EQ(0U, stats.misses_);
+  EXPECT_EQ(0U, stats.evictions_);
+  EXPECT_EQ(buffer_pool_size, stats.probe_length_.GetCount());
+  EXPECT_EQ(0U, stats.probe_length_.GetBucketCount(0));
+  EXPECT_DOUBLE_EQ(1.0, stats.GetHitRate());
+
+  // Scenario: a new page evicts a dirty page, which is written back; fetching every page again misses at least once,
+  // and every miss evicts.
+  page_id_t new_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  EXPECT_EQ(1, bpm->UnpinPage(new_page_id, true));
+  stats = bpm->GetStats();
+  EXPECT_EQ(1U, stats.evictions_);
+  EXPECT_EQ(1U, stats.dirty_evictions_);
+  EXPECT_LE(1U, stats.evict_latency_.GetCount());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, false));
+  }
+  stats = bpm->GetStats();
+  EXPECT_LE(1U, stats.misses_);
+  EXPECT_EQ(2 * buffer_pool_size, stats.hits_ + stats.misses_);
+  EXPECT_EQ(stats.misses_ + 1, stats.evictions_);
+  EXPECT_LE(stats.dirty_evictions_, stats.evictions_);
+  EXPECT_EQ(0U, stats.pin_waits_);
+
+  // Scenario: the disk manager timed every write and every read of the misses.
+  EXPECT_EQ(static_cast<uint64_t>(disk_manager->GetNumWrites()), disk_manager->GetWriteLatency().GetCount());
+  EXPECT_EQ(stats.misses_, disk_manager->GetReadLatency().GetCount());
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove("stats_test.log");
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, LargePageTest) {
+  const std::string db_name = "large_page_test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t page_size = 16 * 1024;
+  const size_t num_pages = buffer_pool_size * 3;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr,
+                                            ReplacerPolicy::LRU_K, page_size);
+  EXPECT_EQ(page_size, bpm->GetPageSize());
+
+  // Scenario: every byte of a large page survives eviction, including the ones past BUSTUB_PAGE_SIZE.
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(page_size, page->GetSize());
+    for (size_t j = 0; j < page_size; j++) {
+      page->GetData()[j] = static_cast<char>(page_id * 31 + j / BUSTUB_PAGE_SIZE);
+    }
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, true));
+  }
+  // The pages are spread over runs of disk pages, written back both on eviction and by a flush.
+  bpm->FlushAllPages();
+  EXPECT_EQ(static_cast<int>(num_pages * page_size / BUSTUB_PAGE_SIZE), disk_manager->GetNumWrites());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    for (size_t j = 0; j < page_size; j += BUSTUB_PAGE_SIZE / 2) {
+      EXPECT_EQ(static_cast<char>(page_id * 31 + j / BUSTUB_PAGE_SIZE), page->GetData()[j]);
+    }
+    EXPECT_EQ(1, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove("large_page_test.log");
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  for (auto policy : {ReplacerPolicy::LRU_K, ReplacerPolicy::TWO_Q, ReplacerPolicy::ARC, ReplacerPolicy::CLOCK_PRO}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(4, disk_manager, LRUK_REPLACER_K, nullptr, policy, BUSTUB_PAGE_SIZE, 16);
+    EXPECT_EQ(16U, bpm->GetMaxPoolSize());
+    EXPECT_FALSE(bpm->Resize(0));
+    EXPECT_FALSE(bpm->Resize(17));
+
+    // Scenario: a grown pool holds more pages at once, and they are found again by the replacer and page table.
+    std::vector<page_id_t> page_ids;
+    page_id_t page_id;
+    for (int i = 0; i < 4; i++) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      page_ids.push_back(page_id);
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->Resize(12));
+    EXPECT_EQ(12U, bpm->GetPoolSize());
+    for (int i = 0; i < 8; i++) {
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      page_ids.push_back(page_id);
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+    for (page_id_t id : page_ids) {
+      auto *page = bpm->FetchPage(id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", id);
+      EXPECT_TRUE(bpm->UnpinPage(id, true));
+      EXPECT_TRUE(bpm->UnpinPage(id, true));
+    }
+
+    // Scenario: a shrink writes the dirty pages of the dropped frames back, and they read back intact.
+    ASSERT_TRUE(bpm->Resize(3));
+    EXPECT_EQ(3U, bpm->GetPoolSize());
+    std::vector<Page *> pinned;
+    for (int i = 0; i < 3; i++) {
+      pinned.push_back(bpm->NewPage(&page_id));
+      ASSERT_NE(nullptr, pinned.back());
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+    for (auto *page : pinned) {
+      EXPECT_TRUE(bpm->UnpinPage(page->GetPageId(), false));
+    }
+    for (page_id_t id : page_ids) {
+      auto *page = bpm->FetchPage(id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(id, false));
+    }
+
+    // Scenario: a shrink that pinned pages keep from finishing in time gives up, and the pool keeps its size.
+    ASSERT_TRUE(bpm->Resize(8));
+    for (int i = 0; i < 8; i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    }
+    const auto timeout = buffer_pool_resize_timeout;
+    buffer_pool_resize_timeout = std::chrono::milliseconds(20);
+    EXPECT_FALSE(bpm->Resize(2));
+    buffer_pool_resize_timeout = timeout;
+    EXPECT_EQ(8U, bpm->GetPoolSize());
+    for (int i = 0; i < 8; i++) {
+      EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+    }
+    for (page_id_t id : page_ids) {
+      auto *page = bpm->FetchPage(id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(id, false));
+    }
+    // The frames given back by the failed shrink are in use again.
+    for (int i = 0; i < 8; i++) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+TEST(BufferPoolManagerInstanceTest, WarmupTest) {
+  const std::string db_name = "warmup_test.db";
+  const std::string snapshot_name = "warmup_test.warmup";
+  remove(db_name.c_str());
+  remove(snapshot_name.c_str());
+  auto *disk_manager = new CountingDiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(8, disk_manager, 2);
+
+  // Pages 8 to 15 stay resident, and 8, 9 and 10 are accessed twice, so LRU-K evicts 11 next where LRU would evict 8.
+  page_id_t page_id;
+  for (int i = 0; i < 16; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t id : {8, 9, 10}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(id));
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: a snapshot reads back as it was written, and a corrupt one is rejected.
+  auto entries = bpm->GetWarmupEntries();
+  ASSERT_EQ(8U, entries.size());
+  ASSERT_TRUE(bpm->SaveWarmupSnapshot(snapshot_name));
+  std::vector<WarmupEntry> loaded;
+  ASSERT_TRUE(WarmupSnapshot::Load(snapshot_name, &loaded));
+  ASSERT_EQ(entries.size(), loaded.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    EXPECT_EQ(entries[i].page_id_, loaded[i].page_id_);
+    EXPECT_EQ(entries[i].history_, loaded[i].history_);
+  }
+  {
+    std::ofstream corrupt("warmup_test.corrupt", std::ios::binary);
+    corrupt << "not a snapshot";
+  }
+  EXPECT_EQ(0U, bpm->LoadWarmupSnapshot("warmup_test.corrupt"));
+  remove("warmup_test.corrupt");
+
+  // Scenario: a restarted pool loads the resident pages with one run of reads, and then hits on all of them.
+  auto *warm = new BufferPoolManagerInstance(8, disk_manager, 2);
+  const size_t num_runs = disk_manager->num_runs_;
+  EXPECT_EQ(8U, warm->LoadWarmupSnapshot(snapshot_name));
+  EXPECT_EQ(num_runs + 1, disk_manager->num_runs_);
+  const size_t num_reads = disk_manager->num_reads_;
+  for (page_id_t id = 8; id < 16; id++) {
+    auto *page = warm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(id), std::string(page->GetData()));
+    EXPECT_TRUE(warm->UnpinPage(id, false));
+  }
+  EXPECT_EQ(num_reads, disk_manager->num_reads_);
+  EXPECT_EQ(0U, warm->LoadWarmupSnapshot(snapshot_name));
+
+  // Scenario: the replayed history makes the restarted pool evict the page the original one evicts.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_NE(nullptr, warm->FetchPage(0));
+  auto resident = [](BufferPoolManagerInstance *pool) {
+    std::set<page_id_t> page_ids;
+    for (const auto &entry : pool->GetWarmupEntries()) {
+      page_ids.insert(entry.page_id_);
+    }
+    return page_ids;
+  };
+  EXPECT_EQ(0U, resident(bpm).count(11));
+  EXPECT_EQ(resident(bpm), resident(warm));
+
+  // Scenario: a pool with fewer frames than the snapshot has pages loads the most recently accessed pages.
+  auto *small = new BufferPoolManagerInstance(4, disk_manager, 2);
+  EXPECT_EQ(4U, small->LoadWarmupSnapshot(snapshot_name));
+  EXPECT_EQ((std::set<page_id_t>{8, 9, 10, 15}), resident(small));
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(snapshot_name.c_str());
+  remove("warmup_test.log");
+  delete small;
+  delete warm;
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Time to a steady hit rate after a restart, with a cold buffer pool and with one warmed up from a snapshot of the pool
+ * before the restart. The database file is opened with O_DIRECT, so that misses go to the disk.
+ */
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_WarmupBenchmark) {
+  const std::string db_name = "warmup_bench.db";
+  const std::string snapshot_name = "warmup_bench.warmup";
+  const size_t pool_size = 2048;
+  const page_id_t num_pages = 16384;
+  const size_t window = 1000;
+  remove(db_name.c_str());
+  auto *disk_manager = new CountingDiskManager(db_name, true);
+  std::vector<char> data(BUSTUB_PAGE_SIZE, 'x');
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    disk_manager->WritePage(page_id, data.data());
+  }
+
+  // 90% of the accesses go to a hot set that about fits the pool, the rest anywhere.
+  std::mt19937 rng(0);
+  std::vector<page_id_t> hot_pages(pool_size * 3 / 4);
+  for (auto &page_id : hot_pages) {
+    page_id = static_cast<page_id_t>(rng() % num_pages);
+  }
+  auto next_page = [&]() {
+    return rng() % 10 != 0 ? hot_pages[rng() % hot_pages.size()] : static_cast<page_id_t>(rng() % num_pages);
+  };
+  // Returns the hit rate of a window of accesses.
+  auto run_window = [&](BufferPoolManagerInstance *bpm) {
+    const size_t num_reads = disk_manager->num_reads_;
+    for (size_t i = 0; i < window; i++) {
+      const page_id_t page_id = next_page();
+      bpm->FetchPage(page_id);
+      bpm->UnpinPage(page_id, false);
+    }
+    return 1.0 - static_cast<double>(disk_manager->num_reads_ - num_reads) / window;
+  };
+
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+  double steady_hit_rate = 0;
+  for (int i = 0; i < 200; i++) {
+    steady_hit_rate = run_window(bpm);
+  }
+  bpm->SaveWarmupSnapshot(snapshot_name);
+  delete bpm;
+
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "steady hit rate: " << std::fixed << std::setprecision(3) << steady_hit_rate << std::endl;
+  for (bool warm_up : {false, true}) {
+    auto start = std::chrono::steady_clock::now();
+    bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+    size_t num_loaded = warm_up ? bpm->LoadWarmupSnapshot(snapshot_name) : 0;
+    auto loaded = std::chrono::steady_clock::now();
+    size_t accesses = 0;
+    while (accesses < 500 * window && run_window(bpm) < steady_hit_rate * 0.95) {
+      accesses += window;
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    auto load_time = std::chrono::duration<double, std::milli>(loaded - start).count();
+    std::cout << (warm_up ? "warm" : "cold") << ": " << num_loaded << " pages loaded in " << load_time
+              << " ms, steady after " << accesses << " accesses, " << elapsed << " ms" << std::endl;
+    delete bpm;
+  }
+  std::cout << ">>> END" << std::endl;
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(snapshot_name.c_str());
+  remove("warmup_bench.log");
+  delete disk_manager;
+}
+
 TEST(BufferPoolManagerInstanceTest, IntegratedTest) {
   page_id_t temp_page_id;
   DiskManager *disk_manager = new DiskManager("test.db");
@@ -5,11 +5,15 @@
 #include "buffer/lru_k_replacer.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
+#include <list>
 #include <memory>
 #include <random>
 #include <set>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -97,4 +101,135 @@ TEST(LRUKReplacerTest, SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, BackwardKDistanceTest) {
+  LRUKReplacer lru_replacer(4, 3);
+
+  // Frame 0 is accessed at t=0,1,2,9, frame 1 at t=3,4,5 and frame 2 at t=6,7,8. Their 3rd previous accesses are at
+  // t=1, t=3 and t=6, so frame 0 has the largest backward k-distance even though it was accessed last.
+  for (frame_id_t frame_id : {0, 0, 0, 1, 1, 1, 2, 2, 2, 0}) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  // Frame 3 has a single access, which gives it +inf backward k-distance.
+  lru_replacer.RecordAccess(3);
+  ASSERT_EQ(0, lru_replacer.Size());
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(4, lru_replacer.Size());
+
+  // Evicting a frame forgets its history, so a re-accessed frame 3 has +inf backward k-distance again.
+  int value;
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  lru_replacer.RecordAccess(3);
+  lru_replacer.SetEvictable(3, true);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+
+  // A non-evictable frame is skipped, and a removed frame is gone for good.
+  lru_replacer.SetEvictable(0, false);
+  lru_replacer.Remove(1);
+  ASSERT_EQ(1, lru_replacer.Size());
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+  lru_replacer.SetEvictable(0, true);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+
+/**
+ * The list-based LRU-K replacer that LRUKReplacer replaced, kept as the baseline of the benchmark below. It keeps
+ * frames with less than k accesses in FIFO order and the others in LRU order, and scans past non-evictable frames.
+ */
+class ListLRUKReplacer {
+ public:
+  explicit ListLRUKReplacer(size_t num_frames, size_t k) : k_(k) {}
+
+  auto Evict(frame_id_t *frame_id) -> bool {
+    for (auto *list : {&history_list_, &cache_list_}) {
+      for (auto rit = list->rbegin(); rit != list->rend(); ++rit) {
+        if (entries_[*rit].is_evictable_) {
+          *frame_id = *rit;
+          list->erase(std::next(rit).base());
+          entries_.erase(*frame_id);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void RecordAccess(frame_id_t frame_id) {
+    auto &entry = entries_[frame_id];
+    size_t access_count = ++entry.access_count_;
+    if (access_count == 1) {
+      history_list_.emplace_front(frame_id);
+      entry.position_ = history_list_.begin();
+    } else if (access_count >= k_) {
+      (access_count == k_ ? history_list_ : cache_list_).erase(entry.position_);
+      cache_list_.emplace_front(frame_id);
+      entry.position_ = cache_list_.begin();
+    }
+  }
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) {
+    if (entries_.count(frame_id) != 0) {
+      entries_[frame_id].is_evictable_ = set_evictable;
+    }
+  }
+
+ private:
+  struct FrameEntry {
+    bool is_evictable_{true};
+    size_t access_count_{0};
+    std::list<frame_id_t>::iterator position_;
+  };
+  size_t k_;
+  std::list<frame_id_t> history_list_;
+  std::list<frame_id_t> cache_list_;
+  std::unordered_map<frame_id_t, FrameEntry> entries_;
+};
+
+/**
+ * Every frame is accessed once and the older half is pinned, which is what a buffer pool full of pinned pages looks
+ * like to the replacer. Each cycle records a random hit and replaces the victim with a new page.
+ * @return number of cycles per second
+ */
+template <typename ReplacerType>
+auto LRUKReplacerBenchmarkCall(size_t num_frames, size_t num_cycles) -> double {
+  ReplacerType replacer(num_frames, LRUK_REPLACER_K);
+  for (size_t i = 0; i < num_frames; i++) {
+    replacer.RecordAccess(static_cast<frame_id_t>(i));
+    replacer.SetEvictable(static_cast<frame_id_t>(i), i >= num_frames / 2);
+  }
+
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<frame_id_t> dist(0, static_cast<frame_id_t>(num_frames - 1));
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_cycles; i++) {
+    replacer.RecordAccess(dist(rng));
+    frame_id_t victim;
+    EXPECT_TRUE(replacer.Evict(&victim));
+    replacer.RecordAccess(victim);
+    replacer.SetEvictable(victim, true);
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  return static_cast<double>(num_cycles) / std::chrono::duration<double>(clock_end - clock_start).count();
+}
+
+TEST(LRUKReplacerTest, DISABLED_EvictBenchmark) {
+  const size_t num_cycles = 200;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_frames : {10000, 100000, 1000000}) {
+    double list_ops = LRUKReplacerBenchmarkCall<ListLRUKReplacer>(num_frames, num_cycles);
+    double heap_ops = LRUKReplacerBenchmarkCall<LRUKReplacer>(num_frames, num_cycles);
+    std::cout << "frames: " << num_frames << " list cycles/s: " << list_ops << " heap cycles/s: " << heap_ops
+              << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
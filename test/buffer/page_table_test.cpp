@@ -0,0 +1,204 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable table(10);
+  EXPECT_LE(20, table.GetCapacity());
+
+  frame_id_t frame_id;
+  EXPECT_FALSE(table.Find(1, &frame_id));
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    table.Insert(page_id * 7, page_id);
+  }
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    ASSERT_TRUE(table.Find(page_id * 7, &frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+  EXPECT_FALSE(table.Find(1, &frame_id));
+
+  EXPECT_TRUE(table.Remove(14));
+  EXPECT_FALSE(table.Remove(14));
+  EXPECT_FALSE(table.Find(14, &frame_id));
+  ASSERT_TRUE(table.Find(21, &frame_id));
+  EXPECT_EQ(3, frame_id);
+  table.Insert(14, 9);
+  ASSERT_TRUE(table.Find(14, &frame_id));
+  EXPECT_EQ(9, frame_id);
+}
+
+TEST(PageTableTest, RandomTest) {
+  // Scenario: a table of a small pool, so probe runs cross buckets and wrap around, against std::unordered_map.
+  const size_t num_frames = 16;
+  PageTable table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 200);
+  for (int i = 0; i < 100000; i++) {
+    const page_id_t page_id = page_dist(rng);
+    if (expected.count(page_id) == 0 && expected.size() < num_frames) {
+      table.Insert(page_id, i);
+      expected[page_id] = i;
+    } else {
+      EXPECT_EQ(expected.erase(page_id) == 1, table.Remove(page_id));
+    }
+    if (i % 100 == 0) {
+      for (page_id_t p = 0; p <= 200; p++) {
+        frame_id_t frame_id;
+        auto it = expected.find(p);
+        ASSERT_EQ(it != expected.end(), table.Find(p, &frame_id));
+        if (it != expected.end()) {
+          EXPECT_EQ(it->second, frame_id);
+        }
+      }
+    }
+  }
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  // Scenario: while one writer keeps inserting and removing pages, readers always find the pages that stay put.
+  const size_t num_frames = 64;
+  const page_id_t num_stable = 32;
+  PageTable table(num_frames);
+  for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+    table.Insert(page_id, page_id);
+  }
+
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<page_id_t> page_dist(num_stable, num_stable + 100);
+    std::vector<page_id_t> resident;
+    for (int i = 0; i < 200000; i++) {
+      if (resident.size() < num_frames - num_stable) {
+        const page_id_t page_id = page_dist(rng);
+        frame_id_t frame_id;
+        if (!table.Find(page_id, &frame_id)) {
+          table.Insert(page_id, page_id);
+          resident.push_back(page_id);
+        }
+      } else {
+        std::swap(resident[rng() % resident.size()], resident.back());
+        table.Remove(resident.back());
+        resident.pop_back();
+      }
+    }
+    done = true;
+  });
+
+  std::vector<std::thread> readers;
+  std::atomic<size_t> misses{0};
+  for (int t = 0; t < 3; t++) {
+    readers.emplace_back([&, t] {
+      page_id_t page_id = t;
+      while (!done) {
+        frame_id_t frame_id;
+        if (!table.Find(page_id, &frame_id) || frame_id != page_id) {
+          misses++;
+        }
+        page_id = (page_id + 1) % num_stable;
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, misses);
+}
+
+/**
+ * Lookups of resident pages from many threads, against the extendible hash table under a latch as the buffer pool
+ * used it, with a writer replacing pages in the background.
+ */
+// NOLINTNEXTLINE
+TEST(PageTableBenchmark, DISABLED_ContentionBenchmark) {
+  const size_t num_frames = 4096;
+  const int lookups_per_thread = 1000000;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (int num_threads : {1, 2, 4, 8}) {
+    for (bool lock_free : {false, true}) {
+      PageTable table(num_frames);
+      ExtendibleHashTable<page_id_t, frame_id_t> extendible(4);
+      std::mutex latch;
+      for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames); page_id++) {
+        table.Insert(page_id, page_id);
+        extendible.Insert(page_id, page_id);
+      }
+
+      std::atomic<bool> done{false};
+      std::thread writer([&] {
+        // Replace one page at a time, as misses do.
+        for (page_id_t page_id = num_frames; !done; page_id++) {
+          std::scoped_lock lock(latch);
+          const page_id_t victim = page_id - static_cast<page_id_t>(num_frames);
+          if (lock_free) {
+            table.Remove(victim);
+            table.Insert(page_id, victim % num_frames);
+          } else {
+            extendible.Remove(victim);
+            extendible.Insert(page_id, victim % num_frames);
+          }
+          std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+      });
+
+      std::atomic<size_t> found{0};
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+          std::mt19937 rng(t);
+          size_t hits = 0;
+          for (int i = 0; i < lookups_per_thread; i++) {
+            const auto page_id = static_cast<page_id_t>(rng() % (2 * num_frames));
+            frame_id_t frame_id;
+            if (lock_free) {
+              hits += table.Find(page_id, &frame_id) ? 1 : 0;
+            } else {
+              std::scoped_lock lock(latch);
+              hits += extendible.Find(page_id, frame_id) ? 1 : 0;
+            }
+          }
+          found += hits;
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      done = true;
+      writer.join();
+      std::cout << (lock_free ? "page table " : "extendible ") << num_threads << " threads: " << std::fixed
+                << std::setprecision(1) << num_threads * lookups_per_thread / elapsed / 1e6 << "M lookups/s"
+                << std::endl;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,202 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(buffer_pool_size * num_instances, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up the buffer pool. New pages are handed out round
+  // robin, so every instance gets its share and every page id maps back to the instance that created it.
+  std::vector<page_id_t> page_ids{page_id_temp};
+  for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    page_ids.push_back(page_id_temp);
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    EXPECT_EQ(static_cast<page_id_t>(i), page_ids[i]);
+  }
+
+  // Scenario: Once the buffer pool is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning pages {0, 1, 2, 3, 4, 5} and pinning another 4 new pages,
+  // there would still be one buffer page left for reading page 0.
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+    bpm->FlushPage(i);
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+
+  // Scenario: We should be able to fetch the data we wrote a while ago.
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+
+  // Scenario: Deleting an unpinned page succeeds, and pages that are not resident can be deleted as well.
+  EXPECT_EQ(true, bpm->DeletePage(0));
+  EXPECT_EQ(true, bpm->DeletePage(1000));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const int num_threads = 5;
+  const int num_runs = 50;
+  for (int run = 0; run < num_runs; run++) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    std::shared_ptr<BufferPoolManager> bpm{new ParallelBufferPoolManager(4, 15, disk_manager)};
+    std::vector<std::thread> threads;
+
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.push_back(std::thread([&bpm]() {  // NOLINT
+        page_id_t temp_page_id;
+        std::vector<page_id_t> page_ids;
+        for (int i = 0; i < 10; i++) {
+          auto new_page = bpm->NewPage(&temp_page_id, nullptr);
+          EXPECT_NE(nullptr, new_page);
+          ASSERT_NE(nullptr, new_page);
+          strcpy(new_page->GetData(), std::to_string(temp_page_id).c_str());  // NOLINT
+          page_ids.push_back(temp_page_id);
+        }
+        for (int i = 0; i < 10; i++) {
+          EXPECT_EQ(1, bpm->UnpinPage(page_ids[i], true, nullptr));
+        }
+        for (int j = 0; j < 10; j++) {
+          auto page = bpm->FetchPage(page_ids[j], nullptr);
+          EXPECT_NE(nullptr, page);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(0, std::strcmp(std::to_string(page_ids[j]).c_str(), (page->GetData())));
+          EXPECT_EQ(1, bpm->UnpinPage(page_ids[j], true, nullptr));
+        }
+        for (int j = 0; j < 10; j++) {
+          EXPECT_EQ(1, bpm->DeletePage(page_ids[j], nullptr));
+        }
+      }));
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+      threads[i].join();
+    }
+
+    delete disk_manager;
+  }
+}
+
+/**
+ * Fetch/unpin throughput on a fully resident working set, so every request is a buffer hit and the only thing that
+ * limits scaling is latch contention inside the buffer pool.
+ * @return number of fetch/unpin pairs per second
+ */
+auto ParallelBufferPoolHitBenchmarkCall(size_t num_instances, size_t num_threads) -> double {
+  const size_t frames = 1024;
+  const size_t ops_per_thread = 200000;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, frames / num_instances, disk_manager);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < frames; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+    page_ids.push_back(page_id);
+  }
+
+  std::vector<std::thread> threads;
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&bpm, &page_ids, tid, ops_per_thread]() {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        page_id_t page_id = page_ids[dist(rng)];
+        Page *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        bpm->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(clock_end - clock_start).count();
+
+  delete bpm;
+  delete disk_manager;
+  return static_cast<double>(num_threads * ops_per_thread) / seconds;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_HitThroughputBenchmark) {
+  const size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_instances : {1, 16}) {
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      double ops = ParallelBufferPoolHitBenchmarkCall(num_instances, num_threads);
+      std::cout << "instances: " << num_instances << " threads: " << num_threads << " fetch+unpin/s: " << ops
+                << std::endl;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
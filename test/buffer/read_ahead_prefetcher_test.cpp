@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_prefetcher_test.cpp
+//
+// Identification: test/buffer/read_ahead_prefetcher_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/read_ahead_prefetcher.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** The test chains pages by storing the id of the next page at the start of each page. */
+auto ReadNextLink(Page *page) -> page_id_t {
+  page_id_t next_page_id;
+  std::memcpy(&next_page_id, page->GetData(), sizeof(page_id_t));
+  return next_page_id;
+}
+
+/** Create a chain of num_pages pages and return their ids in chain order. */
+auto CreateChain(BufferPoolManager *bpm, size_t num_pages) -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  Page *prev_page = nullptr;
+  for (size_t i = 0; i <= num_pages; i++) {
+    page_id_t page_id = INVALID_PAGE_ID;
+    Page *page = nullptr;
+    if (i < num_pages) {
+      page = bpm->NewPage(&page_id);
+      EXPECT_NE(nullptr, page);
+      page_ids.push_back(page_id);
+    }
+    if (prev_page != nullptr) {
+      std::memcpy(prev_page->GetData(), &page_id, sizeof(page_id_t));
+      EXPECT_TRUE(bpm->UnpinPage(prev_page->GetPageId(), true));
+    }
+    prev_page = page;
+  }
+  return page_ids;
+}
+
+TEST(ReadAheadPrefetcherTest, ChainTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  const size_t num_pages = 20;
+  auto page_ids = CreateChain(bpm.get(), num_pages);
+  ReadAheadPrefetcher prefetcher(bpm.get(), 4);
+
+  // Scenario: the first page is a miss, every later page was loaded before the scan got to it, and every page of the
+  // chain but the first is loaded exactly once.
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t next_page_id = i + 1 < num_pages ? page_ids[i + 1] : INVALID_PAGE_ID;
+    prefetcher.ScanAt(page_ids[i], next_page_id, ReadNextLink, AccessHint::NORMAL);
+    prefetcher.WaitIdle();
+  }
+  auto stats = prefetcher.GetStats();
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(num_pages - 1, stats.hits_);
+  EXPECT_EQ(num_pages - 1, stats.issued_);
+  EXPECT_EQ(0, stats.dropped_);
+
+  // Scenario: the loaded pages are unpinned, so every frame can still be used.
+  std::vector<page_id_t> new_page_ids(50);
+  for (auto &page_id : new_page_ids) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  for (auto page_id : new_page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+TEST(ReadAheadPrefetcherTest, ScanTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(10, disk_manager.get());
+  const size_t num_pages = 40;
+  auto page_ids = CreateChain(bpm.get(), num_pages);
+  ReadAheadPrefetcher prefetcher(bpm.get(), 2);
+
+  // Scenario: a scan through a chain larger than the pool, racing the prefetcher, reads every page correctly.
+  page_id_t page_id = page_ids[0];
+  size_t num_visited = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = bpm->FetchPage(page_id, AccessHint::SEQUENTIAL_SCAN);
+    ASSERT_NE(nullptr, page);
+    page->RLatch();
+    page_id_t next_page_id = ReadNextLink(page);
+    prefetcher.ScanAt(page_id, next_page_id, ReadNextLink, AccessHint::SEQUENTIAL_SCAN);
+    page->RUnlatch();
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    EXPECT_EQ(num_visited + 1 < num_pages ? page_ids[num_visited + 1] : INVALID_PAGE_ID, next_page_id);
+    page_id = next_page_id;
+    num_visited++;
+  }
+  prefetcher.WaitIdle();
+  EXPECT_EQ(num_pages, num_visited);
+  auto stats = prefetcher.GetStats();
+  EXPECT_EQ(num_pages, stats.hits_ + stats.misses_);
+}
+
+}  // namespace bustub
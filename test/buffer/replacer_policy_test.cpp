@@ -0,0 +1,230 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_policy_test.cpp
+//
+// Identification: test/buffer/replacer_policy_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_pro_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/two_q_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/**
+ * A page that comes back soon after its eviction is protected from a sequential scan that runs through the remaining
+ * frames, but can still be evicted once it is the only candidate.
+ */
+template <typename ReplacerType>
+void ScanResistanceCall() {
+  ReplacerType replacer(4);
+
+  // Scenario: page 100 is loaded, evicted and fetched again, which makes the replacer treat it as hot.
+  replacer.RecordAccess(0, 100);
+  replacer.SetEvictable(0, true);
+  frame_id_t victim;
+  ASSERT_TRUE(replacer.Evict(&victim));
+  ASSERT_EQ(0, victim);
+  ASSERT_EQ(0, replacer.Size());
+  replacer.RecordAccess(0, 100);
+  replacer.SetEvictable(0, true);
+
+  // Scenario: a scan touches every one of its pages once and never evicts the hot page.
+  page_id_t scan_page_id = 200;
+  for (frame_id_t frame_id = 1; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, scan_page_id++);
+    replacer.SetEvictable(frame_id, true);
+  }
+  for (int i = 0; i < 20; i++) {
+    ASSERT_TRUE(replacer.Evict(&victim));
+    ASSERT_NE(0, victim);
+    replacer.RecordAccess(victim, scan_page_id++);
+    replacer.SetEvictable(victim, true);
+  }
+  ASSERT_EQ(4, replacer.Size());
+
+  // Scenario: pinned frames are skipped, and removing one is a no-op.
+  replacer.SetEvictable(0, false);
+  replacer.Remove(0);
+  ASSERT_EQ(3, replacer.Size());
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(replacer.Evict(&victim));
+    ASSERT_NE(0, victim);
+  }
+  ASSERT_FALSE(replacer.Evict(&victim));
+
+  // Scenario: once unpinned, the hot page is the only candidate left.
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(1, replacer.Size());
+  ASSERT_TRUE(replacer.Evict(&victim));
+  ASSERT_EQ(0, victim);
+  ASSERT_EQ(0, replacer.Size());
+
+  // Scenario: a removed frame is forgotten.
+  replacer.RecordAccess(1, 1000);
+  replacer.SetEvictable(1, true);
+  replacer.Remove(1);
+  ASSERT_EQ(0, replacer.Size());
+  ASSERT_FALSE(replacer.Evict(&victim));
+}
+
+TEST(ReplacerPolicyTest, TwoQScanResistanceTest) { ScanResistanceCall<TwoQReplacer>(); }
+
+TEST(ReplacerPolicyTest, ARCScanResistanceTest) { ScanResistanceCall<ARCReplacer>(); }
+
+TEST(ReplacerPolicyTest, ClockProScanResistanceTest) { ScanResistanceCall<ClockProReplacer>(); }
+
+TEST(ReplacerPolicyTest, TwoQCorrelatedReferenceTest) {
+  TwoQReplacer replacer(8);
+
+  // Scenario: re-referencing a page while it is in A1in does not change its place in the FIFO order.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  replacer.RecordAccess(0, 0);
+  replacer.RecordAccess(0, 0);
+  frame_id_t victim;
+  ASSERT_TRUE(replacer.Evict(&victim));
+  ASSERT_EQ(0, victim);
+  ASSERT_TRUE(replacer.Evict(&victim));
+  ASSERT_EQ(1, victim);
+}
+
+TEST(ReplacerPolicyTest, ARCAdaptationTest) {
+  ARCReplacer replacer(4);
+  frame_id_t victim;
+
+  // Scenario: pages 0 and 1 are fetched twice and live in T2, page 2 was fetched once and lives in T1.
+  for (frame_id_t frame_id = 0; frame_id < 3; frame_id++) {
+    replacer.RecordAccess(frame_id, frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  replacer.RecordAccess(0, 0);
+  replacer.RecordAccess(1, 1);
+
+  // Scenario: p starts at 0, so T1 gives up its frame first.
+  ASSERT_TRUE(replacer.Evict(&victim));
+  ASSERT_EQ(2, victim);
+
+  // Scenario: page 2 comes back from B1, p grows to 1 and page 2 joins T2. A new page lands in T1, which is not over
+  // its target anymore, so T2 gives up its least recently used frame.
+  replacer.RecordAccess(2, 2);
+  replacer.SetEvictable(2, true);
+  replacer.RecordAccess(3, 3);
+  replacer.SetEvictable(3, true);
+  ASSERT_TRUE(replacer.Evict(&victim));
+  ASSERT_EQ(0, victim);
+}
+
+/** Hit counts of one trace replay. */
+struct TraceResult {
+  size_t lookups_{0};
+  size_t lookup_hits_{0};
+  size_t accesses_{0};
+  size_t hits_{0};
+};
+
+/**
+ * Replay a trace of (page id, is point lookup) pairs against a replacer, as a buffer pool of num_frames frames with
+ * no pinned pages would.
+ */
+auto ReplayTrace(FrameReplacer *replacer, size_t num_frames, const std::vector<std::pair<page_id_t, bool>> &trace)
+    -> TraceResult {
+  TraceResult result;
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frames(num_frames, INVALID_PAGE_ID);
+  size_t num_used_frames = 0;
+  for (const auto &[page_id, is_lookup] : trace) {
+    result.accesses_++;
+    result.lookups_ += is_lookup ? 1 : 0;
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      result.hits_++;
+      result.lookup_hits_ += is_lookup ? 1 : 0;
+      replacer->RecordAccess(it->second, page_id);
+      continue;
+    }
+
+    frame_id_t frame_id;
+    if (num_used_frames < num_frames) {
+      frame_id = static_cast<frame_id_t>(num_used_frames++);
+    } else {
+      EXPECT_TRUE(replacer->Evict(&frame_id));
+      page_table.erase(frames[frame_id]);
+    }
+    frames[frame_id] = page_id;
+    page_table[page_id] = frame_id;
+    replacer->RecordAccess(frame_id, page_id);
+    replacer->SetEvictable(frame_id, true);
+  }
+  return result;
+}
+
+/**
+ * Point lookups go to a small set of hot index pages and a larger set of warm pages, while sequential scans run over a
+ * table much larger than the pool, one scan page every few lookups.
+ */
+TEST(ReplacerPolicyTest, DISABLED_TraceReplayBenchmark) {
+  const size_t num_frames = 1024;
+  const size_t num_accesses = 1000000;
+  const page_id_t num_hot_pages = 256;
+  const page_id_t num_warm_pages = 4096;
+  const page_id_t num_table_pages = 100000;
+
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<page_id_t> hot_dist(0, num_hot_pages - 1);
+  std::uniform_int_distribution<page_id_t> warm_dist(num_hot_pages, num_hot_pages + num_warm_pages - 1);
+  std::uniform_real_distribution<double> coin(0, 1);
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (double scan_fraction : {0.0, 0.3, 0.6}) {
+    std::vector<std::pair<page_id_t, bool>> trace;
+    trace.reserve(num_accesses);
+    page_id_t scan_page_id = 0;
+    for (size_t i = 0; i < num_accesses; i++) {
+      if (coin(rng) < scan_fraction) {
+        trace.emplace_back(num_hot_pages + num_warm_pages + scan_page_id, false);
+        scan_page_id = (scan_page_id + 1) % num_table_pages;
+      } else {
+        trace.emplace_back(coin(rng) < 0.8 ? hot_dist(rng) : warm_dist(rng), true);
+      }
+    }
+
+    std::vector<std::pair<std::string, std::unique_ptr<FrameReplacer>>> replacers;
+    replacers.emplace_back("LRU", std::make_unique<LRUKReplacer>(num_frames, 1));
+    replacers.emplace_back("LRU-2", std::make_unique<LRUKReplacer>(num_frames, 2));
+    replacers.emplace_back("LRU-" + std::to_string(LRUK_REPLACER_K),
+                           std::make_unique<LRUKReplacer>(num_frames, LRUK_REPLACER_K));
+    replacers.emplace_back("2Q", std::make_unique<TwoQReplacer>(num_frames));
+    replacers.emplace_back("ARC", std::make_unique<ARCReplacer>(num_frames));
+    replacers.emplace_back("CLOCK-Pro", std::make_unique<ClockProReplacer>(num_frames));
+    std::cout << "scan fraction: " << scan_fraction << std::endl;
+    for (auto &[name, replacer] : replacers) {
+      TraceResult result = ReplayTrace(replacer.get(), num_frames, trace);
+      std::cout << "  " << std::setw(10) << name << " lookup hit ratio: " << std::fixed << std::setprecision(4)
+                << static_cast<double>(result.lookup_hits_) / static_cast<double>(result.lookups_)
+                << " overall hit ratio: " << static_cast<double>(result.hits_) / static_cast<double>(result.accesses_)
+                << std::endl;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(Crc32cTest, KnownValueTest) {
+  EXPECT_EQ(0U, Crc32c::Compute("", 0));
+  EXPECT_EQ(0xE3069283U, Crc32c::Compute("123456789", 9));
+  // 32 bytes of zeros and of ones, from RFC 3720.
+  std::string zeros(32, '\0');
+  std::string ones(32, '\xFF');
+  EXPECT_EQ(0x8A9136AAU, Crc32c::Compute(zeros.data(), zeros.size()));
+  EXPECT_EQ(0x62A8AB43U, Crc32c::Compute(ones.data(), ones.size()));
+}
+
+TEST(Crc32cTest, PieceAndBlockTest) {
+  std::mt19937 rng(15445);
+  std::vector<char> data(4096 + 13);
+  for (auto &byte : data) {
+    byte = static_cast<char>(rng());
+  }
+
+  // Scenario: a buffer checksummed in pieces of any size gives the CRC of the whole.
+  const uint32_t whole = Crc32c::Compute(data.data(), data.size());
+  for (size_t split : {1, 7, 8, 100, 4096}) {
+    const uint32_t first = Crc32c::Compute(data.data(), split);
+    EXPECT_EQ(whole, Crc32c::Compute(data.data() + split, data.size() - split, first));
+  }
+
+  // Scenario: blocks checksummed at once give the CRC of each, whatever their size and number.
+  for (size_t block_size : {512, 100, 13}) {
+    for (size_t num_blocks : {1, 4, 7, 8}) {
+      std::vector<uint32_t> crcs(num_blocks);
+      Crc32c::ComputeBlocks(data.data(), block_size, num_blocks, crcs.data());
+      for (size_t i = 0; i < num_blocks; i++) {
+        EXPECT_EQ(Crc32c::Compute(data.data() + i * block_size, block_size), crcs[i]);
+      }
+    }
+  }
+}
+
+}  // namespace bustub
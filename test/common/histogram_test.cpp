@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// histogram_test.cpp
+//
+// Identification: test/common/histogram_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/histogram.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(HistogramTest, BucketTest) {
+  EXPECT_EQ(0U, Histogram::BucketOf(0));
+  EXPECT_EQ(1U, Histogram::BucketOf(1));
+  EXPECT_EQ(2U, Histogram::BucketOf(2));
+  EXPECT_EQ(2U, Histogram::BucketOf(3));
+  EXPECT_EQ(3U, Histogram::BucketOf(4));
+  EXPECT_EQ(10U, Histogram::BucketOf(1023));
+  EXPECT_EQ(11U, Histogram::BucketOf(1024));
+  EXPECT_EQ(64U, Histogram::BucketOf(UINT64_MAX));
+  for (size_t bucket = 0; bucket < Histogram::NUM_BUCKETS; bucket++) {
+    EXPECT_EQ(bucket, Histogram::BucketOf(Histogram::BucketUpperBound(bucket)));
+  }
+}
+
+TEST(HistogramTest, PercentileTest) {
+  Histogram histogram;
+  EXPECT_EQ(0U, histogram.GetCount());
+  EXPECT_EQ(0U, histogram.GetPercentile(50));
+  EXPECT_DOUBLE_EQ(0, histogram.GetMean());
+
+  // 90 values of 1 and 10 values of 100.
+  for (int i = 0; i < 90; i++) {
+    histogram.Record(1);
+  }
+  for (int i = 0; i < 10; i++) {
+    histogram.Record(100);
+  }
+  EXPECT_EQ(100U, histogram.GetCount());
+  EXPECT_EQ(1090U, histogram.GetSum());
+  EXPECT_DOUBLE_EQ(10.9, histogram.GetMean());
+  EXPECT_EQ(1U, histogram.GetPercentile(0));
+  EXPECT_EQ(1U, histogram.GetPercentile(50));
+  EXPECT_EQ(1U, histogram.GetPercentile(90));
+  EXPECT_EQ(127U, histogram.GetPercentile(91));
+  EXPECT_EQ(127U, histogram.GetPercentile(100));
+
+  // Copies and merges add up the counts, a reset forgets them.
+  Histogram copy = histogram;
+  copy.Merge(histogram);
+  EXPECT_EQ(200U, copy.GetCount());
+  EXPECT_EQ(2180U, copy.GetSum());
+  EXPECT_EQ(20U, copy.GetBucketCount(Histogram::BucketOf(100)));
+  copy.Reset();
+  EXPECT_EQ(0U, copy.GetCount());
+  EXPECT_EQ(100U, histogram.GetCount());
+}
+
+TEST(HistogramTest, ConcurrentRecordTest) {
+  const int num_threads = 4;
+  const int num_values = 10000;
+  Histogram histogram;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&histogram, tid] {
+      for (int i = 0; i < num_values; i++) {
+        histogram.Record(tid);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(static_cast<uint64_t>(num_threads * num_values), histogram.GetCount());
+  EXPECT_EQ(static_cast<uint64_t>((0 + 1 + 2 + 3) * num_values), histogram.GetSum());
+}
+
+}  // namespace bustub
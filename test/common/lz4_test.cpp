@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4_test.cpp
+//
+// Identification: test/common/lz4_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/lz4.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(Lz4Test, KnownBlockTest) {
+  // Blocks written by the reference LZ4 library: literals only, and 8 literals and a 56 byte match at offset 8.
+  const std::string literals("\x50hello", 6);
+  char out[128];
+  ASSERT_TRUE(Lz4::Decompress(literals.data(), literals.size(), out, 5));
+  EXPECT_EQ("hello", std::string(out, 5));
+
+  std::string pattern;
+  for (int i = 0; i < 8; i++) {
+    pattern += "abcdefgh";
+  }
+  const std::string match("\x8F" "abcdefgh" "\x08\x00" "\x25" "\x50" "abcde", 18);
+  ASSERT_TRUE(Lz4::Decompress(match.data(), match.size(), out, 69));
+  EXPECT_EQ(pattern + "abcde", std::string(out, 69));
+
+  // Scenario: the compressor writes the block the reference library does for a repeated pattern.
+  std::string input = pattern + "abcde";
+  char block[64];
+  const size_t size = Lz4::Compress(input.data(), input.size(), block, sizeof(block));
+  EXPECT_EQ(match, std::string(block, size));
+}
+
+TEST(Lz4Test, RoundTripTest) {
+  std::mt19937 rng(15445);
+  for (size_t size : {0, 1, 12, 13, 100, 4096, 65536}) {
+    for (int kind = 0; kind < 3; kind++) {
+      std::vector<char> input(size);
+      for (size_t i = 0; i < size; i++) {
+        switch (kind) {
+          case 0:
+            input[i] = 0;
+            break;
+          case 1:
+            input[i] = "log line "[rng() % 9];
+            break;
+          default:
+            input[i] = static_cast<char>(rng());
+        }
+      }
+      std::vector<char> block(size + size / 255 + 16);
+      const size_t block_size = Lz4::Compress(input.data(), size, block.data(), block.size());
+      ASSERT_NE(0U, block_size);
+      if (kind == 0 && size >= 1000) {
+        EXPECT_LT(block_size, size / 10);
+      }
+      std::vector<char> output(size + 1);
+      ASSERT_TRUE(Lz4::Decompress(block.data(), block_size, output.data(), size));
+      EXPECT_EQ(0, memcmp(input.data(), output.data(), size));
+      // Scenario: the size the block decompresses to is checked.
+      EXPECT_FALSE(Lz4::Decompress(block.data(), block_size, output.data(), size + 1));
+    }
+  }
+}
+
+TEST(Lz4Test, BadBlockTest) {
+  std::mt19937 rng(15445);
+  std::vector<char> input(4096);
+  for (auto &byte : input) {
+    byte = "0123456789 abc"[rng() % 14];
+  }
+
+  // Scenario: a block that does not fit is not written.
+  std::vector<char> block(4096 + 64);
+  EXPECT_EQ(0U, Lz4::Compress(input.data(), input.size(), block.data(), 100));
+  const size_t block_size = Lz4::Compress(input.data(), input.size(), block.data(), block.size());
+  ASSERT_NE(0U, block_size);
+
+  // Scenario: damaged or cut blocks never write past the output, whether or not they are caught.
+  std::vector<char> output(input.size());
+  EXPECT_FALSE(Lz4::Decompress(block.data(), block_size - 1, output.data(), output.size()));
+  EXPECT_FALSE(Lz4::Decompress(block.data(), 0, output.data(), output.size()));
+  for (int i = 0; i < 1000; i++) {
+    std::vector<char> damaged(block.begin(), block.begin() + block_size);
+    damaged[rng() % block_size] ^= static_cast<char>(1 << (rng() % 8));
+    Lz4::Decompress(damaged.data(), damaged.size(), output.data(), output.size());
+  }
+}
+
+}  // namespace bustub
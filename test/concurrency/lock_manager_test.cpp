@@ -4,8 +4,10 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <chrono>  // NOLINT
 #include <random>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/transaction_manager.h"
@@ -218,6 +220,60 @@ TEST(LockManagerTest, DISABLED_RowLockTest1) { RowLockTest1(); }  // NOLINT
 }
 TEST(LockManagerTest, RowLockTest0) { RowLockTest0(); }  // NOLINT */
 
+void RowLocksTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t oid = 0;
+
+  std::vector<RID> rids{{0, 0}, {0, 1}, {0, 2}, {1, 0}};
+
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_SHARED, oid));
+
+  // A row another transaction shares, and one the transaction itself shares, take the path of LockRow().
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::SHARED, oid, rids[1]));
+  EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::SHARED, oid, rids[3]));
+  std::thread unlocker([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    lock_mgr.UnlockRow(txn1, oid, rids[3]);
+  });
+  EXPECT_TRUE(lock_mgr.LockRows(txn0, LockManager::LockMode::EXCLUSIVE, oid, rids));
+  unlocker.join();
+  CheckGrowing(txn0);
+  CheckTxnRowLockSize(txn0, oid, 0, 4);
+  for (const auto &rid : rids) {
+    EXPECT_TRUE(txn0->IsRowExclusiveLocked(oid, rid));
+  }
+
+  // Locks already held are granted again.
+  EXPECT_TRUE(lock_mgr.LockRows(txn0, LockManager::LockMode::EXCLUSIVE, oid, rids));
+  CheckTxnRowLockSize(txn0, oid, 0, 4);
+
+  // The table lock is checked once, for all of them.
+  auto *txn2 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn2, LockManager::LockMode::INTENTION_SHARED, oid));
+  try {
+    lock_mgr.LockRows(txn2, LockManager::LockMode::EXCLUSIVE, oid, {RID{2, 0}, RID{2, 1}});
+    FAIL();
+  } catch (TransactionAbortException &e) {
+    CheckAborted(txn2);
+    CheckTxnRowLockSize(txn2, oid, 0, 0);
+  }
+
+  txn_mgr.Commit(txn0);
+  CheckCommitted(txn0);
+  CheckTxnRowLockSize(txn0, oid, 0, 0);
+  txn_mgr.Abort(txn1);
+  txn_mgr.Abort(txn2);
+
+  delete txn0;
+  delete txn1;
+  delete txn2;
+}
+TEST(LockManagerTest, RowLocksTest) { RowLocksTest(); }  // NOLINT
+
 void TwoPLTest1() {
   LockManager lock_mgr{};
   TransactionManager txn_mgr{&lock_mgr};
@@ -2,8 +2,11 @@
  * extendible_hash_test.cpp
  */
 
+#include <atomic>
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
@@ -67,6 +70,71 @@ TEST(ExtendibleHashTableTest, ConcurrentInsertTest) {
     }
   }
 }
+TEST(ExtendibleHashTableTest, LargeBucketTest) {
+  // Scenario: buckets span several fingerprint groups, and values that are not trivially copyable are read latched.
+  auto table = std::make_unique<ExtendibleHashTable<int, std::string>>(40);
+  for (int i = 0; i < 1000; i++) {
+    table->Insert(i, std::to_string(i));
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    EXPECT_TRUE(table->Remove(i));
+  }
+  table->Insert(1, "one");
+  std::string result;
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(i % 2 == 1, table->Find(i, result));
+    if (i % 2 == 1) {
+      EXPECT_EQ(i == 1 ? "one" : std::to_string(i), result);
+    }
+  }
+}
+
+TEST(ExtendibleHashTableTest, ConcurrentFindTest) {
+  // Scenario: readers keep finding the keys inserted up front while writers split buckets and double the directory.
+  const int num_stable = 100;
+  const int num_writers = 2;
+  auto table = std::make_unique<ExtendibleHashTable<int, int>>(4);
+  for (int i = 0; i < num_stable; i++) {
+    table->Insert(i, i);
+  }
+
+  std::atomic<int> writers_done{0};
+  std::atomic<int> misses{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_writers; tid++) {
+    threads.emplace_back([tid, &table, &writers_done]() {
+      for (int i = num_stable + tid; i < 20000; i += num_writers) {
+        table->Insert(i, i);
+        if (i % 3 == 0) {
+          table->Remove(i);
+        }
+      }
+      writers_done++;
+    });
+  }
+  for (int tid = 0; tid < 2; tid++) {
+    threads.emplace_back([&table, &writers_done, &misses]() {
+      while (writers_done < num_writers) {
+        for (int i = 0; i < num_stable; i++) {
+          int val;
+          if (!table->Find(i, val) || val != i) {
+            misses++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(0, misses);
+  for (int i = num_stable; i < 20000; i++) {
+    int val;
+    EXPECT_EQ(i % 3 != 0, table->Find(i, val));
+  }
+}
+
 TEST(ExtendibleHashTableTest, AnotherTest) {
   auto table = std::make_unique<ExtendibleHashTable<int, int>>(2);
 
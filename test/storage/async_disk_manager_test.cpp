@@ -0,0 +1,215 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+
+namespace bustub {
+
+class AsyncDiskManagerTest : public ::testing::TestWithParam<bool> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("async_test.db");
+    remove("async_test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("async_test.db");
+    remove("async_test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ReadWritePageTest) {
+  const bool use_io_uring = GetParam();
+  const size_t queue_depth = 8;
+  const page_id_t num_pages = 100;
+  AsyncDiskManager dm("async_test.db", queue_depth, use_io_uring);
+  if (use_io_uring && !dm.UsesIoUring()) {
+    std::cout << "io_uring is unavailable, testing the thread pool twice" << std::endl;
+  }
+
+  // Scenario: a batch larger than the queue depth is written, and every callback reports success.
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<DiskRequest> requests;
+  std::vector<std::future<bool>> futures;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    snprintf(data[page_id].data(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    requests.push_back(DiskRequest{true, data[page_id].data(), page_id, {}});
+    futures.push_back(requests.back().callback_.get_future());
+  }
+  dm.SubmitBatch(&requests);
+  for (auto &future : futures) {
+    EXPECT_TRUE(future.get());
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Scenario: the pages read back asynchronously, and through the synchronous path, hold what was written.
+  std::vector<std::vector<char>> buffers(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  futures.clear();
+  for (page_id_t page_id = num_pages - 1; page_id >= 0; page_id--) {
+    futures.push_back(dm.ReadPageAsync(page_id, buffers[page_id].data()));
+  }
+  for (auto &future : futures) {
+    EXPECT_TRUE(future.get());
+  }
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    EXPECT_EQ(0, std::memcmp(data[page_id].data(), buffers[page_id].data(), BUSTUB_PAGE_SIZE));
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(0, std::memcmp(data[page_id].data(), buf, BUSTUB_PAGE_SIZE));
+  }
+
+  // Scenario: a run read with one ReadPages() call lands in scattered buffers, and reads as zeros past the end.
+  std::vector<std::vector<char>> run(8, std::vector<char>(BUSTUB_PAGE_SIZE, 'x'));
+  std::vector<char *> run_pages;
+  for (size_t i = run.size(); i > 0; i--) {
+    run_pages.push_back(run[i - 1].data());
+  }
+  dm.ReadPages(num_pages - 4, run_pages);
+  for (size_t i = 0; i < run_pages.size(); i++) {
+    const auto page_id = static_cast<page_id_t>(num_pages - 4 + i);
+    if (page_id < num_pages) {
+      EXPECT_EQ(0, std::memcmp(data[page_id].data(), run_pages[i], BUSTUB_PAGE_SIZE));
+    } else {
+      EXPECT_EQ(0, run_pages[i][0]);
+      EXPECT_EQ(0, run_pages[i][BUSTUB_PAGE_SIZE - 1]);
+    }
+  }
+
+  // Scenario: a page past the end of the file reads as zeros.
+  std::memset(buf, 'x', sizeof(buf));
+  EXPECT_TRUE(dm.ReadPageAsync(num_pages + 10, buf).get());
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+
+  // Scenario: WritePageAsync() overwrites a page.
+  std::strncpy(data[0].data(), "overwritten", BUSTUB_PAGE_SIZE);
+  EXPECT_TRUE(dm.WritePageAsync(0, data[0].data()).get());
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, std::strcmp("overwritten", buf));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, DirectIOTest) {
+  const bool use_io_uring = GetParam();
+  const page_id_t num_pages = 16;
+  AsyncDiskManager dm("async_test.db", 4, use_io_uring, true);
+
+  // Scenario: with O_DIRECT, pages written from unaligned buffers read back unchanged into unaligned buffers.
+  std::vector<char> data(num_pages * BUSTUB_PAGE_SIZE + 1);
+  std::vector<std::future<bool>> futures;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    char *page = &data[page_id * BUSTUB_PAGE_SIZE + 1];
+    snprintf(page, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    futures.push_back(dm.WritePageAsync(page_id, page));
+  }
+  for (auto &future : futures) {
+    EXPECT_TRUE(future.get());
+  }
+
+  std::vector<char> buffers(num_pages * BUSTUB_PAGE_SIZE + 1);
+  futures.clear();
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    futures.push_back(dm.ReadPageAsync(page_id, &buffers[page_id * BUSTUB_PAGE_SIZE + 1]));
+  }
+  for (auto &future : futures) {
+    EXPECT_TRUE(future.get());
+  }
+  EXPECT_EQ(0, std::memcmp(&data[1], &buffers[1], num_pages * BUSTUB_PAGE_SIZE));
+
+  // Scenario: ReadPages() into unaligned buffers falls back to reading through the aligned copy.
+  std::vector<char *> run_pages;
+  std::fill(buffers.begin(), buffers.end(), 0);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    run_pages.push_back(&buffers[page_id * BUSTUB_PAGE_SIZE + 1]);
+  }
+  dm.ReadPages(0, run_pages);
+  EXPECT_EQ(0, std::memcmp(&data[1], &buffers[1], num_pages * BUSTUB_PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+INSTANTIATE_TEST_SUITE_P(AsyncDiskManagerTest, AsyncDiskManagerTest, ::testing::Values(true, false));
+
+/**
+ * Random page reads against a local file, keeping queue_depth reads in flight, for io_uring and the thread pool.
+ */
+// NOLINTNEXTLINE
+TEST(AsyncDiskManagerBenchmark, DISABLED_IOPSBenchmark) {
+  const page_id_t num_pages = 16384;
+  const size_t num_reads = 65536;
+  remove("iops_test.db");
+  remove("iops_test.log");
+  {
+    AsyncDiskManager dm("iops_test.db");
+    std::vector<char> page(BUSTUB_PAGE_SIZE, 'x');
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      dm.WritePage(page_id, page.data());
+    }
+    dm.ShutDown();
+  }
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (bool use_io_uring : {true, false}) {
+    for (size_t queue_depth = 1; queue_depth <= 64; queue_depth *= 2) {
+      AsyncDiskManager dm("iops_test.db", queue_depth, use_io_uring);
+      if (use_io_uring && !dm.UsesIoUring()) {
+        std::cout << "io_uring is unavailable" << std::endl;
+        break;
+      }
+      std::mt19937 rng(0);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      auto buffers = std::make_unique<char[]>(queue_depth * BUSTUB_PAGE_SIZE);
+
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < num_reads; i += queue_depth) {
+        std::vector<DiskRequest> requests;
+        std::vector<std::future<bool>> futures;
+        for (size_t j = 0; j < queue_depth; j++) {
+          requests.push_back(DiskRequest{false, &buffers[j * BUSTUB_PAGE_SIZE], page_dist(rng), {}});
+          futures.push_back(requests.back().callback_.get_future());
+        }
+        dm.SubmitBatch(&requests);
+        for (auto &future : futures) {
+          future.wait();
+        }
+      }
+      auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      std::cout << (use_io_uring ? "io_uring" : "threads ") << " queue depth " << std::setw(2) << queue_depth
+                << ": " << std::fixed << std::setprecision(0) << static_cast<double>(num_reads) / elapsed << " IOPS"
+                << std::endl;
+      dm.ShutDown();
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+  remove("iops_test.db");
+  remove("iops_test.log");
+}
+
+}  // namespace bustub
@@ -7,7 +7,9 @@
 #include <functional>
 #include <future>  // NOLINT
 #include <iostream>
+#include <random>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -154,4 +156,210 @@ TEST(BPlusTreeTest, DISABLED_BPlusTreeContentionBenchmark2) {  // NOLINT
             << std::endl;
 }
 
+/** @return a tree of every other key in [0, num_keys), over bpm, which has the header page */
+auto BuildEvenKeyTree(BufferPoolManager *bpm, const GenericComparator<8> &comparator, int leaf_max_size,
+                      int internal_max_size, int64_t num_keys)
+    -> std::unique_ptr<BPlusTree<GenericKey<8>, RID, GenericComparator<8>>> {
+  auto tree = std::make_unique<BPlusTree<GenericKey<8>, RID, GenericComparator<8>>>("foo_pk", bpm, comparator,
+                                                                                    leaf_max_size, internal_max_size);
+  GenericKey<8> index_key;
+  Transaction transaction(0);
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    index_key.SetFromInteger(key);
+    tree->Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction);
+  }
+  return tree;
+}
+
+TEST(BPlusTreeTest, OptimisticReadTest) {  // NOLINT
+  // Scenario: readers that descend without latching find every key, and seek iterators to them, while writers split
+  // the pages under them.
+  const int64_t num_keys = 4000;
+  const size_t num_threads = 4;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManagerUnlimitedMemory disk_manager;
+  BufferPoolManagerInstance bpm(1024, &disk_manager);
+  page_id_t page_id;
+  bpm.NewPage(&page_id);
+  auto tree = BuildEvenKeyTree(&bpm, comparator, 4, 4, num_keys);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; i++) {
+    // Writers insert the odd keys.
+    threads.emplace_back([&, i]() {
+      GenericKey<8> index_key;
+      Transaction transaction(static_cast<txn_id_t>(i + 1));
+      for (int64_t key = 2 * i + 1; key < num_keys; key += 2 * num_threads) {
+        index_key.SetFromInteger(key);
+        tree->Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction);
+      }
+    });
+    // Readers look up the even ones.
+    threads.emplace_back([&, i]() {
+      GenericKey<8> index_key;
+      std::vector<RID> result;
+      for (int round = 0; round < 4; round++) {
+        for (int64_t key = 2 * i; key < num_keys; key += 2 * num_threads) {
+          index_key.SetFromInteger(key);
+          result.clear();
+          ASSERT_TRUE(tree->GetValue(index_key, &result)) << key;
+          ASSERT_EQ(RID(0, static_cast<uint32_t>(key)), result[0]);
+        }
+        // Seek to one of them and scan to the end, which lets go of the last leaf, over keys in order.
+        index_key.SetFromInteger(2 * static_cast<int64_t>(i));
+        auto iterator = tree->Begin(index_key);
+        ASSERT_FALSE(iterator.IsEnd());
+        int64_t last_key = (*iterator).first.ToString();
+        ASSERT_EQ(2 * static_cast<int64_t>(i), last_key);
+        for (++iterator; !iterator.IsEnd(); ++iterator) {
+          ASSERT_LT(last_key, (*iterator).first.ToString());
+          last_key = (*iterator).first.ToString();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  GenericKey<8> index_key;
+  std::vector<RID> result;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    result.clear();
+    ASSERT_TRUE(tree->GetValue(index_key, &result)) << key;
+  }
+  bpm.UnpinPage(HEADER_PAGE_ID, true);
+}
+
+TEST(BPlusTreeTest, OptimisticWriteTest) {  // NOLINT
+  // Scenario: writers that latch only the leaf, and crab down when it would split, insert the odd keys concurrently,
+  // and leave every key in order.
+  const int64_t num_keys = 4000;
+  const size_t num_threads = 4;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManagerUnlimitedMemory disk_manager;
+  BufferPoolManagerInstance bpm(1024, &disk_manager);
+  page_id_t page_id;
+  bpm.NewPage(&page_id);
+  auto tree = BuildEvenKeyTree(&bpm, comparator, 8, 8, num_keys);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, i]() {
+      GenericKey<8> index_key;
+      Transaction transaction(static_cast<txn_id_t>(i + 1));
+      for (int64_t key = 2 * i + 1; key < num_keys; key += 2 * num_threads) {
+        index_key.SetFromInteger(key);
+        ASSERT_TRUE(tree->Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction)) << key;
+        // Inserting it again finds it, in whichever leaf it went to.
+        ASSERT_FALSE(tree->Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction)) << key;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  GenericKey<8> index_key;
+  std::vector<RID> result;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    result.clear();
+    ASSERT_TRUE(tree->GetValue(index_key, &result)) << key;
+    ASSERT_EQ(RID(0, static_cast<uint32_t>(key)), result[0]);
+  }
+  int64_t next_key = 0;
+  for (auto iterator = tree->Begin(); !iterator.IsEnd(); ++iterator) {
+    ASSERT_EQ(next_key++, (*iterator).first.ToString());
+  }
+  ASSERT_EQ(num_keys, next_key);
+  bpm.UnpinPage(HEADER_PAGE_ID, true);
+}
+
+TEST(BPlusTreeTest, DISABLED_BPlusTreeReadScalabilityBenchmark) {  // NOLINT
+  const int64_t num_keys = 1000000;
+  const int lookups_per_thread = 100000;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  DiskManagerUnlimitedMemory disk_manager;
+  BufferPoolManagerInstance bpm(num_keys / 64, &disk_manager);
+  page_id_t page_id;
+  bpm.NewPage(&page_id);
+  const int leaf_max_size = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>::MaxSizeFor(BUSTUB_PAGE_SIZE);
+  const int internal_max_size =
+      BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>::MaxSizeFor(BUSTUB_PAGE_SIZE);
+  auto tree = BuildEvenKeyTree(&bpm, comparator, leaf_max_size, internal_max_size, num_keys);
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_threads : {1, 2, 4, 8, 16, 32}) {
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_threads; i++) {
+      threads.emplace_back([&, i]() {
+        std::mt19937_64 rng(i);
+        GenericKey<8> index_key;
+        std::vector<RID> result;
+        for (int j = 0; j < lookups_per_thread; j++) {
+          index_key.SetFromInteger(static_cast<int64_t>(rng() % (num_keys / 2)) * 2);
+          result.clear();
+          tree->GetValue(index_key, &result);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << num_threads << " threads: " << num_threads * lookups_per_thread / seconds / 1000000
+              << " M GetValue per second" << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+  bpm.UnpinPage(HEADER_PAGE_ID, true);
+}
+
+TEST(BPlusTreeTest, DISABLED_BPlusTreeInsertScalabilityBenchmark) {  // NOLINT
+  const int64_t keys_per_thread = 100000;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int leaf_max_size = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>::MaxSizeFor(BUSTUB_PAGE_SIZE);
+  const int internal_max_size =
+      BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>::MaxSizeFor(BUSTUB_PAGE_SIZE);
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_threads : {1, 2, 4, 8, 16, 32}) {
+    DiskManagerUnlimitedMemory disk_manager;
+    BufferPoolManagerInstance bpm(num_threads * keys_per_thread / 64, &disk_manager);
+    page_id_t page_id;
+    bpm.NewPage(&page_id);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", &bpm, comparator, leaf_max_size,
+                                                             internal_max_size);
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_threads; i++) {
+      // Each thread inserts its own random keys, spread over the whole tree.
+      threads.emplace_back([&, i]() {
+        std::mt19937_64 rng(i);
+        GenericKey<8> index_key;
+        Transaction transaction(static_cast<txn_id_t>(i + 1));
+        for (int64_t j = 0; j < keys_per_thread; j++) {
+          const int64_t key = static_cast<int64_t>(rng() >> 8) * static_cast<int64_t>(num_threads) + i;
+          index_key.SetFromInteger(key);
+          tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << num_threads << " threads: " << num_threads * keys_per_thread / seconds / 1000000
+              << " M Insert per second" << std::endl;
+    bpm.UnpinPage(HEADER_PAGE_ID, true);
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
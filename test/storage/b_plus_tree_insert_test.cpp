@@ -102,9 +102,10 @@ TEST(BPlusTreeTests, InsertTest2) {
     EXPECT_EQ(false, tree.Insert(index_key, rid, transaction));
   }
   index_key.SetFromInteger(1);
+  auto *leaf_page = tree.FindLeaf(index_key);
+  ASSERT_NE(nullptr, leaf_page);
   auto leaf_node =
-      reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(tree.FindLeaf(index_key));
-  ASSERT_NE(nullptr, leaf_node);
+      reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(leaf_page->GetData());
   EXPECT_EQ(1, leaf_node->GetSize());
   EXPECT_EQ(2, leaf_node->GetMaxSize());
 
@@ -112,7 +113,7 @@ TEST(BPlusTreeTests, InsertTest2) {
   for (int i = 0; i < 4; i++) {
     EXPECT_NE(INVALID_PAGE_ID, leaf_node->GetNextPageId());
     leaf_node = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(
-        bpm->FetchPage(leaf_node->GetNextPageId()));
+        bpm->FetchPage(leaf_node->GetNextPageId())->GetData());
   }
 
   EXPECT_EQ(INVALID_PAGE_ID, leaf_node->GetNextPageId());
@@ -171,4 +172,67 @@ TEST(BPlusTreeTests, InsertTest3) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, LargePageTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  // a pool of few 16 KiB pages, so that the tree is evicted and read back while it grows
+  const size_t page_size = 16 * 1024;
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm =
+      new BufferPoolManagerInstance(10, disk_manager, LRUK_REPLACER_K, nullptr, ReplacerPolicy::LRU_K, page_size);
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+  EXPECT_GT(LeafPage::MaxSizeFor(page_size), 4 * LeafPage::MaxSizeFor(BUSTUB_PAGE_SIZE));
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator,
+                                                           LeafPage::MaxSizeFor(page_size),
+                                                           InternalPage::MaxSizeFor(page_size));
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key < 20000; key++) {
+    keys.push_back(key);
+  }
+  auto rng = std::default_random_engine{};
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key & 0xFFFFFFFF);
+  }
+
+  // the root of 20000 keys in 16 KiB pages is an internal page over a few dozen leaves
+  auto *root_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(tree.GetRootPageId())->GetData());
+  EXPECT_FALSE(root_page->IsLeafPage());
+  EXPECT_LT(root_page->GetSize(), 64);
+  bpm->UnpinPage(tree.GetRootPageId(), false);
+
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -0,0 +1,238 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_search_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** @return the key of key_schema whose first column is value and whose others are zero, as an index sets it */
+auto MakeKey(const Schema &key_schema, int64_t value) -> GenericKey<8> {
+  const TypeId type = key_schema.GetColumn(0).GetType();
+  std::vector<Value> values;
+  switch (type) {
+    case TypeId::SMALLINT:
+      values.emplace_back(type, static_cast<int16_t>(value));
+      break;
+    case TypeId::INTEGER:
+      values.emplace_back(type, static_cast<int32_t>(value));
+      break;
+    default:
+      values.emplace_back(type, value);
+      break;
+  }
+  for (uint32_t i = 1; i < key_schema.GetColumnCount(); i++) {
+    values.push_back(ValueFactory::GetZeroValueByType(key_schema.GetColumn(i).GetType()));
+  }
+  GenericKey<8> key;
+  key.SetFromKey(Tuple(values, &key_schema), key_schema);
+  return key;
+}
+
+/** The index of the child of key in the internal page of keys, keys[0] being the unused first key: a linear scan. */
+auto ReferenceFind(const std::vector<int64_t> &keys, int64_t key) -> int {
+  int i = 1;
+  while (i < static_cast<int>(keys.size()) && keys[i] <= key) {
+    i++;
+  }
+  return i - 1;
+}
+
+/** The index of the first of keys, from first on, not less than key: a linear scan. */
+auto ReferenceKeyIndex(const std::vector<int64_t> &keys, int first, int64_t key) -> int {
+  int i = first;
+  while (i < static_cast<int>(keys.size()) && keys[i] < key) {
+    i++;
+  }
+  return i;
+}
+
+/** Check the searches of pages of every size up to the largest against linear scans, with keys in [low, high]. */
+void CheckSearches(const std::string &key_schema_text, int64_t low, int64_t high) {
+  auto key_schema = ParseCreateStatement(key_schema_text);
+  GenericComparator<8> comparator(key_schema.get());
+  std::mt19937_64 rng(15445);
+  std::uniform_int_distribution<int64_t> distribution(low, high);
+  auto internal_data = std::make_unique<char[]>(BUSTUB_PAGE_SIZE);
+  auto leaf_data = std::make_unique<char[]>(BUSTUB_PAGE_SIZE);
+  auto *internal_page = reinterpret_cast<InternalPage *>(internal_data.get());
+  auto *leaf_page = reinterpret_cast<LeafPage *>(leaf_data.get());
+
+  const int leaf_max_size = LeafPage::MaxSizeFor(BUSTUB_PAGE_SIZE);
+  for (int size = 1; size <= InternalPage::MaxSizeFor(BUSTUB_PAGE_SIZE); size++) {
+    std::set<int64_t> distinct;
+    while (static_cast<int>(distinct.size()) < size) {
+      distinct.insert(distribution(rng));
+    }
+    const std::vector<int64_t> keys(distinct.begin(), distinct.end());
+    internal_page->Init(1, INVALID_PAGE_ID, size);
+    leaf_page->Init(2, INVALID_PAGE_ID, leaf_max_size);
+    for (int i = 0; i < size; i++) {
+      internal_page->InsertLast(MakeKey(*key_schema, keys[i]), i);
+      if (i < leaf_max_size) {
+        leaf_page->InsertLast(MakeKey(*key_schema, keys[i]), RID(i, 0));
+      }
+    }
+    const std::vector<int64_t> leaf_keys(keys.begin(), keys.begin() + std::min(size, leaf_max_size));
+
+    // The keys, those next to them, and the ones outside them all.
+    std::vector<int64_t> probes{low, high};
+    for (int64_t key : keys) {
+      probes.push_back(key);
+      probes.push_back(std::max(key, low + 1) - 1);
+      probes.push_back(std::min(key, high - 1) + 1);
+    }
+    for (int64_t probe : probes) {
+      const GenericKey<8> key = MakeKey(*key_schema, probe);
+      ASSERT_EQ(ReferenceFind(keys, probe), internal_page->Find(key, comparator)) << size << " " << probe;
+      ASSERT_EQ(ReferenceKeyIndex(keys, 1, probe), internal_page->KeyIndex(key, comparator)) << size << " " << probe;
+      ASSERT_EQ(ReferenceKeyIndex(leaf_keys, 0, probe), leaf_page->KeyIndex(key, comparator)) << size << " " << probe;
+    }
+  }
+}
+
+/** @return a tree of keys [0, num_keys), with every key as its value, over bpm, which has the header page */
+template <size_t KeySize>
+auto BuildTree(const std::string &name, BufferPoolManager *bpm, const GenericComparator<KeySize> &comparator,
+               int64_t num_keys) -> std::unique_ptr<BPlusTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>>> {
+  auto tree =
+      std::make_unique<BPlusTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>>>(name, bpm, comparator);
+  GenericKey<KeySize> index_key;
+  Transaction transaction(0);
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    tree->Insert(index_key, RID(static_cast<int32_t>(key >> 32), static_cast<int32_t>(key)), &transaction);
+  }
+  return tree;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeSearchTest, IntegerKeyTest) {
+  // Scenario: the searches of integer keys, compared as integers, match a scan with the comparator.
+  CheckSearches("a bigint", -1000000000000LL, 1000000000000LL);
+  CheckSearches("a int", INT32_MIN + 1, INT32_MAX);
+  CheckSearches("a smallint", INT16_MIN + 1, INT16_MAX);
+  CheckSearches("a bigint", -5, 1000);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeSearchTest, GenericKeyTest) {
+  // Scenario: keys of several columns go through the comparator, and find the same.
+  CheckSearches("a int,b int", -1000000, 1000000);
+  CheckSearches("a smallint,b smallint,c smallint", INT16_MIN + 1, INT16_MAX);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeSearchTest, DISABLED_GetValueBenchmark) {
+  const int num_lookups = 200000;
+  std::cout << "<<< BEGIN" << std::endl;
+
+  // A full internal page: a linear scan against the binary searches, through the comparator and as integers.
+  {
+    const int size = InternalPage::MaxSizeFor(BUSTUB_PAGE_SIZE);
+    const auto time = [&](const char *name, const std::string &key_schema_text, bool linear) {
+      auto key_schema = ParseCreateStatement(key_schema_text);
+      GenericComparator<8> comparator(key_schema.get());
+      auto data = std::make_unique<char[]>(BUSTUB_PAGE_SIZE);
+      auto *page = reinterpret_cast<InternalPage *>(data.get());
+      page->Init(1, INVALID_PAGE_ID, size);
+      for (int i = 0; i < size; i++) {
+        page->InsertLast(MakeKey(*key_schema, i * 2), i);
+      }
+      std::mt19937 rng(15445);
+      std::vector<GenericKey<8>> keys;
+      for (int i = 0; i < num_lookups / 10; i++) {
+        keys.push_back(MakeKey(*key_schema, static_cast<int64_t>(rng() % (size * 2))));
+      }
+      const auto start = std::chrono::steady_clock::now();
+      int64_t sum = 0;
+      for (const auto &key : keys) {
+        if (linear) {
+          int i = 1;
+          while (i < page->GetSize() && comparator(page->KeyAt(i), key) <= 0) {
+            i++;
+          }
+          sum += page->ValueAt(i - 1);
+        } else {
+          sum += page->Find(key, comparator);
+        }
+      }
+      const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "page of " << size << " keys, " << name << ": " << ns / keys.size() << " ns per Find (" << sum
+                << ")" << std::endl;
+    };
+    time("linear scan", "a int,b int", true);
+    time("binary search", "a int,b int", false);
+    time("integer search", "a bigint", false);
+  }
+
+  // GetValue() on trees of a single integer column, and of two columns, which the comparator searches.
+  for (int64_t num_keys : {1000000, 10000000}) {
+    std::mt19937_64 rng(15445);
+    std::vector<int64_t> lookups;
+    for (int i = 0; i < num_lookups; i++) {
+      lookups.push_back(static_cast<int64_t>(rng() % num_keys));
+    }
+    const auto time = [&](const char *name, auto *tree, auto index_key) {
+      std::vector<RID> result;
+      const auto start = std::chrono::steady_clock::now();
+      for (int64_t key : lookups) {
+        index_key.SetFromInteger(key);
+        result.clear();
+        EXPECT_TRUE(tree->GetValue(index_key, &result));
+      }
+      const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      std::cout << num_keys << " keys, " << name << ": " << ns / num_lookups << " ns per GetValue" << std::endl;
+    };
+    DiskManagerUnlimitedMemory disk_manager;
+    BufferPoolManagerInstance bpm(num_keys / 64, &disk_manager);
+    page_id_t header_page_id;
+    bpm.NewPage(&header_page_id);
+    {
+      auto key_schema = ParseCreateStatement("a bigint");
+      GenericComparator<8> comparator(key_schema.get());
+      auto tree = BuildTree("integer", &bpm, comparator, num_keys);
+      time("integer keys", tree.get(), GenericKey<8>{});
+    }
+    {
+      auto key_schema = ParseCreateStatement("a bigint,b int");
+      GenericComparator<16> comparator(key_schema.get());
+      auto tree = BuildTree("two_column", &bpm, comparator, num_keys);
+      time("two column keys", tree.get(), GenericKey<16>{});
+    }
+    bpm.UnpinPage(header_page_id, true);
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
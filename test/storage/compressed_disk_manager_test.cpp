@@ -0,0 +1,237 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_disk_manager_test.cpp
+//
+// Identification: test/storage/compressed_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "storage/disk/compressed_disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** The rows of an access log: an id, a timestamp, a level and a request line. */
+auto LogSchema() -> Schema {
+  return Schema({Column{"id", TypeId::BIGINT}, Column{"ts", TypeId::BIGINT}, Column{"level", TypeId::VARCHAR, 8},
+                 Column{"message", TypeId::VARCHAR, 64}});
+}
+
+/**
+ * Append num_rows log rows to a new table heap over disk_manager, and flush them.
+ * @return the first page of the table heap
+ */
+auto WriteLogTable(DiskManager *disk_manager, const Schema &schema, int num_rows) -> page_id_t {
+  // Large enough for the whole table, as TableHeap::InsertTuple() walks every page.
+  BufferPoolManagerInstance bpm(num_rows / 20, disk_manager);
+  Transaction txn(0);
+  TableHeap table(&bpm, nullptr, nullptr, &txn);
+  std::mt19937 rng(15445);
+  for (int i = 0; i < num_rows; i++) {
+    const std::string level = rng() % 10 == 0 ? "WARN" : "INFO";
+    const std::string message =
+        fmt::format("GET /api/v1/items/{} HTTP/1.1 200 {}ms", rng() % 1000, rng() % 100);
+    Tuple tuple({ValueFactory::GetBigIntValue(i), ValueFactory::GetBigIntValue(1668000000000 + i * 7 + rng() % 7),
+                 ValueFactory::GetVarcharValue(level.c_str(), false),
+                 ValueFactory::GetVarcharValue(message.c_str(), false)},
+                &schema);
+    RID rid;
+    EXPECT_TRUE(table.InsertTuple(tuple, &rid, &txn));
+  }
+  bpm.FlushAllPages();
+  return table.GetFirstPageId();
+}
+
+/** @return the number of rows of the table heap, read through a new, cold buffer pool */
+auto ScanLogTable(DiskManager *disk_manager, page_id_t first_page_id) -> int {
+  BufferPoolManagerInstance bpm(16, disk_manager);
+  Transaction txn(0);
+  TableHeap table(&bpm, nullptr, nullptr, first_page_id);
+  int num_rows = 0;
+  for (auto iter = table.Begin(&txn); iter != table.End(); ++iter) {
+    num_rows++;
+  }
+  return num_rows;
+}
+
+}  // namespace
+
+class CompressedDiskManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override { RemoveFiles(); }
+
+  // This function is called after every test.
+  void TearDown() override { RemoveFiles(); };
+
+  void RemoveFiles() {
+    for (const char *file : {"compressed_test.db", "compressed_test.log", "compressed_test.map",
+                             "compressed_test.crc", "plain_test.db", "plain_test.log"}) {
+      remove(file);
+    }
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(CompressedDiskManagerTest, ReadWriteTest) {
+  char text[BUSTUB_PAGE_SIZE];
+  char noise[BUSTUB_PAGE_SIZE];
+  char buf[BUSTUB_PAGE_SIZE];
+  std::mt19937 rng(15445);
+  for (size_t i = 0; i < BUSTUB_PAGE_SIZE; i++) {
+    text[i] = "2022-11-09 INFO request served\n"[i % 31];
+    noise[i] = static_cast<char>(rng());
+  }
+  const size_t slot = CompressedDiskManager::SLOT_SIZE;
+
+  auto dm = std::make_unique<CompressedDiskManager>("compressed_test.db", PageChecksumMode::CHECKSUM);
+  // Scenario: a page that was never written reads as zeros.
+  std::memset(buf, 'x', sizeof(buf));
+  dm->ReadPage(3, buf);
+  EXPECT_TRUE(std::all_of(buf, buf + BUSTUB_PAGE_SIZE, [](char byte) { return byte == 0; }));
+
+  // Scenario: a text page takes a slot, random bytes are stored as they are.
+  dm->WritePage(0, text);
+  dm->WritePage(1, noise);
+  EXPECT_EQ(slot + BUSTUB_PAGE_SIZE, dm->GetFileBytes());
+  dm->ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf, text, BUSTUB_PAGE_SIZE));
+  dm->ReadPage(1, buf);
+  EXPECT_EQ(0, std::memcmp(buf, noise, BUSTUB_PAGE_SIZE));
+
+  // Scenario: pages that change size move, and the slots they leave are reused.
+  dm->WritePage(0, noise);
+  dm->WritePage(1, text);
+  EXPECT_EQ(slot + 2 * BUSTUB_PAGE_SIZE, dm->GetFileBytes());
+  dm->WritePage(2, text);
+  EXPECT_EQ(slot + 2 * BUSTUB_PAGE_SIZE, dm->GetFileBytes());
+  dm->ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf, noise, BUSTUB_PAGE_SIZE));
+  dm->ReadPage(1, buf);
+  EXPECT_EQ(0, std::memcmp(buf, text, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(3, dm->GetNumPages());
+  dm->ShutDown();
+
+  // Scenario: the page map survives a restart, and so do the free slots.
+  dm = std::make_unique<CompressedDiskManager>("compressed_test.db", PageChecksumMode::CHECKSUM);
+  EXPECT_EQ(3, dm->GetNumPages());
+  dm->ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf, noise, BUSTUB_PAGE_SIZE));
+  dm->ReadPage(2, buf);
+  EXPECT_EQ(0, std::memcmp(buf, text, BUSTUB_PAGE_SIZE));
+  const size_t file_bytes = dm->GetFileBytes();
+  dm->WritePage(3, text);
+  EXPECT_EQ(file_bytes, dm->GetFileBytes());
+  dm->ReadPage(3, buf);
+  EXPECT_EQ(0, std::memcmp(buf, text, BUSTUB_PAGE_SIZE));
+
+  // Scenario: the checksums are those of the pages, and they catch a damaged compressed page.
+  EXPECT_EQ(0U, dm->GetNumCorruptPages());
+  dm->ShutDown();
+  {
+    FILE *file = fopen("compressed_test.db", "r+b");
+    ASSERT_NE(nullptr, file);
+    std::vector<char> data(file_bytes);
+    ASSERT_EQ(data.size(), fread(data.data(), 1, data.size(), file));
+    // Damage every slot but those of the pages of random bytes, which are stored as they are.
+    for (size_t offset = 0; offset < data.size(); offset += slot) {
+      bool is_noise = false;
+      for (size_t i = 0; i < CompressedDiskManager::SLOTS_PER_PAGE; i++) {
+        is_noise = is_noise || std::memcmp(data.data() + offset, noise + i * slot, slot) == 0;
+      }
+      if (!is_noise) {
+        fseek(file, static_cast<long>(offset + 20), SEEK_SET);  // NOLINT
+        fputc(data[offset + 20] ^ 0x55, file);
+      }
+    }
+    fclose(file);
+  }
+  dm = std::make_unique<CompressedDiskManager>("compressed_test.db", PageChecksumMode::CHECKSUM);
+  dm->ReadPage(2, buf);
+  EXPECT_NE(0, std::memcmp(buf, text, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(1U, dm->GetNumCorruptPages());
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompressedDiskManagerTest, LogTableTest) {
+  const Schema schema = LogSchema();
+  const int num_rows = 5000;
+
+  DiskManager plain("plain_test.db");
+  const page_id_t plain_first_page_id = WriteLogTable(&plain, schema, num_rows);
+  const size_t plain_bytes = static_cast<size_t>(plain.GetNumPages()) * BUSTUB_PAGE_SIZE;
+
+  CompressedDiskManager compressed("compressed_test.db");
+  const page_id_t first_page_id = WriteLogTable(&compressed, schema, num_rows);
+  EXPECT_EQ(plain.GetNumPages(), compressed.GetNumPages());
+
+  // Scenario: the log takes a fraction of the space, and a scan reads a fraction of the bytes.
+  EXPECT_EQ(num_rows, ScanLogTable(&plain, plain_first_page_id));
+  const uint64_t bytes_read = compressed.GetBytesRead();
+  EXPECT_EQ(num_rows, ScanLogTable(&compressed, first_page_id));
+  const double footprint_ratio = static_cast<double>(plain_bytes) / compressed.GetFileBytes();
+  const double read_ratio = static_cast<double>(plain_bytes) / (compressed.GetBytesRead() - bytes_read);
+  std::cout << "footprint " << plain_bytes << " -> " << compressed.GetFileBytes() << " bytes (" << footprint_ratio
+            << "x), scan reads " << compressed.GetBytesRead() - bytes_read << " bytes (" << read_ratio << "x)"
+            << std::endl;
+  EXPECT_GE(footprint_ratio, 2);
+  EXPECT_GE(read_ratio, 2);
+
+  plain.ShutDown();
+  compressed.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompressedDiskManagerTest, DISABLED_CompressionBenchmark) {
+  const Schema schema = LogSchema();
+  const int num_rows = 20000;
+  const int num_scans = 5;
+
+  std::cout << "<<< BEGIN" << std::endl;
+  DiskManager plain("plain_test.db");
+  CompressedDiskManager compressed("compressed_test.db");
+  for (DiskManager *dm : {static_cast<DiskManager *>(&plain), static_cast<DiskManager *>(&compressed)}) {
+    auto start = std::chrono::steady_clock::now();
+    const page_id_t first_page_id = WriteLogTable(dm, schema, num_rows);
+    const double write_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_scans; i++) {
+      EXPECT_EQ(num_rows, ScanLogTable(dm, first_page_id));
+    }
+    const double scan_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / num_scans;
+    std::cout << (dm == &plain ? "plain" : "compressed") << ": write " << write_ms << " ms, scan " << scan_ms
+              << " ms" << std::endl;
+  }
+  const size_t plain_bytes = static_cast<size_t>(plain.GetNumPages()) * BUSTUB_PAGE_SIZE;
+  std::cout << "footprint " << plain_bytes << " -> " << compressed.GetFileBytes() << " bytes, "
+            << static_cast<double>(plain_bytes) / compressed.GetFileBytes() << "x" << std::endl;
+  std::cout << ">>> END" << std::endl;
+  plain.ShutDown();
+  compressed.ShutDown();
+}
+
+}  // namespace bustub
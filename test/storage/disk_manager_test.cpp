@@ -10,11 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "common/crc32c.h"
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/page_scrubber.h"
 
 namespace bustub {
 
@@ -24,13 +34,23 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.crc");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.crc");
   };
+
+  /** Overwrite bytes of the database file behind the disk manager's back. */
+  static void Scribble(size_t offset, char byte, size_t size) {
+    std::fstream file("test.db", std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    std::string bytes(size, byte);
+    file.write(bytes.data(), static_cast<std::streamsize>(size));
+  }
 };
 
 // NOLINTNEXTLINE
@@ -55,6 +75,32 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIOTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, true);
+  if (!dm.UsesDirectIO()) {
+    std::cout << "the file system does not support O_DIRECT, testing buffered I/O" << std::endl;
+  }
+  alignas(BUSTUB_PAGE_SIZE) char aligned[BUSTUB_PAGE_SIZE] = {0};
+  char unaligned_data[BUSTUB_PAGE_SIZE + 1] = {0};
+  char *unaligned = unaligned_data + 1;
+
+  // Scenario: aligned and unaligned buffers both write and read back a page.
+  std::strncpy(aligned, "An aligned page.", sizeof(aligned));
+  dm.WritePage(0, aligned);
+  std::strncpy(unaligned, "An unaligned page.", BUSTUB_PAGE_SIZE);
+  dm.WritePage(1, unaligned);
+
+  dm.ReadPage(1, aligned);
+  EXPECT_EQ(0, std::strcmp("An unaligned page.", aligned));
+  dm.ReadPage(0, unaligned);
+  EXPECT_EQ(0, std::strcmp("An aligned page.", unaligned));
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +118,160 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, false, PageChecksumMode::CHECKSUM);
+
+  // Scenario: pages read back as written verify.
+  std::memset(data, 'a', sizeof(data));
+  dm.WritePage(0, data);
+  dm.WritePage(1, data);
+  dm.WritePage(2, data);
+  std::memset(data, 'b', sizeof(data));
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  EXPECT_EQ(PageStatus::OK, dm.VerifyPage(0, buf));
+  EXPECT_EQ(PageStatus::UNCHECKED, dm.VerifyPage(3, buf));
+
+  // Scenario: a page with some sectors of its last version and some of the one before is torn.
+  Scribble(3 * 512, 'a', 512);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(1U, dm.GetNumTornPages());
+  EXPECT_EQ(PageStatus::TORN, dm.VerifyPage(0, buf));
+
+  // Scenario: a flipped byte is corrupt.
+  Scribble(BUSTUB_PAGE_SIZE + 100, 'z', 1);
+  dm.ReadPage(1, buf);
+  EXPECT_EQ(1U, dm.GetNumCorruptPages());
+
+  // Scenario: the checksums outlive the disk manager, and a file cut short is a write that did not complete.
+  dm.ShutDown();
+  std::filesystem::resize_file(db_file, 2 * BUSTUB_PAGE_SIZE + 1024);
+  auto reopened = DiskManager(db_file, false, PageChecksumMode::CHECKSUM);
+  reopened.ReadPage(1, buf);
+  EXPECT_EQ(1U, reopened.GetNumCorruptPages());
+  reopened.ReadPage(2, buf);
+  EXPECT_EQ(1U, reopened.GetNumTornPages());
+  std::memset(data, 'c', sizeof(data));
+  reopened.WritePage(2, data);
+  reopened.ReadPage(2, buf);
+  EXPECT_EQ(PageStatus::OK, reopened.VerifyPage(2, buf));
+  EXPECT_EQ(1U, reopened.GetNumTornPages());
+  reopened.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, StaleChecksumFileTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  std::memset(data, 'a', sizeof(data));
+  {
+    auto dm = DiskManager(db_file, false, PageChecksumMode::CHECKSUM);
+    dm.WritePage(0, data);
+    dm.WritePage(1, data);
+    dm.ShutDown();
+  }
+
+  // Scenario: the checksums of a database file that was replaced by another are discarded, not its pages.
+  std::memset(data, 'b', sizeof(data));
+  {
+    std::ofstream file("test.db.new", std::ios::binary);
+    file.write(data, sizeof(data));
+  }
+  std::filesystem::rename("test.db.new", db_file);
+  auto dm = DiskManager(db_file, false, PageChecksumMode::CHECKSUM);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(PageStatus::UNCHECKED, dm.VerifyPage(0, buf));
+  EXPECT_EQ(0U, dm.GetNumCorruptPages());
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(PageStatus::OK, dm.VerifyPage(0, buf));
+  dm.ShutDown();
+
+  // Scenario: the checksums written since are of this database file, and kept.
+  auto reopened = DiskManager(db_file, false, PageChecksumMode::CHECKSUM);
+  reopened.ReadPage(0, buf);
+  EXPECT_EQ(PageStatus::OK, reopened.VerifyPage(0, buf));
+  EXPECT_EQ(0U, reopened.GetNumCorruptPages());
+  reopened.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageScrubberTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, false, PageChecksumMode::CHECKSUM);
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    std::memset(data, 'a' + page_id, sizeof(data));
+    dm.WritePage(page_id, data);
+  }
+  Scribble(5 * BUSTUB_PAGE_SIZE + 7, 'z', 1);
+
+  // Scenario: the pages just written are skipped once, then the scrubber finds the damaged one.
+  {
+    PageScrubber scrubber(&dm, 1000);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (scrubber.GetNumPasses() < 2 && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_LE(2U, scrubber.GetNumPasses());
+    EXPECT_EQ(std::vector<page_id_t>{5}, scrubber.GetBadPages());
+    EXPECT_LE(1U, dm.GetNumCorruptPages());
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_ChecksumBenchmark) {
+  const page_id_t num_pages = 4096;
+  const size_t num_reads = 20000;
+  std::string db_file("test.db");
+  alignas(BUSTUB_PAGE_SIZE) static char data[BUSTUB_PAGE_SIZE];
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::generate(data, data + BUSTUB_PAGE_SIZE, [&] { return static_cast<char>(byte(rng)); });
+
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "crc32c hardware: " << Crc32c::UsesHardware() << std::endl;
+  // The same random reads through O_DIRECT, so that they reach the device, with and without checksums.
+  double read_ns[2];
+  for (int with_checksums = 0; with_checksums < 2; with_checksums++) {
+    auto dm = DiskManager(db_file, true, with_checksums != 0 ? PageChecksumMode::CHECKSUM : PageChecksumMode::NONE);
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      dm.WritePage(page_id, data);
+    }
+    std::uniform_int_distribution<page_id_t> page(0, num_pages - 1);
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_reads; i++) {
+      dm.ReadPage(page(rng), data);
+    }
+    read_ns[with_checksums] =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / num_reads;
+    std::cout << (with_checksums != 0 ? "checksums" : "no checksums") << (dm.UsesDirectIO() ? " (O_DIRECT)" : "")
+              << ": " << read_ns[with_checksums] << " ns per read" << std::endl;
+    EXPECT_EQ(0U, dm.GetNumCorruptPages());
+    dm.ShutDown();
+    remove("test.crc");
+  }
+
+  // What verifying costs by itself.
+  uint32_t crcs[BUSTUB_PAGE_SIZE / 512];
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_reads; i++) {
+    Crc32c::ComputeBlocks(data, 512, BUSTUB_PAGE_SIZE / 512, crcs);
+  }
+  const double crc_ns =
+      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / num_reads;
+  std::cout << "verify: " << crc_ns << " ns per page, " << 100 * crc_ns / read_ns[0] << "% of a read" << std::endl;
+  std::cout << "read overhead: " << 100 * (read_ns[1] - read_ns[0]) / read_ns[0] << "%" << std::endl;
+  std::cout << ">>> END" << std::endl;
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -0,0 +1,245 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_comparator_test.cpp
+//
+// Identification: test/storage/generic_comparator_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return a random value of type, from a range narrow enough that equal ones are common, and NULL if nulls */
+auto RandomValue(TypeId type, bool nulls, std::mt19937_64 *rng) -> Value {
+  const auto draw = [&](int64_t low, int64_t high) {
+    return std::uniform_int_distribution<int64_t>(low, high)(*rng);
+  };
+  if (nulls && draw(0, 9) == 0) {
+    return ValueFactory::GetNullValueByType(type);
+  }
+  switch (type) {
+    case TypeId::BOOLEAN:
+      return Value(type, static_cast<int8_t>(draw(0, 1)));
+    case TypeId::TINYINT:
+      return Value(type, static_cast<int8_t>(draw(-5, 5)));
+    case TypeId::SMALLINT:
+      return Value(type, static_cast<int16_t>(draw(-5, 5)));
+    case TypeId::INTEGER:
+      return Value(type, static_cast<int32_t>(draw(-20, 20) * 100000000));
+    case TypeId::BIGINT:
+      return Value(type, static_cast<int64_t>(draw(-20, 20) * 100000000000LL));
+    case TypeId::DECIMAL:
+      return Value(type, static_cast<double>(draw(-20, 20)) / 4);
+    default: {
+      // Short strings of a few letters, the bytes either side of them and '\0', so that many are prefixes of others.
+      const char letters[] = {'\0', 'a', 'b', '\x7f', '\x80', '\xff'};
+      std::string data(draw(0, 3), 'a');
+      for (auto &letter : data) {
+        letter = letters[draw(0, sizeof(letters) - 1)];
+      }
+      return Value(type, data);
+    }
+  }
+}
+
+/** @return the order of two keys of Values, column by column, NULL first */
+auto ReferenceCompare(const std::vector<Value> &lhs, const std::vector<Value> &rhs) -> int {
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].IsNull() || rhs[i].IsNull()) {
+      if (lhs[i].IsNull() != rhs[i].IsNull()) {
+        return lhs[i].IsNull() ? -1 : 1;
+      }
+      continue;
+    }
+    if (lhs[i].CompareLessThan(rhs[i]) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs[i].CompareGreaterThan(rhs[i]) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/** @return the order of two keys as they are stored in a tuple, built a Value of each column, as it used to be */
+template <size_t KeySize>
+auto ValueCompare(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs, Schema *key_schema) -> int {
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    const Value lhs_value = lhs.ToValue(key_schema, i);
+    const Value rhs_value = rhs.ToValue(key_schema, i);
+    if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/** Random keys of a key schema, as an index sets them, and the Values of them. */
+template <size_t KeySize>
+struct RandomKeys {
+  RandomKeys(const Schema &key_schema, int num_keys, bool nulls) {
+    std::mt19937_64 rng(15445);
+    for (int i = 0; i < num_keys; i++) {
+      std::vector<Value> key_values;
+      for (const auto &column : key_schema.GetColumns()) {
+        key_values.push_back(RandomValue(column.GetType(), nulls, &rng));
+      }
+      keys_.emplace_back();
+      keys_.back().SetFromKey(Tuple(key_values, &key_schema), key_schema);
+      values_.push_back(std::move(key_values));
+    }
+  }
+
+  std::vector<GenericKey<KeySize>> keys_;
+  std::vector<std::vector<Value>> values_;
+};
+
+/**
+ * Check the comparator against the reference on every pair of random keys of key_schema_text. Without nulls, as
+ * Values compare them equal to everything, for keys that still compare as Values.
+ */
+template <size_t KeySize>
+void CheckComparator(const std::string &key_schema_text, bool nulls = true) {
+  auto key_schema = ParseCreateStatement(key_schema_text);
+  GenericComparator<KeySize> comparator(key_schema.get());
+  const GenericComparator<KeySize> copy(comparator);
+  const RandomKeys<KeySize> random(*key_schema, 200, nulls);
+  for (size_t i = 0; i < random.keys_.size(); i++) {
+    for (size_t j = 0; j < random.keys_.size(); j++) {
+      const int expected = ReferenceCompare(random.values_[i], random.values_[j]);
+      ASSERT_EQ(expected, comparator(random.keys_[i], random.keys_[j])) << key_schema_text << " " << i << " " << j;
+      ASSERT_EQ(expected, copy(random.keys_[i], random.keys_[j])) << key_schema_text << " " << i << " " << j;
+    }
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(GenericComparatorTest, IntegerKeyTest) {
+  // Scenario: keys of a single integer column order as the Values of them do.
+  CheckComparator<4>("a int");
+  CheckComparator<8>("a bigint");
+  CheckComparator<8>("a smallint");
+  CheckComparator<8>("a tinyint");
+}
+
+// NOLINTNEXTLINE
+TEST(GenericComparatorTest, FixedKeyTest) {
+  // Scenario: keys of fixed size columns order column by column, as the Values of them do, NULL first.
+  CheckComparator<8>("a double");
+  CheckComparator<8>("a bool");
+  CheckComparator<8>("a int,b int");
+  CheckComparator<8>("a smallint,b smallint,c smallint,d smallint");
+  CheckComparator<32>("a int,b bigint,c smallint,d bool,e double");
+  CheckComparator<16>("a double,b tinyint");
+}
+
+// NOLINTNEXTLINE
+TEST(GenericComparatorTest, NullTimestampKeyTest) {
+  // Scenario: a NULL TIMESTAMP, stored as the largest value, sorts before every other one, as NormalizedKey has it.
+  // The keys are set from their bytes, as Type has no instance to serialize a TIMESTAMP Value into a tuple with.
+  Schema key_schema{std::vector<Column>{Column{"a", TypeId::TIMESTAMP}}};
+  GenericComparator<8> comparator(&key_schema);
+  const auto make_key = [](uint64_t timestamp) {
+    GenericKey<8> key;
+    memcpy(key.data_, &timestamp, sizeof(uint64_t));
+    return key;
+  };
+  const auto null_key = make_key(BUSTUB_TIMESTAMP_NULL);
+  const auto zero_key = make_key(0);
+  const auto largest_key = make_key(BUSTUB_TIMESTAMP_NULL - 1);
+  EXPECT_EQ(-1, comparator(null_key, zero_key));
+  EXPECT_EQ(-1, comparator(null_key, largest_key));
+  EXPECT_EQ(1, comparator(largest_key, null_key));
+  EXPECT_EQ(0, comparator(null_key, make_key(BUSTUB_TIMESTAMP_NULL)));
+  EXPECT_EQ(-1, comparator(zero_key, largest_key));
+}
+
+// NOLINTNEXTLINE
+TEST(GenericComparatorTest, VarcharKeyTest) {
+  // Scenario: keys with a VARCHAR column, encoded where they fit, order as the Values of them do, NULL first.
+  CheckComparator<16>("a varchar(4)");
+  CheckComparator<32>("a int,b varchar(4)");
+  CheckComparator<32>("a varchar(3),b double,c bool");
+  CheckComparator<32>("a varchar(3),b varchar(3),c varchar(3)");
+  // Too long to encode, they still compare as Values.
+  CheckComparator<32>("a int,b varchar", false);
+}
+
+// NOLINTNEXTLINE
+TEST(GenericComparatorTest, NormalizedKeyTest) {
+  // Scenario: keys are encoded only if they have several columns or a VARCHAR, and fit.
+  auto single = ParseCreateStatement("a int");
+  auto pair = ParseCreateStatement("a int,b int");
+  auto varchar = ParseCreateStatement("a int,b varchar(4)");
+  EXPECT_FALSE(NormalizedKey::IsEncoded(*single, 64));
+  EXPECT_TRUE(NormalizedKey::IsEncoded(*pair, 8));
+  EXPECT_FALSE(NormalizedKey::IsEncoded(*pair, 4));
+  EXPECT_EQ(15U, NormalizedKey::GetMaxSize(*varchar));
+  EXPECT_TRUE(NormalizedKey::IsEncoded(*varchar, 16));
+  EXPECT_FALSE(NormalizedKey::IsEncoded(*varchar, 8));
+
+  // The integers big-endian with the sign bit flipped, and the string escaped and terminated.
+  const Tuple tuple({ValueFactory::GetIntegerValue(-2), Value(TypeId::VARCHAR, std::string("a\0b", 3))}, varchar.get());
+  GenericKey<16> key;
+  key.SetFromKey(tuple, *varchar);
+  const char expected[16] = {'\x7f', '\xff', '\xff', '\xfe', '\x01', 'a', '\x00', '\xff', 'b', '\x00', '\x00'};
+  EXPECT_EQ(0, memcmp(expected, key.data_, sizeof(expected)));
+}
+
+// NOLINTNEXTLINE
+TEST(GenericComparatorTest, DISABLED_CompareBenchmark) {
+  const int num_keys = 1000;
+  const int num_rounds = 20;
+  std::cout << "<<< BEGIN" << std::endl;
+  const auto time = [&](const std::string &name, auto &&compare, const auto &keys) {
+    const auto start = std::chrono::steady_clock::now();
+    int64_t sum = 0;
+    for (int round = 0; round < num_rounds; round++) {
+      for (size_t i = 1; i < keys.size(); i++) {
+        sum += compare(keys[i - 1], keys[i]);
+      }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << ns / (num_rounds * (keys.size() - 1)) << " ns per comparison (" << sum << ")"
+              << std::endl;
+  };
+  for (const char *key_schema_text : {"a int", "a bigint", "a int,b bigint,c smallint", "a int,b varchar(4)"}) {
+    auto key_schema = ParseCreateStatement(key_schema_text);
+    GenericComparator<32> comparator(key_schema.get());
+    const RandomKeys<32> random(*key_schema, num_keys, false);
+    std::vector<GenericKey<32>> stored_keys(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+      stored_keys[i].SetFromKey(Tuple(random.values_[i], key_schema.get()));
+    }
+    time(std::string(key_schema_text) + ", Values",
+         [&](const auto &lhs, const auto &rhs) { return ValueCompare(lhs, rhs, key_schema.get()); }, stored_keys);
+    time(std::string(key_schema_text) + ", comparator", comparator, random.keys_);
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager_test.cpp
+//
+// Identification: test/storage/mmap_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/mmap_disk_manager.h"
+
+namespace bustub {
+
+namespace {
+
+/** Write num_pages pages, each holding "page <page_id>", to db_file. */
+void WriteDatabase(const std::string &db_file, page_id_t num_pages) {
+  DiskManager dm(db_file);
+  std::vector<char> page(BUSTUB_PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    std::fill(page.begin(), page.end(), static_cast<char>(page_id));
+    snprintf(page.data(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    dm.WritePage(page_id, page.data());
+  }
+  dm.ShutDown();
+}
+
+}  // namespace
+
+class MmapDiskManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("mmap_test.db");
+    remove("mmap_test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("mmap_test.db");
+    remove("mmap_test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(MmapDiskManagerTest, ReadPageTest) {
+  const page_id_t num_pages = 20;
+  WriteDatabase("mmap_test.db", num_pages);
+  MmapDiskManager dm("mmap_test.db");
+  EXPECT_EQ(num_pages, dm.GetNumPages());
+
+  // Scenario: pages read the same through ReadPage() and in place.
+  char buf[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(buf));
+    ASSERT_NE(nullptr, dm.GetPageData(page_id));
+    EXPECT_EQ(0, std::memcmp(buf, dm.GetPageData(page_id), BUSTUB_PAGE_SIZE));
+  }
+
+  // Scenario: a page past the end of the file reads as zeros.
+  std::memset(buf, 'x', sizeof(buf));
+  dm.ReadPage(num_pages, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+  EXPECT_EQ(nullptr, dm.GetPageData(num_pages));
+
+  // Scenario: writing a page back unchanged is fine, changing it throws.
+  dm.ReadPage(3, buf);
+  dm.WritePage(3, buf);
+  buf[100]++;
+  EXPECT_THROW(dm.WritePage(3, buf), Exception);
+  EXPECT_EQ(0, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapDiskManagerTest, BufferPoolTest) {
+  const page_id_t num_pages = 50;
+  WriteDatabase("mmap_test.db", num_pages);
+  MmapDiskManager dm("mmap_test.db");
+  BufferPoolManagerInstance bpm(10, &dm);
+
+  // Scenario: a scan larger than the pool reads every page through the mapping, and evicts clean pages only.
+  for (int round = 0; round < 2; round++) {
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      auto *page = bpm.FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+  }
+  bpm.FlushAllPages();
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapDiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(MmapDiskManager("mmap_test.db"), Exception); }
+
+/**
+ * Full scans through a buffer pool smaller than the file, with pread() and with the mapping, with the page cache
+ * dropped (cold) and after a first scan (warm).
+ */
+// NOLINTNEXTLINE
+TEST(MmapDiskManagerBenchmark, DISABLED_ScanBenchmark) {
+  const page_id_t num_pages = 32768;
+  const size_t pool_size = 1024;
+  const std::string db_file = "mmap_bench.db";
+  remove(db_file.c_str());
+  WriteDatabase(db_file, num_pages);
+
+  auto drop_page_cache = [&db_file] {
+    int fd = open(db_file.c_str(), O_RDONLY);
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  };
+  auto scan = [num_pages, pool_size](DiskManager *dm) {
+    BufferPoolManagerInstance bpm(pool_size, dm);
+    auto start = std::chrono::steady_clock::now();
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      auto *page = bpm.FetchPage(page_id);
+      bpm.UnpinPage(page->GetPageId(), false);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (bool mmap : {false, true}) {
+    std::unique_ptr<DiskManager> dm;
+    drop_page_cache();
+    if (mmap) {
+      dm = std::make_unique<MmapDiskManager>(db_file);
+    } else {
+      dm = std::make_unique<DiskManager>(db_file);
+    }
+    const double cold = scan(dm.get());
+    const double warm = scan(dm.get());
+    std::cout << (mmap ? "mmap " : "pread") << std::fixed << std::setprecision(0)
+              << ": cold " << num_pages / cold << " pages/s, warm " << num_pages / warm << " pages/s" << std::endl;
+    dm->ShutDown();
+  }
+  std::cout << ">>> END" << std::endl;
+  remove(db_file.c_str());
+  remove("mmap_bench.log");
+}
+
+}  // namespace bustub
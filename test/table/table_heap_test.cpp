@@ -0,0 +1,336 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto MakeTuple(const Schema &schema, int id) -> Tuple {
+  const std::string payload(64 + id % 32, static_cast<char>('a' + id % 26));
+  return Tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(payload.c_str(), false)}, &schema);
+}
+
+/** A tuple of schema (VARCHAR) that is exactly size bytes long. */
+auto MakeTupleOfSize(const Schema &schema, uint32_t size) -> Tuple {
+  const uint32_t overhead = Tuple({ValueFactory::GetVarcharValue("", false)}, &schema).GetLength();
+  const std::string payload(size - overhead, 'x');
+  return Tuple({ValueFactory::GetVarcharValue(payload.c_str(), false)}, &schema);
+}
+
+auto CountTuples(TableHeap *table) -> size_t {
+  Transaction txn(0);
+  size_t num_tuples = 0;
+  for (auto iter = table->Begin(&txn); iter != table->End(); ++iter) {
+    num_tuples++;
+  }
+  return num_tuples;
+}
+
+}  // namespace
+
+class TableHeapTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    disk_manager_ = std::make_unique<DiskManagerUnlimitedMemory>();
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(256, disk_manager_.get());
+  }
+
+  Schema schema_{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"payload", TypeId::VARCHAR, 128}}};
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManagerInstance> bpm_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, FreeSpaceMapTest) {
+  Transaction txn(0);
+  TableHeap table(bpm_.get(), nullptr, nullptr, &txn);
+  std::vector<RID> rids;
+  for (int i = 0; i < 20000; i++) {
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(schema_, i), &rid, &txn));
+    rids.push_back(rid);
+  }
+  EXPECT_LT(256U, table.GetFreeSpaceMap().GetNumPages());
+
+  // Scenario: an insert into a large table fetches a page or two, not every page of the table.
+  const auto before = bpm_->GetStats();
+  for (int i = 0; i < 100; i++) {
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(schema_, i), &rid, &txn));
+  }
+  const auto after = bpm_->GetStats();
+  EXPECT_GE(100U * 4, (after.hits_ + after.misses_) - (before.hits_ + before.misses_));
+
+  // Scenario: the space deletes free on an old page is found again, by a table heap opened from the map pages.
+  const page_id_t page_id = rids[10].GetPageId();
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == page_id) {
+      table.ApplyDelete(rid, &txn);
+    }
+  }
+  EXPECT_LT(BUSTUB_PAGE_SIZE / 2, table.GetFreeSpaceMap().GetFreeSpace(page_id));
+  TableHeap reopened(bpm_.get(), nullptr, nullptr, table.GetFirstPageId());
+  EXPECT_EQ(table.GetFreeSpaceMap().GetNumPages(), reopened.GetFreeSpaceMap().GetNumPages());
+  EXPECT_EQ(table.GetFreeSpaceMap().GetFreeSpace(page_id), reopened.GetFreeSpaceMap().GetFreeSpace(page_id));
+  // Only the last page and the old one have room, so the inserts land on the old page once the last one is full.
+  const size_t num_pages = reopened.GetFreeSpaceMap().GetNumPages();
+  bool found = false;
+  for (int i = 0; i < 100 && !found; i++) {
+    RID rid;
+    ASSERT_TRUE(reopened.InsertTuple(MakeTuple(schema_, i), &rid, &txn));
+    found = rid.GetPageId() == page_id;
+  }
+  EXPECT_TRUE(found);
+  EXPECT_EQ(num_pages, reopened.GetFreeSpaceMap().GetNumPages());
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, BuildFreeSpaceMapTest) {
+  Transaction txn(0);
+  TableHeap table(bpm_.get(), nullptr, nullptr, &txn);
+  for (int i = 0; i < 2000; i++) {
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(schema_, i), &rid, &txn));
+  }
+
+  // Scenario: a table heap without a map, as one whose map page could not be allocated, gets one built from its
+  // pages.
+  auto first_page = static_cast<TablePage *>(bpm_->FetchPage(table.GetFirstPageId()));
+  first_page->SetFreeSpaceMapPageId(INVALID_PAGE_ID);
+  bpm_->UnpinPage(table.GetFirstPageId(), true);
+  TableHeap reopened(bpm_.get(), nullptr, nullptr, table.GetFirstPageId());
+  EXPECT_EQ(table.GetFreeSpaceMap().GetNumPages(), reopened.GetFreeSpaceMap().GetNumPages());
+  EXPECT_NE(table.GetFreeSpaceMap().GetFirstPageId(), reopened.GetFreeSpaceMap().GetFirstPageId());
+  for (int i = 0; i < 2000; i++) {
+    RID rid;
+    ASSERT_TRUE(reopened.InsertTuple(MakeTuple(schema_, i), &rid, &txn));
+  }
+  EXPECT_EQ(4000U, CountTuples(&reopened));
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, BatchInsertTest) {
+  Transaction txn(0);
+  TableHeap table(bpm_.get(), nullptr, nullptr, &txn);
+  TableHeap batch_table(bpm_.get(), nullptr, nullptr, &txn);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 5000; i++) {
+    tuples.push_back(MakeTuple(schema_, i));
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(tuples.back(), &rid, &txn));
+  }
+
+  // Scenario: a batch takes a fetch per page it fills, and fills the pages as full as single inserts do.
+  const auto before = bpm_->GetStats();
+  const size_t write_set_size = txn.GetWriteSet()->size();
+  std::vector<RID> rids;
+  ASSERT_TRUE(batch_table.InsertTuples(tuples, &rids, &txn));
+  const auto after = bpm_->GetStats();
+  ASSERT_EQ(tuples.size(), rids.size());
+  EXPECT_EQ(write_set_size + tuples.size(), txn.GetWriteSet()->size());
+  EXPECT_EQ(table.GetFreeSpaceMap().GetNumPages(), batch_table.GetFreeSpaceMap().GetNumPages());
+  const size_t num_fetches = (after.hits_ + after.misses_) - (before.hits_ + before.misses_);
+  EXPECT_GE(batch_table.GetFreeSpaceMap().GetNumPages() * 4, num_fetches);
+
+  // Scenario: the rids are those of the tuples, in order.
+  for (size_t i = 0; i < tuples.size(); i += 97) {
+    Tuple tuple;
+    ASSERT_TRUE(batch_table.GetTuple(rids[i], &tuple, &txn));
+    EXPECT_EQ(0, std::memcmp(tuples[i].GetData(), tuple.GetData(), tuple.GetLength()));
+  }
+  EXPECT_EQ(std::unordered_set<RID>(rids.begin(), rids.end()).size(), rids.size());
+
+  // Scenario: a later batch goes to the space deletes free, rather than to new pages.
+  const size_t num_pages = batch_table.GetFreeSpaceMap().GetNumPages();
+  const page_id_t last_page_id = batch_table.GetFreeSpaceMap().GetLastPageId();
+  const page_id_t page_id = rids[100].GetPageId();
+  size_t num_deleted = 0;
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == page_id) {
+      batch_table.ApplyDelete(rid, &txn);
+      num_deleted++;
+    }
+  }
+  // Tuples larger than any that was inserted, which do not fit in what is left at the end of a full page.
+  const std::string payload(120, 'z');
+  const std::vector<Tuple> refill(
+      num_deleted / 2,
+      Tuple({ValueFactory::GetIntegerValue(0), ValueFactory::GetVarcharValue(payload.c_str(), false)}, &schema_));
+  ASSERT_TRUE(batch_table.InsertTuples(refill, &rids, &txn));
+  EXPECT_TRUE(std::all_of(rids.begin(), rids.end(), [&](const RID &rid) {
+    return rid.GetPageId() == page_id || rid.GetPageId() == last_page_id;
+  }));
+  EXPECT_EQ(num_pages, batch_table.GetFreeSpaceMap().GetNumPages());
+  EXPECT_EQ(tuples.size() - num_deleted + refill.size(), CountTuples(&batch_table));
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, ConcurrentInsertTest) {
+  const int num_threads = 8;
+  const int num_inserts = 1000;
+  Transaction create_txn(0);
+  TableHeap table(bpm_.get(), nullptr, nullptr, &create_txn);
+
+  std::vector<std::vector<RID>> rids(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      Transaction txn(t + 1);
+      for (int i = 0; i < num_inserts; i++) {
+        RID rid;
+        ASSERT_TRUE(table.InsertTuple(MakeTuple(schema_, i), &rid, &txn));
+        rids[t].push_back(rid);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: every insert has a slot of its own, and a scan sees all of them.
+  std::unordered_set<RID> all_rids;
+  for (const auto &thread_rids : rids) {
+    all_rids.insert(thread_rids.begin(), thread_rids.end());
+  }
+  EXPECT_EQ(static_cast<size_t>(num_threads * num_inserts), all_rids.size());
+  EXPECT_EQ(static_cast<size_t>(num_threads * num_inserts), CountTuples(&table));
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, MaxTupleSizeTest) {
+  const Schema schema{std::vector<Column>{Column{"payload", TypeId::VARCHAR, 2 * BUSTUB_PAGE_SIZE}}};
+  const uint32_t max_size = TablePage::MaxTupleSize(BUSTUB_PAGE_SIZE);
+  Transaction txn(0);
+  TableHeap table(bpm_.get(), nullptr, nullptr, &txn);
+  RID rid;
+
+  // Scenario: a tuple of the largest size fits in a page of its own.
+  const Tuple largest = MakeTupleOfSize(schema, max_size);
+  ASSERT_EQ(max_size, largest.GetLength());
+  ASSERT_TRUE(table.InsertTuple(largest, &rid, &txn));
+  ASSERT_TRUE(table.InsertTuple(largest, &rid, &txn));
+  EXPECT_EQ(2U, CountTuples(&table));
+
+  // Scenario: a tuple one byte larger aborts the transaction without adding a page.
+  const size_t num_pages = table.GetFreeSpaceMap().GetNumPages();
+  Transaction oversize_txn(1);
+  EXPECT_FALSE(table.InsertTuple(MakeTupleOfSize(schema, max_size + 1), &rid, &oversize_txn));
+  EXPECT_EQ(TransactionState::ABORTED, oversize_txn.GetState());
+  EXPECT_EQ(num_pages, table.GetFreeSpaceMap().GetNumPages());
+  EXPECT_EQ(2U, CountTuples(&table));
+
+  // Scenario: a batch of tuples of the largest size takes a page per tuple.
+  std::vector<Tuple> batch(3, largest);
+  std::vector<RID> rids;
+  ASSERT_TRUE(table.InsertTuples(batch, &rids, &txn));
+  ASSERT_EQ(batch.size(), rids.size());
+  std::unordered_set<page_id_t> page_ids;
+  for (const auto &batch_rid : rids) {
+    page_ids.insert(batch_rid.GetPageId());
+  }
+  EXPECT_EQ(batch.size(), page_ids.size());
+  EXPECT_EQ(5U, CountTuples(&table));
+
+  // Scenario: a batch with a tuple one byte larger aborts the transaction without adding a page.
+  batch.push_back(MakeTupleOfSize(schema, max_size + 1));
+  const size_t batch_num_pages = table.GetFreeSpaceMap().GetNumPages();
+  Transaction oversize_batch_txn(2);
+  EXPECT_FALSE(table.InsertTuples(batch, &rids, &oversize_batch_txn));
+  EXPECT_EQ(TransactionState::ABORTED, oversize_batch_txn.GetState());
+  EXPECT_EQ(batch_num_pages, table.GetFreeSpaceMap().GetNumPages());
+  EXPECT_EQ(5U, CountTuples(&table));
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, DISABLED_InsertBenchmark) {
+  const int num_tuples = 200000;
+  const int batch = 20000;
+  std::cout << "<<< BEGIN" << std::endl;
+  bpm_ = std::make_unique<BufferPoolManagerInstance>(16384, disk_manager_.get());
+  Transaction txn(0);
+  TableHeap table(bpm_.get(), nullptr, nullptr, &txn);
+  // The time per insert as the table grows, which does not grow with it.
+  for (int done = 0; done < num_tuples; done += batch) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < batch; i++) {
+      RID rid;
+      table.InsertTuple(MakeTuple(schema_, i), &rid, &txn);
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << table.GetFreeSpaceMap().GetNumPages() << " pages: " << ns / batch << " ns per insert" << std::endl;
+  }
+
+  // Single inserts against batches of 256 into a new table.
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < batch; i++) {
+    tuples.push_back(MakeTuple(schema_, i));
+  }
+  for (size_t batch_size : {1, 256}) {
+    Transaction create_txn(0);
+    TableHeap batch_table(bpm_.get(), nullptr, nullptr, &create_txn);
+    std::vector<RID> rids;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < tuples.size(); i += batch_size) {
+      if (batch_size == 1) {
+        batch_table.InsertTuple(tuples[i], &rids.emplace_back(), &txn);
+      } else {
+        std::vector<Tuple> part(tuples.begin() + i, tuples.begin() + std::min(i + batch_size, tuples.size()));
+        batch_table.InsertTuples(part, &rids, &txn);
+      }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "batch of " << batch_size << ": " << ns / batch << " ns per insert" << std::endl;
+  }
+
+  // Concurrent inserters into a new table.
+  for (int num_threads : {1, 2, 4, 8}) {
+    Transaction create_txn(0);
+    TableHeap concurrent_table(bpm_.get(), nullptr, nullptr, &create_txn);
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        Transaction thread_txn(t + 1);
+        for (int i = 0; i < batch; i++) {
+          RID rid;
+          concurrent_table.InsertTuple(MakeTuple(schema_, i), &rid, &thread_txn);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << num_threads << " threads: " << num_threads * batch / ms << " inserts per ms" << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub